@@ -8,7 +8,13 @@
 #include <iostream>
 #include <thread>
 #include <cstring>
+#include <cerrno>
 #include <algorithm>  
+#include <chrono>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 extern "C" {
 
@@ -20,6 +26,12 @@ extern bool g_verbose;
 #include <libavutil/opt.h>
 }
 
+namespace {
+// ⭐ Fixed output format (0 = each track in its own format)
+std::atomic<uint32_t> s_fixedRate{0};
+std::atomic<uint32_t> s_fixedBits{24};
+}
+
 // ============================================================================
 // AudioBuffer
 // ============================================================================
@@ -71,33 +83,119 @@ void AudioBuffer::resize(size_t size) {
 // AudioDecoder
 // ============================================================================
 
-AudioDecoder::AudioDecoder()
-    : m_formatContext(nullptr)
-    , m_codecContext(nullptr)
-    , m_swrContext(nullptr)
-    , m_audioStreamIndex(-1)
-    , m_eof(false)
-    , m_rawDSD(false)         // ⭐ DSD mode off by default
-    , m_packet(nullptr)       // ⭐ Packet for raw reading
-    , m_remainingCount(0)
-{
+namespace {
+
+const size_t FLAC_STREAMINFO_SIZE = 34;
+
+// ⭐ Codec context parked by the last closed decoder. The next open()
+// takes it when the codec parameters match (same album, same format)
+// instead of allocating and opening a new one.
+struct SpareCodec {
+    AVCodecContext* context = nullptr;
+    std::vector<uint8_t> signature;
+    
+    ~SpareCodec() {
+        if (context) {
+            avcodec_free_context(&context);
+        }
+    }
+};
+
+std::mutex s_spareCodecMutex;
+SpareCodec s_spareCodec;
+
+std::vector<uint8_t> codecSignature(const AVCodecParameters* par) {
+    int64_t fields[] = {
+        par->codec_id, par->format, par->sample_rate, par->ch_layout.nb_channels,
+        par->bits_per_raw_sample, par->bits_per_coded_sample, par->block_align
+    };
+    
+    std::vector<uint8_t> sig(reinterpret_cast<const uint8_t*>(fields),
+                             reinterpret_cast<const uint8_t*>(fields) + sizeof(fields));
+    
+    if (!par->extradata || par->extradata_size <= 0) {
+        return sig;
+    }
+    
+    // FLAC STREAMINFO also carries per-track frame sizes, total samples and
+    // MD5. The decoder is configured from the rest, which the codecpar
+    // fields above may not reflect (cached or hinted probe): block sizes
+    // (bytes 0-3), sample rate, channels and bit depth (bytes 10-13, less
+    // the low nibble that starts the sample count)
+    const uint8_t* info = par->extradata;
+    size_t size = static_cast<size_t>(par->extradata_size);
+    if (par->codec_id == AV_CODEC_ID_FLAC && size > FLAC_STREAMINFO_SIZE &&
+        std::memcmp(info, "fLaC", 4) == 0) {
+        info += 8;      // "fLaC" + metadata block header
+        size -= 8;
+    }
+    if (par->codec_id == AV_CODEC_ID_FLAC && size >= FLAC_STREAMINFO_SIZE) {
+        sig.insert(sig.end(), info, info + 4);
+        sig.insert(sig.end(), info + 10, info + 13);
+        sig.push_back(info[13] & 0xF0);
+    } else {
+        sig.insert(sig.end(), par->extradata, par->extradata + par->extradata_size);
+    }
+    return sig;
 }
 
-AudioDecoder::~AudioDecoder() {
-    close();
+AVCodecContext* takeSpareCodec(const AVCodecParameters* par, int threads) {
+    std::lock_guard<std::mutex> lock(s_spareCodecMutex);
+    if (!s_spareCodec.context || s_spareCodec.signature != codecSignature(par) ||
+        s_spareCodec.context->thread_count != threads) {
+        return nullptr;
+    }
+    AVCodecContext* context = s_spareCodec.context;
+    s_spareCodec.context = nullptr;
+    avcodec_flush_buffers(context);
+    return context;
 }
 
-bool AudioDecoder::open(const std::string& url) {
-    std::cout << "[AudioDecoder] Opening: " << url.substr(0, 80) << "..." << std::endl;
-    
-    // Open input file
-    m_formatContext = avformat_alloc_context();
-    if (!m_formatContext) {
-        std::cerr << "[AudioDecoder] Failed to allocate format context" << std::endl;
-        return false;
+void parkSpareCodec(AVCodecContext* context, const AVCodecParameters* par) {
+    std::lock_guard<std::mutex> lock(s_spareCodecMutex);
+    if (s_spareCodec.context) {
+        avcodec_free_context(&s_spareCodec.context);
     }
-    
-    // Configure FFmpeg options for robust HTTP streaming (Qobuz)
+    s_spareCodec.context = context;
+    s_spareCodec.signature = codecSignature(par);
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Passthrough kernel for a raw PCM codec and output container
+ * (2 = S16, 4 = S32). nullptr if the pair needs the real decoder.
+ */
+PcmKernels::Kernel selectPcmKernel(AVCodecID codecId, size_t outputSampleBytes, size_t& sourceSampleBytes) {
+    bool s16 = (outputSampleBytes == 2);
+    switch (codecId) {
+        case AV_CODEC_ID_PCM_S16LE:
+            sourceSampleBytes = 2;
+            return s16 ? &PcmKernels::s16ToS16<false> : &PcmKernels::s16ToS32<false>;
+        case AV_CODEC_ID_PCM_S16BE:
+            sourceSampleBytes = 2;
+            return s16 ? &PcmKernels::s16ToS16<true> : &PcmKernels::s16ToS32<true>;
+        case AV_CODEC_ID_PCM_S24LE:
+            sourceSampleBytes = 3;
+            return s16 ? nullptr : &PcmKernels::s24ToS32<false>;
+        case AV_CODEC_ID_PCM_S24BE:
+            sourceSampleBytes = 3;
+            return s16 ? nullptr : &PcmKernels::s24ToS32<true>;
+        case AV_CODEC_ID_PCM_S32LE:
+            sourceSampleBytes = 4;
+            return s16 ? nullptr : &PcmKernels::s32ToS32<false>;
+        case AV_CODEC_ID_PCM_S32BE:
+            sourceSampleBytes = 4;
+            return s16 ? nullptr : &PcmKernels::s32ToS32<true>;
+        default:
+            return nullptr;
+    }
+}
+
+// Configure FFmpeg options for robust HTTP streaming (Qobuz)
+AVDictionary* streamingOptions() {
     AVDictionary* options = nullptr;
     
     // Automatic reconnection on connection loss
@@ -121,9 +219,112 @@ bool AudioDecoder::open(const std::string& url) {
     // IMPORTANT: Ignore file size to avoid premature EOF
     av_dict_set(&options, "ignore_eof", "1", 0);
     
+    return options;
+}
+
+} // namespace
+
+AudioDecoder::AudioDecoder()
+    : m_formatContext(nullptr)
+    , m_codecContext(nullptr)
+    , m_swrContext(nullptr)
+    , m_audioStreamIndex(-1)
+    , m_eof(false)
+    , m_rawDSD(false)         // ⭐ DSD mode off by default
+    , m_packet(nullptr)       // ⭐ Packet for raw reading
+    , m_remainingCount(0)
+{
+}
+
+AudioDecoder::~AudioDecoder() {
+    close();
+}
+
+bool AudioDecoder::openInput(const std::string& url, const AVInputFormat* format, Probe probe,
+                             double& inputMs, double& probeMs) {
+    auto inputStart = std::chrono::steady_clock::now();
+    
+    // Open input file
+    m_formatContext = avformat_alloc_context();
+    if (!m_formatContext) {
+        std::cerr << "[AudioDecoder] Failed to allocate format context" << std::endl;
+        return false;
+    }
+    
+    AVDictionary* options = streamingOptions();
+    
     DEBUG_LOG("[AudioDecoder] Opening with streaming options (reconnect enabled)");
     
-    if (avformat_open_input(&m_formatContext, url.c_str(), nullptr, &options) < 0) {
+    // ⭐ Container known from DIDL-Lite or the index cache: skip the format
+    // guess and probe only as much as it takes to read the stream header
+    bool fastProbe = (probe != Probe::Full);
+    if (fastProbe) {
+        m_formatContext->probesize = HINTED_PROBESIZE;
+        m_formatContext->max_analyze_duration = HINTED_ANALYZE_DURATION;
+    }
+    
+    // ⭐ Network sources: read through the prefetch ring so the decoder
+    // never waits on the socket. Falls back to FFmpeg's own I/O on failure.
+    if (m_prefetchSize != 0 && PrefetchIO::isNetworkURL(url)) {
+        AVDictionary* prefetchOptions = nullptr;
+        av_dict_copy(&prefetchOptions, options, 0);
+        
+        auto prefetch = std::make_unique<PrefetchIO>();
+        if (prefetch->open(url, m_prefetchSize, &prefetchOptions)) {
+            m_formatContext->pb = prefetch->context();
+            m_formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+            
+            if (avformat_open_input(&m_formatContext, url.c_str(), format, nullptr) == 0) {
+                m_prefetch = std::move(prefetch);
+            } else {
+                std::cerr << "[AudioDecoder] ⚠️  Prefetch open failed, retrying direct" << std::endl;
+                // avformat_open_input freed the context on failure
+                prefetch.reset();
+                m_formatContext = avformat_alloc_context();
+                if (m_formatContext && fastProbe) {
+                    m_formatContext->probesize = HINTED_PROBESIZE;
+                    m_formatContext->max_analyze_duration = HINTED_ANALYZE_DURATION;
+                }
+            }
+        }
+        av_dict_free(&prefetchOptions);
+        
+        if (!m_formatContext) {
+            std::cerr << "[AudioDecoder] Failed to allocate format context" << std::endl;
+            av_dict_free(&options);
+            return false;
+        }
+    }
+    
+    // ⭐ Local files (disk, NFS/SMB mounts): mapped, read out of the page
+    // cache with kernel readahead instead of FFmpeg's file protocol
+    if (!m_prefetch && MappedFileIO::enabled() && MappedFileIO::isLocalURL(url)) {
+        auto mapped = std::make_unique<MappedFileIO>();
+        if (mapped->open(url)) {
+            m_formatContext->pb = mapped->context();
+            m_formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+            
+            if (avformat_open_input(&m_formatContext, url.c_str(), format, nullptr) == 0) {
+                m_mapped = std::move(mapped);
+            } else {
+                std::cerr << "[AudioDecoder] ⚠️  Mapped open failed, retrying direct" << std::endl;
+                mapped.reset();
+                m_formatContext = avformat_alloc_context();
+                if (m_formatContext && fastProbe) {
+                    m_formatContext->probesize = HINTED_PROBESIZE;
+                    m_formatContext->max_analyze_duration = HINTED_ANALYZE_DURATION;
+                }
+            }
+        }
+        
+        if (!m_formatContext) {
+            std::cerr << "[AudioDecoder] Failed to allocate format context" << std::endl;
+            av_dict_free(&options);
+            return false;
+        }
+    }
+    
+    if (!m_prefetch && !m_mapped && avformat_open_input(&m_formatContext, url.c_str(), format, &options) < 0) {
         std::cerr << "[AudioDecoder] Failed to open input: " << url << std::endl;
         av_dict_free(&options);
         avformat_free_context(m_formatContext);
@@ -134,10 +335,459 @@ bool AudioDecoder::open(const std::string& url) {
     // Free unused options
     av_dict_free(&options);
     
+    inputMs = msSince(inputStart);
+    
+    // ⭐ Index cache hit: the cached parameters replace stream analysis
+    if (probe == Probe::Cached) {
+        probeMs = 0.0;
+        return true;
+    }
+    
+    auto probeStart = std::chrono::steady_clock::now();
+    
     // Retrieve stream information
     if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
         std::cerr << "[AudioDecoder] Failed to find stream info" << std::endl;
+        closeInput();
+        return false;
+    }
+    
+    probeMs = msSince(probeStart);
+    return true;
+}
+
+void AudioDecoder::closeInput() {
+    if (m_formatContext) {
         avformat_close_input(&m_formatContext);
+    }
+    m_prefetch.reset();  // After the format context: it reads through the ring
+    m_mapped.reset();
+}
+
+bool AudioDecoder::hintsMatch() const {
+    const AVCodecParameters* par = nullptr;
+    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
+        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+            par = m_formatContext->streams[i]->codecpar;
+            break;
+        }
+    }
+    
+    if (!par || par->codec_id == AV_CODEC_ID_NONE || par->sample_rate <= 0 ||
+        par->ch_layout.nb_channels <= 0) {
+        return false;
+    }
+    
+    bool isDSD = (par->codec_id == AV_CODEC_ID_DSD_LSBF || par->codec_id == AV_CODEC_ID_DSD_MSBF ||
+                  par->codec_id == AV_CODEC_ID_DSD_LSBF_PLANAR || par->codec_id == AV_CODEC_ID_DSD_MSBF_PLANAR);
+    
+    // PCM needs a sample format, which a short probe may not have reached
+    if (!isDSD && par->format < 0) {
+        return false;
+    }
+    
+    // DSD: servers report either the bit rate or FFmpeg's byte rate
+    if (m_hints.sampleRate > 0) {
+        uint32_t rate = static_cast<uint32_t>(par->sample_rate);
+        if (rate != m_hints.sampleRate && !(isDSD && rate * 8 == m_hints.sampleRate)) {
+            return false;
+        }
+    }
+    
+    if (m_hints.channels > 0 && static_cast<uint32_t>(par->ch_layout.nb_channels) != m_hints.channels) {
+        return false;
+    }
+    
+    return true;
+}
+
+bool AudioDecoder::cacheMatches() {
+    // Same resource: same length, and same ETag when the server sends one
+    int64_t length = m_formatContext->pb ? avio_size(m_formatContext->pb) : -1;
+    std::string etag = m_prefetch ? m_prefetch->etag() : std::string();
+    if (length != m_index.length || etag != m_index.etag) {
+        return false;
+    }
+    
+    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
+        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+            return StreamIndexCache::apply(m_index, m_formatContext->streams[i]);
+        }
+    }
+    return false;
+}
+
+void AudioDecoder::indexPacket(const AVPacket* packet) {
+    if (packet->pts != AV_NOPTS_VALUE && m_index.addPoint(packet->pts, packet->pos)) {
+        m_indexDirty = true;
+    }
+}
+
+bool AudioDecoder::seekIndexed(int64_t timestamp) {
+    if (!m_trackInfo.isCompressed || (m_formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+        return false;
+    }
+    
+    AVStream* stream = m_formatContext->streams[m_audioStreamIndex];
+    const StreamIndexCache::SeekPoint* point = m_index.pointBefore(timestamp);
+    if (!point || av_rescale_q(timestamp - point->pts, stream->time_base, AV_TIME_BASE_Q) > INDEX_MAX_GAP) {
+        return false;
+    }
+    
+    if (av_seek_frame(m_formatContext, m_audioStreamIndex, point->pos, AVSEEK_FLAG_BYTE) < 0) {
+        return false;
+    }
+    
+    // Decoded audio between the point and the target is dropped on the next read
+    m_skipSamples = av_rescale_q(timestamp - point->pts, stream->time_base,
+                                 {1, static_cast<int>(m_trackInfo.sampleRate)});
+    
+    // Packet timestamps after a byte seek are not trusted for the index
+    m_indexing = false;
+    
+    DEBUG_LOG("[AudioDecoder] 📇 Indexed seek: byte " << point->pos << ", dropping "
+              << m_skipSamples << " samples");
+    return true;
+}
+
+bool AudioDecoder::resumeDirect() {
+    // PrefetchIO resumes underneath the demuxer; local inputs do not drop
+    if (m_prefetch || m_mapped || !PrefetchIO::isNetworkURL(m_url)) {
+        return false;
+    }
+    
+    bool byteSeek = (m_resumePos >= 0 && !(m_formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK));
+    if (!byteSeek && m_resumePts == AV_NOPTS_VALUE) {
+        return false;
+    }
+    
+    while (m_resumeAttempts < RESUME_ATTEMPTS) {
+        if (m_resumeAttempts++ > 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(m_resumeAttempts));
+        }
+        std::cerr << "[AudioDecoder] 🔄 Reopening at " << (byteSeek ? "byte " : "pts ")
+                  << (byteSeek ? m_resumePos : m_resumePts) << " (attempt " << m_resumeAttempts
+                  << "/" << RESUME_ATTEMPTS << ")" << std::endl;
+        
+        // New connection: the old one may still be half-open
+        avio_closep(&m_formatContext->pb);
+        AVDictionary* options = streamingOptions();
+        int ret = avio_open2(&m_formatContext->pb, m_url.c_str(), AVIO_FLAG_READ,
+                             &m_formatContext->interrupt_callback, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            continue;
+        }
+        
+        // Range request at the next packet; the demuxer is flushed, the
+        // decoder is not: it receives the packets it would have anyway
+        ret = byteSeek ? av_seek_frame(m_formatContext, m_audioStreamIndex, m_resumePos, AVSEEK_FLAG_BYTE)
+                       : av_seek_frame(m_formatContext, m_audioStreamIndex, m_resumePts, 0);
+        if (ret < 0) {
+            continue;
+        }
+        
+        // Packet timestamps after a byte seek are not trusted for the index
+        m_indexing = false;
+        std::cout << "[AudioDecoder] ✓ Stream resumed" << std::endl;
+        return true;
+    }
+    
+    std::cerr << "[AudioDecoder] ❌ Could not resume the stream" << std::endl;
+    return false;
+}
+
+namespace {
+
+// Local source still the one the cached PCM was decoded from (by size);
+// HTTP sources are checked in the background (revalidateCached), others trusted
+bool pcmSourceUnchanged(const std::string& url, const PcmCache::Header& header) {
+    if (header.sourceLength < 0) {
+        return true;
+    }
+    
+    std::string file = (url.compare(0, 7, "file://") == 0) ? url.substr(7) : url;
+    if (file.find("://") != std::string::npos) {
+        return true;
+    }
+    struct stat st;
+    return ::stat(file.c_str(), &st) != 0 || st.st_size == header.sourceLength;
+}
+
+} // namespace
+
+bool AudioDecoder::openCached(const std::string& url) {
+    auto openStart = std::chrono::steady_clock::now();
+    
+    std::unique_ptr<PcmCache::Reader> hit = PcmCache::find(url);
+    if (!hit) {
+        return false;
+    }
+    
+    const PcmCache::Header& header = hit->header();
+    if (!pcmSourceUnchanged(url, header)) {
+        std::cout << "[AudioDecoder] ⚠️  Source changed since its PCM was cached, decoding again" << std::endl;
+        hit.reset();
+        PcmCache::invalidate(url);
+        return false;
+    }
+    
+    m_trackInfo.codec = header.codec;
+    m_trackInfo.sampleRate = header.sampleRate;
+    m_trackInfo.bitDepth = header.bitDepth;
+    m_trackInfo.channels = header.channels;
+    m_trackInfo.duration = header.duration;
+    m_trackInfo.isDSD = header.isDSD;
+    m_trackInfo.dsdRate = header.dsdRate;
+    m_trackInfo.dsdSourceFormat = static_cast<TrackInfo::DSDSourceFormat>(header.dsdSourceFormat);
+    m_trackInfo.isCompressed = header.isCompressed;
+    
+    m_url = url;
+    m_pcmHit = std::move(hit);
+    m_pcmPos = 0;
+    m_eof = (m_pcmHit->header().samples == 0);
+    
+    // ⭐ HTTP source: play now, check it meanwhile (a change only affects the next play)
+    std::string host, path;
+    uint16_t port;
+    if (header.sourceLength >= 0 && HttpStream::parseURL(url, host, port, path)) {
+        stopRevalidation();
+        m_revalidateStop = false;
+        m_revalidateThread = std::thread(&AudioDecoder::revalidateCached, this,
+                                         url, header.sourceLength, header.etag);
+    }
+    
+    updateOutputInfo();
+    
+    std::cout << "[AudioDecoder] ⚡ Cached PCM: " << m_trackInfo.codec << " " << m_trackInfo.sampleRate
+              << "Hz/" << m_trackInfo.bitDepth << "bit/" << m_trackInfo.channels << "ch, no decoding" << std::endl;
+    std::cout << "[AudioDecoder] ⏱️  Open: " << static_cast<int>(msSince(openStart)) << "ms (cached PCM)"
+              << std::endl;
+    return true;
+}
+
+void AudioDecoder::revalidateCached(std::string url, int64_t length, std::string etag) {
+    // First byte only: the reply carries length and ETag, the connection goes back to the pool
+    HttpStream probe;
+    probe.setInterrupt([this]() { return m_revalidateStop.load(); });
+    if (!probe.open(url, 0, 1)) {
+        DEBUG_LOG("[AudioDecoder] Cannot reach the source, keeping the cached PCM");
+        return;
+    }
+    uint8_t byte;
+    probe.read(&byte, 1);
+    bool same = probe.size() == length &&
+                (etag.empty() || probe.etag().empty() || probe.etag() == etag);
+    probe.close();
+    
+    if (same) {
+        DEBUG_LOG("[AudioDecoder] Cached PCM source still valid");
+        return;
+    }
+    
+    // This playback keeps the PCM it started with; the next play decodes again
+    std::cerr << "[AudioDecoder] ⚠️  Source changed since its PCM was cached, dropping the cached PCM" << std::endl;
+    PcmCache::invalidate(url);
+}
+
+void AudioDecoder::stopRevalidation() {
+    if (m_revalidateThread.joinable()) {
+        m_revalidateStop = true;
+        m_revalidateThread.join();
+    }
+}
+
+bool AudioDecoder::leaveCached() {
+    double seconds = static_cast<double>(m_pcmPos) / m_pcmHit->header().outputRate;
+    bool atStart = (m_pcmPos == 0);
+    std::string url = m_url;
+    
+    m_pcmHit.reset();
+    m_pcmPos = 0;
+    if (!openSource(url)) {
+        return false;
+    }
+    return atStart || seek(seconds);
+}
+
+size_t AudioDecoder::readCached(AudioBuffer& buffer, size_t numSamples) {
+    const PcmCache::Header& header = m_pcmHit->header();
+    if (m_eof) {
+        return 0;
+    }
+    
+    uint64_t samples = std::min<uint64_t>(numSamples, header.samples - m_pcmPos);
+    samples -= samples % header.frameSamples;
+    size_t bytes = header.bytesFor(samples);
+    if (buffer.size() < bytes) {
+        buffer.resize(bytes);
+    }
+    
+    // Same bytes readSamples() produced when the track was decoded
+    std::memcpy(buffer.data(), m_pcmHit->data() + header.bytesFor(m_pcmPos), bytes);
+    m_pcmPos += samples;
+    if (samples == 0 || m_pcmPos >= header.samples) {
+        DEBUG_LOG("[AudioDecoder] EOF reached (cached PCM)");
+        m_eof = true;
+    }
+    return static_cast<size_t>(samples);
+}
+
+void AudioDecoder::recordSamples(const AudioBuffer& buffer, size_t samples,
+                                 uint32_t outputRate, uint32_t outputBits) {
+    if (m_pcmRecord) {
+        m_pcmRecord = false;
+        
+        PcmCache::Header header;
+        header.sourceLength = (m_formatContext && m_formatContext->pb) ? avio_size(m_formatContext->pb) : -1;
+        header.etag = m_prefetch ? m_prefetch->etag() : std::string();
+        header.codec = m_trackInfo.codec;
+        header.sampleRate = m_trackInfo.sampleRate;
+        header.bitDepth = m_trackInfo.bitDepth;
+        header.channels = m_trackInfo.channels;
+        header.duration = m_trackInfo.duration;
+        header.isDSD = m_trackInfo.isDSD;
+        header.dsdRate = m_trackInfo.dsdRate;
+        header.dsdSourceFormat = static_cast<int32_t>(m_trackInfo.dsdSourceFormat);
+        header.isCompressed = m_trackInfo.isCompressed;
+        header.outputRate = outputRate;
+        header.outputBits = outputBits;
+        m_pcmWriter = PcmCache::create(m_url, header);
+        if (!m_pcmWriter) {
+            return;
+        }
+    }
+    
+    if (samples > 0 && !m_pcmWriter->append(buffer.data(), samples)) {
+        m_pcmWriter.reset();
+        return;
+    }
+    
+    if (!m_eof) {
+        if (samples == 0) {
+            m_pcmWriter.reset();
+        }
+        return;
+    }
+    
+    // Read errors also end the track: only keep what reached the known end (1s slack)
+    const PcmCache::Header& header = m_pcmWriter->header();
+    uint64_t expected = (m_trackInfo.duration > 0)
+        ? static_cast<uint64_t>(av_rescale(static_cast<int64_t>(m_trackInfo.duration), outputRate,
+                                             m_trackInfo.sampleRate)) : 0;
+    if (header.samples + outputRate >= expected) {
+        m_pcmWriter->commit();
+    } else {
+        DEBUG_LOG("[AudioDecoder] Track ended early, decoded PCM not cached");
+    }
+    m_pcmWriter.reset();
+}
+
+bool AudioDecoder::openCodec(const AVCodec* codec, const AVCodecParameters* codecpar, bool& reused) {
+    // ⭐ Frame threads for codecs whose frames decode independently (FLAC,
+    // ALAC, WavPack...): FFmpeg spreads packets over a worker pool and
+    // returns the frames in order
+    int threads = (m_decodeThreads > 1 && (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS))
+        ? m_decodeThreads : 1;
+    
+    // ⭐ Same parameters as the previous track: reuse its codec context
+    m_codecContext = takeSpareCodec(codecpar, threads);
+    reused = (m_codecContext != nullptr);
+    
+    if (reused) {
+        DEBUG_LOG("[AudioDecoder] ♻️  Reusing codec context (" << codec->name << ")");
+        return true;
+    }
+    
+    // Allocate codec context
+    m_codecContext = avcodec_alloc_context3(codec);
+    if (!m_codecContext) {
+        std::cerr << "[AudioDecoder] Failed to allocate codec context" << std::endl;
+        return false;
+    }
+    
+    // Copy codec parameters
+    if (avcodec_parameters_to_context(m_codecContext, codecpar) < 0) {
+        std::cerr << "[AudioDecoder] Failed to copy codec parameters" << std::endl;
+        avcodec_free_context(&m_codecContext);
+        return false;
+    }
+    
+    m_codecContext->thread_count = threads;
+    if (threads > 1) {
+        m_codecContext->thread_type = FF_THREAD_FRAME;
+        DEBUG_LOG("[AudioDecoder] 🧵 Frame-parallel decoding, " << threads << " workers");
+    }
+    
+    // Open codec
+    if (avcodec_open2(m_codecContext, codec, nullptr) < 0) {
+        std::cerr << "[AudioDecoder] Failed to open codec" << std::endl;
+        avcodec_free_context(&m_codecContext);
+        return false;
+    }
+    
+    return true;
+}
+
+bool AudioDecoder::open(const std::string& url) {
+    // ⭐ Decoded-PCM cache: a hit needs no input and no decoder
+    if (PcmCache::enabled() && openCached(url)) {
+        return true;
+    }
+    
+    if (!openSource(url)) {
+        return false;
+    }
+    m_pcmRecord = PcmCache::enabled();
+    return true;
+}
+
+bool AudioDecoder::openSource(const std::string& url) {
+    std::cout << "[AudioDecoder] Opening: " << url.substr(0, 80) << "..." << std::endl;
+    
+    auto openStart = std::chrono::steady_clock::now();
+    
+    double inputMs = 0.0;
+    double probeMs = 0.0;
+    bool opened = false;
+    
+    m_url = url;
+    m_index = StreamIndexCache::Entry();
+    
+    // ⭐ Index cache: same URI, same length and ETag → known demuxer
+    // and codec parameters, no stream analysis at all
+    bool cached = false;
+    if (StreamIndexCache::enabled() && StreamIndexCache::load(url, m_index)) {
+        const AVInputFormat* cachedFormat = av_find_input_format(m_index.demuxer.c_str());
+        cached = cachedFormat && openInput(url, cachedFormat, Probe::Cached, inputMs, probeMs) &&
+                 cacheMatches();
+        if (!cached) {
+            std::cout << "[AudioDecoder] ⚠️  Index cache entry is stale, probing" << std::endl;
+            closeInput();
+            m_index = StreamIndexCache::Entry();
+        }
+    }
+    opened = cached;
+    
+    // ⭐ DIDL-Lite hints: force the demuxer and cap probing, fall back
+    // to a full probe if the stream does not look like announced
+    const char* demuxer = m_hints.demuxer();
+    const AVInputFormat* hintedFormat = (demuxer && !opened) ? av_find_input_format(demuxer) : nullptr;
+    
+    if (hintedFormat) {
+        DEBUG_LOG("[AudioDecoder] 💡 DIDL hints: " << m_hints.mimeType << " → " << demuxer
+                  << (m_hints.sampleRate ? ", " + std::to_string(m_hints.sampleRate) + "Hz" : std::string())
+                  << (m_hints.channels ? ", " + std::to_string(m_hints.channels) + "ch" : std::string()));
+        
+        opened = openInput(url, hintedFormat, Probe::Hinted, inputMs, probeMs) && hintsMatch();
+        if (!opened) {
+            std::cout << "[AudioDecoder] ⚠️  Stream does not match DIDL hints, full probe" << std::endl;
+            closeInput();
+        }
+    }
+    
+    bool hinted = opened && !cached;
+    if (!opened && !openInput(url, nullptr, Probe::Full, inputMs, probeMs)) {
         return false;
     }
     
@@ -177,30 +827,31 @@ bool AudioDecoder::open(const std::string& url) {
         return false;
     }
     
-    // Allocate codec context
-    m_codecContext = avcodec_alloc_context3(codec);
-    if (!m_codecContext) {
-        std::cerr << "[AudioDecoder] Failed to allocate codec context" << std::endl;
-        avformat_close_input(&m_formatContext);
-        return false;
-    }
+    auto codecStart = std::chrono::steady_clock::now();
     
-    // Copy codec parameters
-    if (avcodec_parameters_to_context(m_codecContext, codecpar) < 0) {
-        std::cerr << "[AudioDecoder] Failed to copy codec parameters" << std::endl;
-        avcodec_free_context(&m_codecContext);
-        avformat_close_input(&m_formatContext);
-        return false;
-    }
+    bool codecReused = false;
     
-    // Open codec
-    if (avcodec_open2(m_codecContext, codec, nullptr) < 0) {
-        std::cerr << "[AudioDecoder] Failed to open codec" << std::endl;
-        avcodec_free_context(&m_codecContext);
+    // ⭐ WAV/AIFF: raw packets go straight through PcmKernels,
+    // no codec context and no swresample
+    size_t sourceSampleBytes = 0;
+    m_passthrough = (selectPcmKernel(codecpar->codec_id, 4, sourceSampleBytes) != nullptr);
+    
+    if (m_passthrough) {
+        m_packet = av_packet_alloc();
+        if (!m_packet) {
+            std::cerr << "[AudioDecoder] Failed to allocate packet" << std::endl;
+            avformat_close_input(&m_formatContext);
+            return false;
+        }
+        m_pcmKernel = nullptr;   // Picked on first read, once the output format is known
+        DEBUG_LOG("[AudioDecoder] ⚡ Raw PCM passthrough (" << codec->name << ", no decoder)");
+    } else if (!openCodec(codec, codecpar, codecReused)) {
         avformat_close_input(&m_formatContext);
         return false;
     }
     
+    double codecMs = msSince(codecStart);
+    
     // Fill track info
     m_trackInfo.sampleRate = codecpar->sample_rate;
     m_trackInfo.channels = codecpar->ch_layout.nb_channels;
@@ -308,6 +959,25 @@ bool AudioDecoder::open(const std::string& url) {
             } else {
             }
             
+            // ⭐ Native DSF/DFF reader: channel blocks straight from the
+            // container, interleaved in one pass, block-aligned seek
+            if (m_formatContext->pb) {
+                auto reader = std::make_unique<DsdReader>();
+                reader->setMapping(m_mapped.get());   // Local file: blocks straight from the mapping
+                if (reader->open(m_formatContext->pb)) {
+                    m_trackInfo.sampleRate = reader->sampleRate();
+                    m_trackInfo.channels = reader->channels();
+                    m_trackInfo.dsdRate = reader->sampleRate() / 44100;
+                    m_trackInfo.duration = reader->totalSamples();
+                    m_trackInfo.dsdSourceFormat = (reader->container() == DsdReader::Container::DSF)
+                        ? TrackInfo::DSDSourceFormat::DSF : TrackInfo::DSDSourceFormat::DFF;
+                    m_dsdReader = std::move(reader);
+                    DEBUG_LOG("[AudioDecoder] ✓ Native DSD reader (seekable)");
+                } else {
+                    DEBUG_LOG("[AudioDecoder] Native DSD reader unavailable, using FFmpeg packets");
+                }
+            }
+            
             m_eof = false;
             
             std::cout << "[AudioDecoder] ✓ Opened successfully (DSD NATIVE)" << std::endl;
@@ -407,41 +1077,119 @@ bool AudioDecoder::open(const std::string& url) {
               << m_trackInfo.bitDepth << "bit/"
               << m_trackInfo.channels << "ch");
     
+    // ⭐ Index cache: keep the probed parameters, and for compressed
+    // formats record where each second starts while the track plays
+    if (StreamIndexCache::enabled()) {
+        if (!cached) {
+            m_index.length = m_formatContext->pb ? avio_size(m_formatContext->pb) : -1;
+            m_index.etag = m_prefetch ? m_prefetch->etag() : std::string();
+            StreamIndexCache::capture(m_formatContext, audioStream, m_index);
+            m_indexDirty = (m_index.length > 0 || !m_index.etag.empty());
+        }
+        m_indexing = (m_index.length > 0 || !m_index.etag.empty()) && m_trackInfo.isCompressed &&
+                     !(m_formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK);
+    }
+    
     // Calculate duration
     if (audioStream->duration != AV_NOPTS_VALUE) {
         m_trackInfo.duration = av_rescale_q(audioStream->duration, 
                                             audioStream->time_base,
                                             {1, (int)m_trackInfo.sampleRate});
+    } else if (m_hints.durationSeconds > 0.0) {
+        // Short probe on a stream without a length field: trust the server
+        m_trackInfo.duration = static_cast<uint64_t>(m_hints.durationSeconds * m_trackInfo.sampleRate);
     } else {
         m_trackInfo.duration = 0;
     }
     
     m_eof = false;
+    m_swrFlushed = false;
+    updateOutputInfo();
     
     std::cout << "[AudioDecoder] ✓ Opened successfully" << std::endl;
+    std::cout << "[AudioDecoder] ⏱️  Open: " << static_cast<int>(msSince(openStart)) << "ms (input "
+              << static_cast<int>(inputMs) << "ms"
+              << (m_prefetch && m_prefetch->connectionReused() ? " reused connection" : "")
+              << (m_mapped ? " mapped" : "")
+              << ", probe " << static_cast<int>(probeMs) << "ms" << (hinted ? " hinted" : "")
+              << (cached ? " cached" : "") << ", codec "
+              << static_cast<int>(codecMs) << "ms" << (codecReused ? " reused" : "")
+              << (m_passthrough ? " passthrough" : "") << ")" << std::endl;
  
     return true;
 }
 void AudioDecoder::close() {
+    stopRevalidation();
+    m_pcmHit.reset();
+    m_pcmWriter.reset();   // Unless committed at EOF: dropped
+    m_pcmRecord = false;
+    m_pcmPos = 0;
     if (m_swrContext) {
         swr_free(&m_swrContext);
     }
     if (m_codecContext) {
-        avcodec_free_context(&m_codecContext);
+        // ⭐ Keep it for the next track if it is in the same format
+        if (!m_rawDSD && m_formatContext && m_audioStreamIndex >= 0) {
+            parkSpareCodec(m_codecContext, m_formatContext->streams[m_audioStreamIndex]->codecpar);
+            m_codecContext = nullptr;
+        } else {
+            avcodec_free_context(&m_codecContext);
+        }
     }
     if (m_packet) {  // ⭐ Free DSD packet
         av_packet_free(&m_packet);
     }
+    m_dsdReader.reset();  // Reads through the format context's I/O
     if (m_formatContext) {
         avformat_close_input(&m_formatContext);
     }
+    m_prefetch.reset();  // After the format context: it reads through the ring
+    m_mapped.reset();
+    if (m_indexDirty) {
+        StreamIndexCache::store(m_url, m_index);
+    }
+    m_index = StreamIndexCache::Entry();
+    m_indexing = false;
+    m_indexDirty = false;
+    m_skipSamples = 0;
+    m_draining = false;
+    m_resumePos = -1;
+    m_resumePts = AV_NOPTS_VALUE;
+    m_resumeAttempts = 0;
     m_audioStreamIndex = -1;
     m_eof = false;
     m_rawDSD = false;  // ⭐ Reset DSD flag
+    m_passthrough = false;
+    m_pcmKernel = nullptr;
+    m_frameKernel = nullptr;
 }
 
 size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
                                 uint32_t outputRate, uint32_t outputBits) {
+    if (m_pcmHit) {
+        const PcmCache::Header& header = m_pcmHit->header();
+        if (outputRate == header.outputRate && outputBits == header.outputBits) {
+            return readCached(buffer, numSamples);
+        }
+        
+        std::cout << "[AudioDecoder] Cached PCM is " << header.outputRate << "Hz/" << header.outputBits
+                  << "bit, " << outputRate << "Hz/" << outputBits << "bit requested: decoding the source"
+                  << std::endl;
+        if (!leaveCached()) {
+            m_eof = true;
+            return 0;
+        }
+    }
+    
+    size_t samples = decodeSamples(buffer, numSamples, outputRate, outputBits);
+    if (m_pcmRecord || m_pcmWriter) {
+        recordSamples(buffer, samples, outputRate, outputBits);
+    }
+    return samples;
+}
+
+size_t AudioDecoder::decodeSamples(AudioBuffer& buffer, size_t numSamples,
+                                   uint32_t outputRate, uint32_t outputBits) {
     
     // ══════════════════════════════════════════════════════════════
     // DSD NATIVE MODE - Read raw packets without decoding
@@ -457,23 +1205,37 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
             return 0;
         }
         
-        size_t bytesPerSample = 1;  // DSD: 1 byte per 8 samples per channel, but we'll work in bytes
-        (void)bytesPerSample;  // Silence unused variable warning
+        // ⭐ Native reader: sink layout in one pass, no carry-over buffer
+        if (m_dsdReader) {
+            size_t bytesPerChannel = numSamples / 8;
+            if (buffer.size() < bytesPerChannel * m_trackInfo.channels) {
+                buffer.resize(bytesPerChannel * m_trackInfo.channels);
+            }
+            
+            size_t got = m_dsdReader->read(buffer.data(), bytesPerChannel);
+            if (got < (bytesPerChannel & ~static_cast<size_t>(3))) {
+                DEBUG_LOG("[AudioDecoder] EOF reached (DSD)");
+                m_eof = true;
+            }
+            return got * 8;
+        }
+        
+        // Whole groups only: 4 bytes per channel for stereo, one byte per channel otherwise
+        size_t groupBytes = (m_trackInfo.channels == 2) ? 8 : m_trackInfo.channels;
         size_t totalBytesNeeded = (numSamples * m_trackInfo.channels) / 8;
+        totalBytesNeeded -= totalBytesNeeded % groupBytes;
         size_t totalBytesRead = 0;
         
         // Ensure buffer is large enough
         if (buffer.size() < totalBytesNeeded) {
             buffer.resize(totalBytesNeeded);
         }
-        
         uint8_t* outputPtr = buffer.data();
         
-        // CRITICAL: First, use remaining samples from internal buffer
+        // CRITICAL: First, the converted rest of the previous packet
         if (m_remainingCount > 0) {
             size_t bytesToUse = std::min(m_remainingCount, totalBytesNeeded);
             memcpy(outputPtr, m_remainingSamples.data(), bytesToUse);
-            outputPtr += bytesToUse;
             totalBytesRead += bytesToUse;
             
             // Shift remaining data
@@ -486,11 +1248,6 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
             } else {
                 m_remainingCount = 0;
             }
-            
-            // If we have enough, return now
-            if (totalBytesRead >= totalBytesNeeded) {
-                return numSamples;
-            }
         }
         
         // Need more data - read packets
@@ -510,115 +1267,36 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
                 continue;
             }
             
-            size_t dataSize = m_packet->size;
-            
-            // Debug: count packets
-            // Removed static variable - now m_packetCount (instance member)
-               m_packetCount++;
-            
-            // ⚠️  TEST: DON'T skip any packets - all contain audio data
-            /*
-            if (m_packetCount <= 10) {
-                if (!m_dsdWarningShown) {
-                    DEBUG_LOG("[AudioDecoder] ⚠️  Skipping first 10 packets (header/padding)");
-                    m_dsdWarningShown = true;
-                }
-                av_packet_unref(m_packet);
-                continue;
+            m_packetCount++;
+            if (m_packetCount <= 15) {
+                DEBUG_LOG("[AudioDecoder] 📦 Packet #" << m_packetCount 
+                          << ", size=" << m_packet->size << " bytes"
+                          << " (total: " << totalBytesRead << "/" << totalBytesNeeded << ")");
             }
-            */
             
-            // DEBUG: Always log packet processing
-            if (m_packetCount <= 50) {
-                DEBUG_LOG("[AudioDecoder] 📦 Processing packet #" << m_packetCount 
-                          << ", size=" << dataSize << " bytes"
-                          << ", need=" << (totalBytesNeeded - totalBytesRead) << " bytes more");
+            // Each packet is put in sink layout on its own: a packet's
+            // channel planes must not be paired with another packet's
+            if (m_dsdScratch.size() < static_cast<size_t>(m_packet->size)) {
+                m_dsdScratch.resize(m_packet->size);
             }
+            size_t converted = dsdPacketToSink(m_packet->data, m_packet->size, m_dsdScratch.data());
+            av_packet_unref(m_packet);
             
-            // Process this packet
-            size_t bytesNeeded = totalBytesNeeded - totalBytesRead;
+            size_t bytesToUse = std::min(converted, totalBytesNeeded - totalBytesRead);
+            memcpy(outputPtr + totalBytesRead, m_dsdScratch.data(), bytesToUse);
+            totalBytesRead += bytesToUse;
             
-            if (dataSize <= bytesNeeded) {
-                // Use entire packet
-                memcpy(outputPtr, m_packet->data, dataSize);
-                outputPtr += dataSize;
-                totalBytesRead += dataSize;
-            } else {
-                // Use part of packet, save rest to buffer
-                memcpy(outputPtr, m_packet->data, bytesNeeded);
-                totalBytesRead += bytesNeeded;
-                
-                // Save remaining to internal buffer
-                size_t remainingBytes = dataSize - bytesNeeded;
+            // Save the converted rest for the next call
+            if (converted > bytesToUse) {
+                size_t remainingBytes = converted - bytesToUse;
                 if (m_remainingSamples.size() < remainingBytes) {
                     m_remainingSamples.resize(remainingBytes);
                 }
-                memcpy(m_remainingSamples.data(), 
-                       m_packet->data + bytesNeeded, 
-                       remainingBytes);
+                memcpy(m_remainingSamples.data(), m_dsdScratch.data() + bytesToUse, remainingBytes);
                 m_remainingCount = remainingBytes;
             }
-            
-            av_packet_unref(m_packet);
-            
-            // Debug first few times
-            if (m_packetCount <= 15) {
-                DEBUG_LOG("[AudioDecoder] Packet #" << m_packetCount 
-                          << ": used " << std::min(dataSize, bytesNeeded) << " bytes"
-                          << " (total: " << totalBytesRead << "/" << totalBytesNeeded << ")");
-            }
         }
         
-        // ✅ FINAL WORKING CONFIGURATION (discovered through testing)
-        // These exact settings are required for proper DSD playback:
-        const bool ENABLE_INTERLEAVING = true;   // REQUIRED for stereo (prevents 2× speed
-        const bool ENABLE_BIT_REVERSAL = false;  // NOT needed for DSF files
-        const bool INTERLEAVE_BY_BYTE = false;   // Use 32-bit word interleaving
-        (void)ENABLE_BIT_REVERSAL;  // Silence unused variable warning
-        
-        // Convert PLANAR to INTERLEAVED if enabled
-        if (ENABLE_INTERLEAVING && m_trackInfo.channels == 2) {
-            // FFmpeg gives: [LLLL...][RRRR...] (planar by channel)
-            
-            // Create temp buffer for interleaving
-            AudioBuffer tempBuffer(totalBytesRead);
-            memcpy(tempBuffer.data(), buffer.data(), totalBytesRead);
-            
-            size_t bytesPerChannel = totalBytesRead / 2;
-            
-            if (INTERLEAVE_BY_BYTE) {
-                // Interleave BYTE by BYTE: [L0 R0 L1 R1 L2 R2...]
-                uint8_t* src = tempBuffer.data();
-                uint8_t* dst = buffer.data();
-                
-                for (size_t i = 0; i < bytesPerChannel; i++) {
-                    dst[i * 2]     = src[i];                     // Left byte
-                    dst[i * 2 + 1] = src[bytesPerChannel + i];   // Right byte
-                }
-            
-                if (!m_interleavingLoggedDOP) {
-                    DEBUG_LOG("[AudioDecoder] 🔄 PLANAR → INTERLEAVED (byte-by-byte)");
-                    m_interleavingLoggedDOP = true;
-                }
-            } else {
-                // ✅ WORKING: Interleave by 32-bit WORDS
-                size_t wordsPerChannel = bytesPerChannel / 4;
-                
-                uint32_t* src = reinterpret_cast<uint32_t*>(tempBuffer.data());
-                uint32_t* dst = reinterpret_cast<uint32_t*>(buffer.data());
-                
-                for (size_t i = 0; i < wordsPerChannel; i++) {
-                    dst[i * 2]     = src[i];                      // Left word
-                    dst[i * 2 + 1] = src[wordsPerChannel + i];    // Right word
-                }
-                if (!m_interleavingLoggedNative) {
-                    DEBUG_LOG("[AudioDecoder] ✅ PLANAR → INTERLEAVED (32-bit words)");
-                    m_interleavingLoggedNative = true;
-                }
-            }
-        }
-
-
     // ✅ DEBUG: Dump first 64 bytes for analysis
     if (g_verbose) {
     if (!m_dumpedFirstPacket && totalBytesRead >= 64) {
@@ -639,42 +1317,6 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
     }
     }
 
-    // ✅ CRITICAL: Convert DFF for Diretta (Bit reversal ONLY, no byte swap)
-    // According to SDK: FMT_DSD_SIZ_32 uses Little Endian for BOTH DSF and DFF
-    // Only the BIT order differs (LSB vs MSB)
-    if (m_trackInfo.codec.find("msbf") != std::string::npos) {
-        uint8_t* data = buffer.data();
-        
-        // Lookup table for bit reversal
-        static const uint8_t bitReverseTable[256] = {
-            0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
-            0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
-            0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
-            0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
-            0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
-            0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
-            0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
-            0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
-            0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
-            0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
-            0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
-            0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
-            0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
-            0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
-            0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
-            0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
-        };
-        
-        // Bit reversal ONLY (no byte swap!)
-        for (size_t i = 0; i < totalBytesRead; i++) {
-            data[i] = bitReverseTable[data[i]];
-        }
-    
-        if (!m_bitReversalLogged) {
-            std::cout << "[AudioDecoder] 🔄 DFF: Bit reversal ONLY (MSB→LSB, keep LE)" << std::endl;
-            m_bitReversalLogged = true;
-        }
-    }
         return (totalBytesRead * 8) / m_trackInfo.channels;
     }
 
@@ -682,13 +1324,56 @@ size_t AudioDecoder::readSamples(AudioBuffer& buffer, size_t numSamples,
     // PCM MODE - Normal decoding with resampling
     // ══════════════════════════════════════════════════════════════
     
-    if (!m_codecContext || m_eof) {
+    if ((!m_codecContext && !m_passthrough) || (m_eof && m_remainingCount == 0)) {
         return 0;
     }
     
+    // ⭐ Indexed seek lands on the second before the target:
+    // decode and drop the audio up to it
+    if (m_skipSamples > 0 && numSamples > 0) {
+        size_t skip = static_cast<size_t>(av_rescale(m_skipSamples, outputRate, m_trackInfo.sampleRate));
+        m_skipSamples = 0;
+        while (skip > 0) {
+            size_t dropped = decodeSamples(buffer, std::min(skip, numSamples), outputRate, outputBits);
+            if (dropped == 0) {
+                return 0;
+            }
+            skip -= dropped;
+        }
+    }
+    
+    // ⭐ Passthrough: pick the kernel for this output format, or fall
+    // back to the real decoder if it needs resampling or truncation
+    if (m_passthrough && !m_pcmKernel) {
+        const AVCodecParameters* codecpar = m_formatContext->streams[m_audioStreamIndex]->codecpar;
+        if (outputRate == m_trackInfo.sampleRate) {
+            m_pcmKernel = selectPcmKernel(codecpar->codec_id, (outputBits == 16) ? 2 : 4, m_sourceSampleBytes);
+        }
+        
+        if (!m_pcmKernel) {
+            DEBUG_LOG("[AudioDecoder] Passthrough cannot produce " << outputRate << "Hz/" << outputBits
+                      << "bit, opening decoder");
+            const AVCodec* codec = avcodec_find_decoder(codecpar->codec_id);
+            bool reused = false;
+            if (!codec || !openCodec(codec, codecpar, reused)) {
+                return 0;
+            }
+            m_passthrough = false;
+        }
+    }
+    
     // Initialize resampler if needed (not for DSD)
-    if (!m_trackInfo.isDSD && !m_swrContext) {
-        if (!initResampler(outputRate, outputBits)) {
+    if (!m_trackInfo.isDSD && !m_swrContext && !m_frameKernel && !m_passthrough) {
+        // ⭐ Same rate: only a layout/sample format conversion, no swresample
+        const char* kernelName = nullptr;
+        if (outputRate == static_cast<uint32_t>(m_codecContext->sample_rate)) {
+            m_frameKernel = PcmKernels::selectFrameKernel(m_codecContext->sample_fmt, m_trackInfo.channels,
+                                                          (outputBits == 16) ? 2 : 4, kernelName);
+        }
+        
+        if (m_frameKernel) {
+            DEBUG_LOG("[AudioDecoder] ⚡ Format conversion without swresample: " << kernelName);
+        } else if (!initResampler(outputRate, outputBits)) {
             return 0;
         }
     }
@@ -735,6 +1420,10 @@ if (m_trackInfo.isDSD) {
         }
     }
     
+    if (m_passthrough) {
+        return totalSamplesRead + readPassthrough(outputPtr, numSamples - totalSamplesRead, bytesPerSample);
+    }
+    
     AVPacket* packet = av_packet_alloc();
     AVFrame* frame = av_frame_alloc();
     
@@ -746,9 +1435,17 @@ if (m_trackInfo.isDSD) {
     
     while (totalSamplesRead < numSamples && !m_eof) {
         // Read packet
-        int ret = av_read_frame(m_formatContext, packet);
+        int ret = m_draining ? AVERROR_EOF : av_read_frame(m_formatContext, packet);
         
-        if (ret < 0) {
+        // ⭐ Frame threads still hold the last frames at the end of the
+        // stream: flush them out of the decoder before reporting EOF
+        if (ret == AVERROR_EOF && m_codecContext->thread_count > 1) {
+            if (!m_draining) {
+                avcodec_send_packet(m_codecContext, nullptr);
+                m_draining = true;
+            }
+            ret = 0;
+        } else if (ret < 0) {
             // Log position when EOF occurs
             if (m_formatContext->pb && m_formatContext->pb->pos > 0) {
                 std::cout << "[AudioDecoder] Bytes read from stream: " << m_formatContext->pb->pos << std::endl;
@@ -760,11 +1457,13 @@ if (m_trackInfo.isDSD) {
                 
                 // Check if we read the expected duration
                 std::cout << "[AudioDecoder] Samples decoded: " << totalSamplesRead << std::endl;
-            } else if (ret == AVERROR(ETIMEDOUT)) {
-                std::cerr << "[AudioDecoder] ⚠️  Timeout - connection too slow or lost" << std::endl;
-                m_eof = true;
-            } else if (ret == AVERROR(ECONNRESET)) {
-                std::cerr << "[AudioDecoder] ⚠️  Connection reset by server" << std::endl;
+            } else if (ret == AVERROR(ETIMEDOUT) || ret == AVERROR(ECONNRESET)) {
+                std::cerr << "[AudioDecoder] ⚠️  " << (ret == AVERROR(ETIMEDOUT)
+                    ? "Timeout - connection too slow or lost" : "Connection reset by server") << std::endl;
+                // ⭐ Direct HTTP input: reconnect and carry on at the next packet
+                if (resumeDirect()) {
+                    continue;
+                }
                 m_eof = true;
             } else if (ret == AVERROR_EXIT) {
                 std::cerr << "[AudioDecoder] ⚠️  Exit requested" << std::endl;
@@ -778,19 +1477,35 @@ if (m_trackInfo.isDSD) {
             break;
         }
         
-        // Skip non-audio packets
-        if (packet->stream_index != m_audioStreamIndex) {
+        if (!m_draining) {
+            // Where to pick up if a direct HTTP connection drops
+            if (packet->pos >= 0) {
+                m_resumePos = packet->pos + packet->size;
+            }
+            m_resumeAttempts = 0;
+            
+            // Skip non-audio packets
+            if (packet->stream_index != m_audioStreamIndex) {
+                av_packet_unref(packet);
+                continue;
+            }
+            
+            if (packet->pts != AV_NOPTS_VALUE) {
+                m_resumePts = packet->pts + packet->duration;
+            }
+            
+            if (m_indexing) {
+                indexPacket(packet);
+            }
+            
+            // Send packet to decoder
+            ret = avcodec_send_packet(m_codecContext, packet);
             av_packet_unref(packet);
-            continue;
-        }
-        
-        // Send packet to decoder
-        ret = avcodec_send_packet(m_codecContext, packet);
-        av_packet_unref(packet);
-        
-        if (ret < 0) {
-            std::cerr << "[AudioDecoder] Error sending packet to decoder" << std::endl;
-            break;
+            
+            if (ret < 0) {
+                std::cerr << "[AudioDecoder] Error sending packet to decoder" << std::endl;
+                break;
+            }
         }
         
         // Receive decoded frames
@@ -798,6 +1513,10 @@ if (m_trackInfo.isDSD) {
             ret = avcodec_receive_frame(m_codecContext, frame);
             
             if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                if (m_draining) {
+                    m_eof = true;
+                    DEBUG_LOG("[AudioDecoder] EOF reached (decoder drained)");
+                }
                 break;
             } else if (ret < 0) {
                 std::cerr << "[AudioDecoder] Error receiving frame from decoder" << std::endl;
@@ -840,7 +1559,25 @@ if (m_trackInfo.isDSD) {
                 // PCM: Resample if needed
                 size_t samplesNeeded = numSamples - totalSamplesRead;
                 
-                if (m_swrContext) {
+                if (m_frameKernel) {
+                    // Identity rate: convert straight into the output
+                    size_t samplesToUse = std::min(frameSamples, samplesNeeded);
+                    
+                    m_frameKernel(frame->extended_data, 0, samplesToUse, m_trackInfo.channels, outputPtr);
+                    outputPtr += samplesToUse * bytesPerSample;
+                    totalSamplesRead += samplesToUse;
+                    
+                    // Rest of the frame waits in the internal buffer, already converted
+                    if (frameSamples > samplesToUse) {
+                        size_t excess = frameSamples - samplesToUse;
+                        if (m_remainingSamples.size() < excess * bytesPerSample) {
+                            m_remainingSamples.resize(excess * bytesPerSample);
+                        }
+                        m_frameKernel(frame->extended_data, samplesToUse, excess, m_trackInfo.channels,
+                                      m_remainingSamples.data());
+                        m_remainingCount = excess;
+                    }
+                } else if (m_swrContext) {
                     // Calculate TOTAL output samples (without limiting)
                     int64_t totalOutSamples = av_rescale_rnd(
                         swr_get_delay(m_swrContext, m_codecContext->sample_rate) + frameSamples,
@@ -932,9 +1669,169 @@ if (m_trackInfo.isDSD) {
     av_packet_free(&packet);
     av_frame_free(&frame);
     
+    // ⭐ End of stream: the resampler still holds its filter delay, the
+    // last milliseconds of the track (gapless needs them)
+    if (m_eof && m_swrContext && !m_swrFlushed) {
+        m_swrFlushed = true;
+        int pending = swr_get_out_samples(m_swrContext, 0);
+        if (pending > 0) {
+            AudioBuffer tail(static_cast<size_t>(pending) * bytesPerSample);
+            uint8_t* tailPtr = tail.data();
+            int flushed = swr_convert(m_swrContext, &tailPtr, pending, nullptr, 0);
+            if (flushed > 0) {
+                size_t samplesToUse = std::min(static_cast<size_t>(flushed), numSamples - totalSamplesRead);
+                memcpy(outputPtr, tail.data(), samplesToUse * bytesPerSample);
+                totalSamplesRead += samplesToUse;
+                
+                size_t excess = static_cast<size_t>(flushed) - samplesToUse;
+                if (excess > 0) {
+                    size_t offset = m_remainingCount * bytesPerSample;
+                    if (m_remainingSamples.size() < offset + excess * bytesPerSample) {
+                        AudioBuffer grown(offset + excess * bytesPerSample);
+                        memcpy(grown.data(), m_remainingSamples.data(), offset);
+                        m_remainingSamples = std::move(grown);
+                    }
+                    memcpy(m_remainingSamples.data() + offset, tail.data() + samplesToUse * bytesPerSample,
+                           excess * bytesPerSample);
+                    m_remainingCount += excess;
+                }
+                DEBUG_LOG("[AudioDecoder] Resampler tail: " << flushed << " samples");
+            }
+        }
+    }
+    
     return totalSamplesRead;
 }
 
+size_t AudioDecoder::dsdPacketToSink(const uint8_t* data, size_t size, uint8_t* out) {
+    // DSF packets are planar per block ([LLLL...][RRRR...]), DFF packets
+    // byte-interleaved; the sink wants 32-bit groups interleaved, LSB first
+    bool msbFirst = (m_trackInfo.codec.find("msbf") != std::string::npos);
+    bool planar = (m_trackInfo.codec.find("planar") != std::string::npos);
+    size_t usable;
+    
+    if (m_trackInfo.channels == 2) {
+        size_t bytesPerChannel = (size / 2) & ~static_cast<size_t>(3);
+        if (planar) {
+            const uint8_t* left = data;
+            const uint8_t* right = data + size / 2;
+            if (msbFirst) {
+                DsdKernels::planarStereo<true>(left, right, out, bytesPerChannel);
+            } else {
+                DsdKernels::planarStereo<false>(left, right, out, bytesPerChannel);
+            }
+        } else if (msbFirst) {
+            DsdKernels::byteInterleavedStereo<true>(data, out, bytesPerChannel);
+        } else {
+            DsdKernels::byteInterleavedStereo<false>(data, out, bytesPerChannel);
+        }
+        usable = bytesPerChannel * 2;
+        
+        if (!m_interleavingLoggedNative) {
+            DEBUG_LOG("[AudioDecoder] ✅ " << (planar ? "PLANAR" : "BYTE-INTERLEAVED")
+                      << " → INTERLEAVED (32-bit words, per packet)");
+            m_interleavingLoggedNative = true;
+        }
+    } else {
+        usable = size - size % m_trackInfo.channels;
+        memcpy(out, data, usable);
+        if (msbFirst) {
+            DsdKernels::reverseBits(out, usable);
+        }
+    }
+    
+    if (usable < size && !m_dsdWarningShown) {
+        std::cerr << "[AudioDecoder] ⚠️  DSD packet of " << size << " bytes is not whole 32-bit groups, "
+                  << (size - usable) << " bytes dropped" << std::endl;
+        m_dsdWarningShown = true;
+    }
+    if (msbFirst && !m_bitReversalLogged) {
+        std::cout << "[AudioDecoder] 🔄 DFF: Bit reversal ONLY (MSB→LSB, keep LE)" << std::endl;
+        m_bitReversalLogged = true;
+    }
+    return usable;
+}
+
+size_t AudioDecoder::readPassthrough(uint8_t* output, size_t numSamples, size_t bytesPerFrame) {
+    size_t channels = m_trackInfo.channels;
+    size_t sourceFrameBytes = m_sourceSampleBytes * channels;
+    size_t samplesRead = 0;
+    
+    while (samplesRead < numSamples && !m_eof) {
+        int ret = av_read_frame(m_formatContext, m_packet);
+        if (ret < 0) {
+            if (ret == AVERROR_EOF) {
+                DEBUG_LOG("[AudioDecoder] EOF reached (passthrough)");
+            } else {
+                char errbuf[AV_ERROR_MAX_STRING_SIZE];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                std::cerr << "[AudioDecoder] ⚠️  Read error (" << ret << "): " << errbuf << std::endl;
+            }
+            m_eof = true;
+            break;
+        }
+        
+        if (m_packet->stream_index != m_audioStreamIndex) {
+            av_packet_unref(m_packet);
+            continue;
+        }
+        
+        // WAV/AIFF demuxers cut packets on block_align boundaries
+        size_t frames = m_packet->size / sourceFrameBytes;
+        size_t framesNow = std::min(frames, numSamples - samplesRead);
+        
+        m_pcmKernel(m_packet->data, output + samplesRead * bytesPerFrame, framesNow * channels);
+        samplesRead += framesNow;
+        
+        // Rest of the packet waits in the internal buffer, already converted
+        if (frames > framesNow) {
+            size_t excess = frames - framesNow;
+            if (m_remainingSamples.size() < excess * bytesPerFrame) {
+                m_remainingSamples.resize(excess * bytesPerFrame);
+            }
+            m_pcmKernel(m_packet->data + framesNow * sourceFrameBytes, m_remainingSamples.data(),
+                        excess * channels);
+            m_remainingCount = excess;
+        }
+        
+        av_packet_unref(m_packet);
+    }
+    
+    return samplesRead;
+}
+
+void AudioDecoder::setFixedOutput(uint32_t rate, uint32_t bits) {
+    s_fixedRate.store(rate);
+    s_fixedBits.store((bits == 16 || bits == 32) ? bits : 24);
+}
+
+void AudioDecoder::updateOutputInfo() {
+    m_outputInfo = m_trackInfo;
+    
+    uint32_t rate = s_fixedRate.load();
+    if (rate == 0 || m_trackInfo.isDSD || m_trackInfo.sampleRate == 0) {
+        return;
+    }
+    
+    m_outputInfo.sampleRate = rate;
+    m_outputInfo.bitDepth = s_fixedBits.load();
+    m_outputInfo.duration = static_cast<uint64_t>(av_rescale(static_cast<int64_t>(m_trackInfo.duration),
+                                                             rate, m_trackInfo.sampleRate));
+    
+    if (m_outputInfo.sampleRate != m_trackInfo.sampleRate || m_outputInfo.bitDepth != m_trackInfo.bitDepth) {
+        std::cout << "[AudioDecoder] 🔒 Fixed output: " << m_trackInfo.sampleRate << "Hz/"
+                  << m_trackInfo.bitDepth << "bit → " << m_outputInfo.sampleRate << "Hz/"
+                  << m_outputInfo.bitDepth << "bit" << std::endl;
+    }
+}
+
+double AudioDecoder::resamplerDelayMs() const {
+    if (!m_swrContext) {
+        return 0.0;
+    }
+    return static_cast<double>(swr_get_delay(m_swrContext, 1000000)) / 1000.0;
+}
+
 bool AudioDecoder::initResampler(uint32_t outputRate, uint32_t outputBits) {
     // Don't resample DSD!
     if (m_trackInfo.isDSD) {
@@ -984,15 +1881,40 @@ bool AudioDecoder::initResampler(uint32_t outputRate, uint32_t outputBits) {
         return false;
     }
     
+    // ⭐ Rate conversion: soxr at very high quality (28-bit precision),
+    // TPDF dither when reducing to 16 bit
+    bool rateChange = (outputRate != static_cast<uint32_t>(m_codecContext->sample_rate));
+    if (rateChange) {
+        av_opt_set_int(m_swrContext, "resampler", SWR_ENGINE_SOXR, 0);
+        av_opt_set_double(m_swrContext, "precision", 28.0, 0);
+    }
+    if (outputBits == 16 && av_get_bytes_per_sample(m_codecContext->sample_fmt) > 2) {
+        av_opt_set_int(m_swrContext, "dither_method", SWR_DITHER_TRIANGULAR, 0);
+    }
+    
     // Initialize resampler
-    if (swr_init(m_swrContext) < 0) {
+    bool soxr = rateChange;
+    int initRet = swr_init(m_swrContext);
+    if (initRet < 0 && rateChange) {
+        // FFmpeg built without libsoxr: swr with a long filter instead
+        std::cout << "[AudioDecoder] ⚠️  soxr not available in this FFmpeg build, using swr" << std::endl;
+        av_opt_set_int(m_swrContext, "resampler", SWR_ENGINE_SWR, 0);
+        av_opt_set_int(m_swrContext, "filter_size", 64, 0);
+        av_opt_set_int(m_swrContext, "phase_shift", 12, 0);
+        soxr = false;
+        initRet = swr_init(m_swrContext);
+    }
+    
+    if (initRet < 0) {
         std::cerr << "[AudioDecoder] Failed to initialize resampler" << std::endl;
         swr_free(&m_swrContext);
         return false;
     }
+    m_swrFlushed = false;
     
     std::cout << "[AudioDecoder] Resampler: " << m_codecContext->sample_rate 
-              << "Hz → " << outputRate << "Hz, " << outputBits << "bit" << std::endl;
+              << "Hz → " << outputRate << "Hz, " << outputBits << "bit"
+              << (rateChange ? (soxr ? " (soxr)" : " (swr)") : "") << std::endl;
     
     return true;
 }
@@ -1018,6 +1940,7 @@ AudioEngine::~AudioEngine() {
 }
 
 void AudioEngine::waitForPreloadThread() {
+    std::lock_guard<std::mutex> lock(m_preloadThreadMutex);
     if (m_preloadThread.joinable()) {
         m_preloadThread.join();
     }
@@ -1031,6 +1954,18 @@ void AudioEngine::setTrackChangeCallback(const TrackChangeCallback& callback) {
     m_trackChangeCallback = callback;
 }
 
+void AudioEngine::setSeekCallback(const SeekCallback& callback) {
+    m_seekCallback = callback;
+}
+
+void AudioEngine::setFormatAnnounceCallback(const FormatAnnounceCallback& callback) {
+    m_formatAnnounceCallback = callback;
+}
+
+void AudioEngine::setOutputDelayCallback(const OutputDelayCallback& callback) {
+    m_outputDelayCallback = callback;
+}
+
 void AudioEngine::setCurrentURI(const std::string& uri, const std::string& metadata, bool forceReopen) {
     std::lock_guard<std::mutex> lock(m_mutex);
     
@@ -1048,8 +1983,14 @@ void AudioEngine::setCurrentURI(const std::string& uri, const std::string& metad
                   << " - closing decoders to load new track" << std::endl;
         
         // Fermer les décodeurs pour forcer réouverture
+        m_ahead.reset();
+        m_memory.reset();
+        m_nextMemory.reset();
         m_currentDecoder.reset();
         m_nextDecoder.reset();
+        m_prebuffer = Prebuffer();
+        m_nextPrebuffer = Prebuffer();
+        m_nextFormatChanges = false;
         
         // ⭐⭐⭐ CRITICAL FIX: Clear gapless queue when changing URI
         // Otherwise, the old "next track" will play after the new track finishes!
@@ -1066,6 +2007,7 @@ void AudioEngine::setCurrentURI(const std::string& uri, const std::string& metad
         
         // Réinitialiser la position
         m_samplesPlayed = 0;
+        publishPosition(0.0);
         m_silenceCount = 0;
         m_isDraining = false;
         
@@ -1074,6 +2016,7 @@ void AudioEngine::setCurrentURI(const std::string& uri, const std::string& metad
             m_preloadRunning.store(false, std::memory_order_release);
             std::cout << "[AudioEngine] ⚠️  Cancelling ongoing preload" << std::endl;
         }
+        clearPreloaded();
         
         // Si on est en PLAYING, on va automatiquement ouvrir la nouvelle piste
         // au prochain process()
@@ -1090,6 +2033,9 @@ void AudioEngine::setNextURI(const std::string& uri, const std::string& metadata
     }
     m_pendingNextTrack.store(true, std::memory_order_release);
     std::cout << "[AudioEngine] Next URI queued (gapless)" << std::endl;
+    
+    // ⭐ Open and pre-decode now, not at EOF on the audio thread
+    startPreload(uri, metadata);
 }
 
 void AudioEngine::setTrackEndCallback(const TrackEndCallback& callback) {
@@ -1119,7 +2065,11 @@ bool AudioEngine::play() {
     std::cout << "[AudioEngine] Play" << std::endl;
     
     // Open current track if not already open OR if at EOF
-    if (!m_currentDecoder || m_currentDecoder->isEOF()) {
+    // (Memory play and fixed output: the decoder's EOF belongs to their thread)
+    bool atEOF = m_currentDecoder &&
+                 ((m_memory && m_memory->covers()) ? m_memory->playedOut()
+                  : m_ahead ? m_ahead->playedOut() : m_currentDecoder->isEOF());
+    if (!m_currentDecoder || atEOF) {
         std::cout << "[AudioEngine] Opening track (new or after EOF)" << std::endl;
         
         if (!openCurrentTrack()) {
@@ -1130,18 +2080,14 @@ bool AudioEngine::play() {
     
     m_state = State::PLAYING;
     m_samplesPlayed = 0;
+    publishPosition(0.0);
     m_silenceCount = 0;
     m_isDraining = false;
     
     // Preload next track in background if set (for gapless)
-    // Use joinable thread instead of detached to prevent use-after-free
-    if (!m_nextURI.empty() && !m_nextDecoder && !m_preloadRunning.load(std::memory_order_acquire)) {
-        waitForPreloadThread();
-        m_preloadRunning.store(true, std::memory_order_release);
-        m_preloadThread = std::thread([this]() {
-            preloadNextTrack();
-            m_preloadRunning.store(false, std::memory_order_release);
-        });
+    if (!m_nextURI.empty() && !m_nextDecoder && 
+        !m_preloadRunning.load(std::memory_order_acquire) && !m_preloadReady.load(std::memory_order_acquire)) {
+        startPreload(m_nextURI, m_nextMetadata);
     }
     
     return true;
@@ -1162,7 +2108,9 @@ void AudioEngine::stop() {
     }
 
     // Wait for preload thread before cleanup
+    m_preloadRunning.store(false, std::memory_order_release);
     waitForPreloadThread();
+    clearPreloaded();
 
     std::cout << "[AudioEngine] ✓ State changed to STOPPED" << std::endl;
 
@@ -1172,11 +2120,18 @@ void AudioEngine::stop() {
         std::cout << "[AudioEngine] Cleaning up decoders and state..." << std::endl;
         
         // Fermer les décodeurs
+        m_ahead.reset();
+        m_memory.reset();
+        m_nextMemory.reset();
         m_currentDecoder.reset();
         m_nextDecoder.reset();
+        m_prebuffer = Prebuffer();
+        m_nextPrebuffer = Prebuffer();
+        m_nextFormatChanges = false;
         
         // Réinitialiser la position
         m_samplesPlayed = 0;
+        publishPosition(0.0);
         m_silenceCount = 0;
         m_isDraining = false;
         
@@ -1201,13 +2156,58 @@ void AudioEngine::pause() {
         std::cout << "[AudioEngine] ✓ State changed to PAUSED" << std::endl;
     }
     
-    std::cout << "[AudioEngine] Pause" << std::endl;
+    std::cout << "[AudioEngine] Pause" << std::endl;
+}
+double AudioEngine::getPosition() const {
+    PlaybackPosition position = getPlaybackPosition();
+    if (m_state.load() != State::PLAYING) {
+        return position.seconds;
+    }
+    return position.at(std::chrono::steady_clock::now());
+}
+
+PlaybackPosition AudioEngine::getPlaybackPosition() const {
+    std::lock_guard<std::mutex> lock(m_positionMutex);
+    return m_playbackPosition;
+}
+
+InputStats AudioEngine::getInputStats() const {
+    InputStats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_positionMutex);
+        stats = m_inputStats;
+    }
+    stats.pool = HttpConnectionPool::getStats();
+    return stats;
+}
+
+void AudioEngine::publishInputStats() {
+    // Once per second: PrefetchIO::getStats() takes the fill thread's lock
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_inputStatsTime < std::chrono::seconds(1)) {
+        return;
+    }
+    m_inputStatsTime = now;
+    
+    InputStats stats;
+    stats.prefetch = m_currentDecoder && m_currentDecoder->getInputStats(stats.prefetchStats);
+    
+    std::lock_guard<std::mutex> lock(m_positionMutex);
+    m_inputStats = stats;
 }
-double AudioEngine::getPosition() const {
-    if (m_currentTrackInfo.sampleRate == 0) {
-        return 0.0;
-    }
-    return static_cast<double>(m_samplesPlayed) / m_currentTrackInfo.sampleRate;
+
+void AudioEngine::publishPosition(double queued) {
+    PlaybackPosition position;
+    position.timestamp = std::chrono::steady_clock::now();
+    if (m_currentTrackInfo.sampleRate > 0) {
+        // The tail of the previous track may still be queued after a splice
+        double handedOver = static_cast<double>(m_samplesPlayed) / m_currentTrackInfo.sampleRate;
+        position.seconds = std::max(0.0, handedOver - queued);
+        position.queued = handedOver - position.seconds;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_positionMutex);
+    m_playbackPosition = position;
 }
 
 bool AudioEngine::process(size_t samplesNeeded) {
@@ -1241,13 +2241,17 @@ bool AudioEngine::process(size_t samplesNeeded) {
                     targetSeconds = 0;
                 }
                 
-                if (info.isDSD) {
-                    DEBUG_LOG("[AudioEngine] DSD seek ignored (no-op)");
-                     // Don't call decoder->seek()
-            } else {
-                if (m_currentDecoder->seek(targetSeconds)) {
+                // ⭐ Memory play: instant inside the decoded buffer
+                bool moved = m_memory ? m_memory->seek(targetSeconds)
+                           : m_ahead ? m_ahead->seek(targetSeconds)
+                                     : m_currentDecoder->seek(targetSeconds);
+                if (moved) {
+                    // Pre-decoded audio belongs to the old position
+                    m_prebuffer = Prebuffer();
+                    
                     // Update position
                     m_samplesPlayed = static_cast<uint64_t>(targetSeconds * info.sampleRate);
+                    publishPosition(0.0);
                     
                     // Reset drainage counters
                     m_silenceCount = 0;
@@ -1256,10 +2260,14 @@ bool AudioEngine::process(size_t samplesNeeded) {
                     std::cout << "[AudioEngine] ✓ Seek completed to " << targetSeconds << "s" << std::endl;
                     DEBUG_LOG("[AudioEngine] ✓ Position updated to " 
                               << m_samplesPlayed << " samples (" << targetSeconds << "s)");
+                    
+                    // Drop audio buffered from the old position
+                    if (m_seekCallback) {
+                        m_seekCallback(targetSeconds);
+                    }
                 } else {
                     std::cerr << "[AudioEngine] ❌ Seek failed in decoder" << std::endl;
                 }
-            }
        
         }
         // Continue processing after seek
@@ -1283,6 +2291,9 @@ bool AudioEngine::process(size_t samplesNeeded) {
         m_pendingNextTrack.store(false, std::memory_order_release);
         std::cout << "[AudioEngine] Pending next URI applied (gapless)" << std::endl;
     }
+    
+    // Take over the next track once the preload thread has it ready
+    adoptPreloaded();
 
     // Safety net: auto-reopen if decoder null while PLAYING
     if (!m_currentDecoder) {
@@ -1303,28 +2314,63 @@ bool AudioEngine::process(size_t samplesNeeded) {
         }
     }
 
-    // Determine output format
+    // Determine output format: the source format (bit-perfect), or the
+    // fixed output format for PCM (see AudioDecoder::setFixedOutput())
     uint32_t outputRate = m_currentTrackInfo.sampleRate;
     uint32_t outputBits = m_currentTrackInfo.bitDepth;
     uint32_t outputChannels = m_currentTrackInfo.channels;
     
-    // For DSD, keep native rate and bit depth
-    if (!m_currentTrackInfo.isDSD) {
-        // For PCM, we can target specific output format if needed
-        // For now, keep source format (bit-perfect)
+    // ⭐ Rate conversion runs on a thread of its own, not here
+    if (!m_ahead && !m_memory && m_currentDecoder->resamples()) {
+        m_ahead = std::make_unique<ConvertAhead>(m_currentDecoder.get());
     }
     
-    // Read samples from decoder
-    size_t samplesRead = m_currentDecoder->readSamples(
-        m_buffer,
-        samplesNeeded,
-        outputRate,
-        outputBits
-    );
+    size_t samplesRead;
     
-    // ⚡ CRITICAL: Preload next track as soon as EOF flag is set (for gapless)
-    // Check AFTER readSamples() because EOF flag is set during the read
-    if (!m_nextDecoder && !m_nextURI.empty() && m_currentDecoder->isEOF()) {
+    if (m_prebuffer.pos < m_prebuffer.samples) {
+        // ⭐ Start of a preloaded track: play out what was decoded ahead
+        samplesRead = std::min(samplesNeeded, m_prebuffer.samples - m_prebuffer.pos);
+        size_t offset = bytesForSamples(m_currentTrackInfo, m_prebuffer.pos);
+        size_t bytes = bytesForSamples(m_currentTrackInfo, samplesRead);
+        if (m_buffer.size() < bytes) {
+            m_buffer.resize(bytes);
+        }
+        std::memcpy(m_buffer.data(), m_prebuffer.data.data() + offset, bytes);
+        m_prebuffer.pos += samplesRead;
+        
+        if (m_prebuffer.pos >= m_prebuffer.samples) {
+            m_prebuffer = Prebuffer();
+        }
+    } else if (m_memory && m_memory->covers()) {
+        // ⭐ Memory play: slices of the decoded track, no network or codec work
+        size_t bytes = bytesForSamples(m_currentTrackInfo, samplesNeeded);
+        if (m_buffer.size() < bytes) {
+            m_buffer.resize(bytes);
+        }
+        samplesRead = m_memory->read(m_buffer.data(), samplesNeeded);
+    } else if (m_ahead) {
+        // ⭐ Fixed output: already converted by the ConvertAhead thread
+        size_t bytes = bytesForSamples(m_currentTrackInfo, samplesNeeded);
+        if (m_buffer.size() < bytes) {
+            m_buffer.resize(bytes);
+        }
+        samplesRead = m_ahead->read(m_buffer.data(), samplesNeeded);
+    } else {
+        // Read samples from decoder
+        samplesRead = m_currentDecoder->readSamples(
+            m_buffer,
+            samplesNeeded,
+            outputRate,
+            outputBits
+        );
+    }
+    
+    // ⚡ Fallback: the background preload normally has the next track
+    // ready long before EOF; open it here only if it never started
+    bool currentEOF = (m_memory && m_memory->covers()) ? m_memory->decodedToEnd()
+                      : m_ahead ? m_ahead->playedOut() : m_currentDecoder->isEOF();
+    if (!m_nextDecoder && !m_nextURI.empty() && currentEOF &&
+        !m_preloadRunning.load(std::memory_order_acquire) && !m_preloadReady.load(std::memory_order_acquire)) {
         std::cout << "[AudioEngine] 📀 EOF flag detected, preloading next track for gapless..." << std::endl;
         preloadNextTrack();
     }
@@ -1345,9 +2391,19 @@ bool AudioEngine::process(size_t samplesNeeded) {
                 m_state = State::STOPPED;
                 return false;
             }
+            
+            if (m_trackStartPending) {
+                m_trackStartPending = false;
+                std::cout << "[AudioEngine] ⏱️  Track start: "
+                          << static_cast<int>(msSince(m_trackStartTime)) << "ms to first audio" << std::endl;
+            }
         }
         
         m_samplesPlayed += samplesRead;
+        
+        // ⭐ Position from the sink side: what the output still holds is not audible yet
+        publishPosition(m_outputDelayCallback ? m_outputDelayCallback() : 0.0);
+        publishInputStats();
     }
     
     // Check for actual end of data (no more samples can be read)
@@ -1360,8 +2416,15 @@ bool AudioEngine::process(size_t samplesNeeded) {
             m_silenceCount = 0;
         }
     
+        // Preload still in flight: wait for it rather than reopen here
+        if (!m_nextDecoder && !m_nextURI.empty() && m_preloadRunning.load(std::memory_order_acquire)) {
+            DEBUG_LOG("[AudioEngine] ⏳ Waiting for next track preload...");
+            waitForPreloadThread();
+            adoptPreloaded();
+        }
+    
         // Check if we have a next track ready for gapless
-        if (m_nextDecoder) {
+        if (m_nextDecoder && !m_nextFormatChanges) {
             std::cout << "[AudioEngine] 🎵 Transitioning to next track (gapless)..." << std::endl;
             m_isDraining = false;
             transitionToNextTrack();
@@ -1369,8 +2432,21 @@ bool AudioEngine::process(size_t samplesNeeded) {
         } 
         
         // ⭐ NEW (v1.0.16): Check if next track exists but decoder was cleared (format change)
-        if (!m_nextURI.empty()) {
+        if (!m_nextURI.empty() || m_nextDecoder) {
             std::cout << "[AudioEngine] 🔄 Next track with format change detected" << std::endl;
+            
+            // ⭐ Keep decoding across the boundary: the output plays out the old
+            // track and reconfigures in the background on the first new buffer.
+            // Open the next track here if the preload never did.
+            if (!m_nextDecoder) {
+                preloadNextTrack();
+            }
+            if (m_nextDecoder) {
+                m_isDraining = false;
+                transitionToNextTrack();
+                return true;
+            }
+            
             std::cout << "[AudioEngine] Transitioning with stop/start sequence..." << std::endl;
             
             // Save next URI before stopping
@@ -1395,6 +2471,8 @@ bool AudioEngine::process(size_t samplesNeeded) {
             
             // Stop current playback (will close DirettaOutput)
             std::cout << "[AudioEngine] Stopping for format change..." << std::endl;
+            m_ahead.reset();
+            m_memory.reset();
             m_currentDecoder.reset();
             
             // Reopen with new track (will be done in next process() call via openCurrentTrack())
@@ -1442,8 +2520,17 @@ bool AudioEngine::openCurrentTrack() {
     
     std::cout << "[AudioEngine] Opening track: " << m_currentURI.substr(0, 80) << "..." << std::endl;
     
+    m_trackStartTime = std::chrono::steady_clock::now();
+    m_trackStartPending = true;
+    m_prebuffer = Prebuffer();
+    m_ahead.reset();
+    m_memory.reset();
+    
     // Create decoder
     m_currentDecoder = std::make_unique<AudioDecoder>();
+    m_currentDecoder->setPrefetchSize(m_prefetchSize);
+    m_currentDecoder->setDecodeThreads(m_decodeThreads);
+    m_currentDecoder->setHints(DidlHints::parse(m_currentMetadata, m_currentURI));
     
     if (!m_currentDecoder->open(m_currentURI)) {
         std::cerr << "[AudioEngine] Failed to open track" << std::endl;
@@ -1453,6 +2540,9 @@ bool AudioEngine::openCurrentTrack() {
     
     m_currentTrackInfo = m_currentDecoder->getTrackInfo();
     
+    // ⭐ Memory play: decode the whole track in the background
+    m_memory = startMemoryTrack(m_currentDecoder.get());
+    
     std::cout << "[AudioEngine] ✓ Track opened: ";
     if (m_currentTrackInfo.isDSD) {
         std::cout << "DSD" << m_currentTrackInfo.dsdRate 
@@ -1480,6 +2570,9 @@ bool AudioEngine::preloadNextTrack() {
     
     // Create decoder for next track
     m_nextDecoder = std::make_unique<AudioDecoder>();
+    m_nextDecoder->setPrefetchSize(m_prefetchSize);
+    m_nextDecoder->setDecodeThreads(m_decodeThreads);
+    m_nextDecoder->setHints(DidlHints::parse(m_nextMetadata, m_nextURI));
     
     if (!m_nextDecoder->open(m_nextURI)) {
         std::cerr << "[AudioEngine] Failed to preload next track" << std::endl;
@@ -1511,17 +2604,17 @@ bool AudioEngine::preloadNextTrack() {
                   << (nextInfo.isDSD ? " (DSD)" : ""));
         DEBUG_LOG("[AudioEngine] 🔄 Will use stop/start sequence instead of gapless");
 
-        // Don't keep nextDecoder - force stop/start sequence
-        m_nextDecoder.reset();
-        
-        // ⭐ CRITICAL FIX (v1.0.16): Keep m_nextURI!
-        // Do NOT clear m_nextURI - it will be used for non-gapless transition
-        // The EOF handler will see format change and trigger proper reopen
-        // m_nextURI.clear();     // ❌ REMOVED - was causing next track to be lost
-        // m_nextMetadata.clear(); // ❌ REMOVED
+        // ⭐ Keep the opened decoder: the EOF handler runs the stop/start
+        // sequence with it instead of opening the track a second time
+        m_nextFormatChanges = true;
+        if (m_formatAnnounceCallback) {
+            m_formatAnnounceCallback(nextInfo);
+        }
         
         return false;
     }
+    
+    m_nextFormatChanges = false;
 
     DEBUG_LOG("[AudioEngine] ✓ Next track preloaded: "
               << m_nextDecoder->getTrackInfo().codec);
@@ -1536,7 +2629,12 @@ void AudioEngine::transitionToNextTrack() {
     m_currentURI = m_nextURI;
     m_currentMetadata = m_nextMetadata;
     
+    m_ahead.reset();
+    m_memory = std::move(m_nextMemory);   // Before the decoder it reads from goes
     m_currentDecoder = std::move(m_nextDecoder);
+    m_prebuffer = std::move(m_nextPrebuffer);
+    m_nextPrebuffer = Prebuffer();
+    m_nextFormatChanges = false;
     m_trackNumber++;
     m_samplesPlayed = 0;
     
@@ -1551,52 +2649,513 @@ void AudioEngine::transitionToNextTrack() {
         }
     }
 }
+
+// ═══════════════════════════════════════════════════════════════
+// ⭐ Background preload
+// ═══════════════════════════════════════════════════════════════
+
+size_t AudioEngine::bytesForSamples(const TrackInfo& info, size_t samples) {
+    if (info.isDSD) {
+        return (samples * info.channels) / 8;
+    }
+    // readSamples() layout: 16-bit = 2 bytes, 24/32-bit = 4 bytes (S32 container)
+    return samples * info.channels * (info.bitDepth == 16 ? 2 : 4);
+}
+
+size_t AudioEngine::samplesForBytes(const TrackInfo& info, size_t bytes) {
+    if (info.channels == 0) {
+        return 0;
+    }
+    if (info.isDSD) {
+        // Whole 32-bit groups per channel
+        return ((bytes * 8) / info.channels) & ~static_cast<size_t>(31);
+    }
+    return bytes / (info.channels * (info.bitDepth == 16 ? 2 : 4));
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ⭐ Memory play
+// ═══════════════════════════════════════════════════════════════
+
+std::unique_ptr<AudioEngine::MemoryTrack> AudioEngine::startMemoryTrack(AudioDecoder* decoder) {
+    size_t capBytes = m_memoryPlayBytes;
+    if (capBytes == 0) {
+        return nullptr;
+    }
+    
+    auto memory = std::make_unique<MemoryTrack>(decoder, capBytes);
+    if (!memory->valid()) {
+        std::cerr << "[AudioEngine] ⚠️  Memory play buffer unavailable, decoding while playing" << std::endl;
+        return nullptr;
+    }
+    return memory;
+}
+
+AudioEngine::MemoryTrack::MemoryTrack(AudioDecoder* decoder, size_t capBytes)
+    : m_decoder(decoder)
+    , m_info(decoder->getTrackInfo())
+{
+    // Sized from the duration (+1s) when known: only what is used gets locked
+    size_t bytes = capBytes;
+    if (m_info.duration > 0 && m_info.sampleRate > 0) {
+        bytes = std::min(bytes, bytesForSamples(m_info, m_info.duration + m_info.sampleRate));
+    }
+    m_maxSamples = samplesForBytes(m_info, bytes);
+    if (m_maxSamples == 0) {
+        return;
+    }
+    
+    size_t capacity = bytesForSamples(m_info, m_maxSamples);
+    void* map = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        return;
+    }
+    m_data = static_cast<uint8_t*>(map);
+    m_capacity = capacity;
+    
+    // Page-locked: the audio thread never takes a page fault on it
+    m_locked = (::mlock(m_data, m_capacity) == 0);
+    if (!m_locked) {
+        static std::atomic<bool> warned{false};
+        if (!warned.exchange(true)) {
+            std::cerr << "[AudioEngine] ⚠️  mlock failed (" << std::strerror(errno)
+                      << "): memory play buffers are not page-locked, run as root or raise LimitMEMLOCK"
+                      << std::endl;
+        }
+    }
+    
+    DEBUG_LOG("[AudioEngine] 🧠 Memory play: " << (m_capacity / (1024 * 1024)) << " MB buffer"
+              << (m_locked ? " (locked)" : ""));
+    start();
+}
+
+AudioEngine::MemoryTrack::~MemoryTrack() {
+    halt();
+    if (m_data) {
+        if (m_locked) {
+            ::munlock(m_data, m_capacity);
+        }
+        ::munmap(m_data, m_capacity);
+    }
+}
+
+void AudioEngine::MemoryTrack::start() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = false;
+    }
+    m_thread = std::thread(&MemoryTrack::fill, this);
+}
+
+void AudioEngine::MemoryTrack::halt() {
+    m_stop.store(true, std::memory_order_release);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_stop.store(false, std::memory_order_release);
+}
+
+void AudioEngine::MemoryTrack::fill() {
+    auto start = std::chrono::steady_clock::now();
+    const size_t chunkSamples = 8192;
+    AudioBuffer chunk;
+    
+    size_t have;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        have = m_samples;
+    }
+    
+    bool end = false;
+    while (!m_stop.load(std::memory_order_acquire) && have < m_maxSamples) {
+        size_t n = m_decoder->readSamples(chunk, std::min(chunkSamples, m_maxSamples - have),
+                                          m_info.sampleRate, m_info.bitDepth);
+        if (n == 0) {
+            end = true;
+            break;
+        }
+        std::memcpy(m_data + bytesForSamples(m_info, have), chunk.data(), bytesForSamples(m_info, n));
+        have += n;
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_samples = have;
+        }
+        m_cv.notify_all();
+    }
+    
+    if (end) {
+        m_complete.store(true, std::memory_order_release);
+        
+        // The whole track is in RAM: nothing left for the network or the codec
+        if (m_startSample == 0) {
+            m_decoder->close();
+            m_whole.store(true, std::memory_order_release);
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+    }
+    m_cv.notify_all();
+    
+    if (!m_stop.load(std::memory_order_acquire)) {
+        std::cout << "[AudioEngine] 🧠 Memory play: " << static_cast<double>(have) / m_info.sampleRate
+                  << "s decoded in " << static_cast<int>(msSince(start)) << "ms"
+                  << (m_whole ? ", whole track, decoder closed"
+                      : end ? ", to the end" : ", cap reached (decoder continues after)") << std::endl;
+    }
+}
+
+size_t AudioEngine::MemoryTrack::read(uint8_t* out, size_t samples) {
+    size_t available;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_samples > m_pos || m_done; });
+        available = m_samples - m_pos;
+    }
+    
+    // Decoded samples never change: copy outside the lock
+    size_t n = std::min(samples, available);
+    std::memcpy(out, m_data + bytesForSamples(m_info, m_pos), bytesForSamples(m_info, n));
+    m_pos += n;
+    return n;
+}
+
+bool AudioEngine::MemoryTrack::covers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pos < m_samples || !m_done || m_whole.load(std::memory_order_acquire);
+}
+
+bool AudioEngine::MemoryTrack::playedOut() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_done && m_pos >= m_samples;
+}
+
+bool AudioEngine::MemoryTrack::seek(double seconds) {
+    uint64_t target = (seconds > 0.0) ? static_cast<uint64_t>(seconds * m_info.sampleRate) : 0;
+    if (m_info.isDSD) {
+        target &= ~static_cast<uint64_t>(31);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (target >= m_startSample) {
+            uint64_t offset = target - m_startSample;
+            if (offset < m_samples || m_complete.load(std::memory_order_acquire)) {
+                m_pos = static_cast<size_t>(std::min<uint64_t>(offset, m_samples));
+                std::cout << "[AudioEngine] 🧠 Seek to " << seconds << "s inside the memory buffer" << std::endl;
+                return true;
+            }
+        }
+    }
+    
+    // Not decoded yet (or before a previous seek point): refill from the new position
+    halt();
+    if (!m_decoder->seek(seconds)) {
+        return false;
+    }
+    
+    m_startSample = target;
+    m_pos = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_samples = 0;
+    }
+    m_complete.store(false, std::memory_order_release);
+    start();
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// ⭐ Fixed output: rate conversion ahead of the audio thread
+// ═══════════════════════════════════════════════════════════════
+
+AudioEngine::ConvertAhead::ConvertAhead(AudioDecoder* decoder)
+    : m_decoder(decoder)
+    , m_info(decoder->getTrackInfo())
+{
+    m_capacity = std::max(static_cast<size_t>(AHEAD_SECONDS * m_info.sampleRate), 2 * CHUNK_SAMPLES);
+    m_ring.resize(bytesForSamples(m_info, m_capacity));
+    start();
+}
+
+AudioEngine::ConvertAhead::~ConvertAhead() {
+    halt();
+}
+
+void AudioEngine::ConvertAhead::start() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_written = 0;
+        m_read = 0;
+        m_done.store(false, std::memory_order_release);
+    }
+    m_thread = std::thread(&ConvertAhead::fill, this);
+}
+
+void AudioEngine::ConvertAhead::halt() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop.store(true, std::memory_order_release);
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_stop.store(false, std::memory_order_release);
+}
+
+void AudioEngine::ConvertAhead::fill() {
+    AudioBuffer chunk;
+    uint64_t written = 0;
+    
+    while (true) {
+        // Wait for room for a whole chunk
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() {
+                return m_stop.load(std::memory_order_acquire) || m_written - m_read + CHUNK_SAMPLES <= m_capacity;
+            });
+            if (m_stop.load(std::memory_order_acquire)) {
+                break;
+            }
+        }
+        
+        size_t n = m_decoder->readSamples(chunk, CHUNK_SAMPLES, m_info.sampleRate, m_info.bitDepth);
+        if (n == 0) {
+            break;
+        }
+        
+        // Free region of the ring: the reader never touches it
+        size_t at = static_cast<size_t>(written % m_capacity);
+        size_t first = std::min(n, m_capacity - at);
+        std::memcpy(m_ring.data() + bytesForSamples(m_info, at), chunk.data(), bytesForSamples(m_info, first));
+        if (n > first) {
+            std::memcpy(m_ring.data(), chunk.data() + bytesForSamples(m_info, first),
+                        bytesForSamples(m_info, n - first));
+        }
+        written += n;
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_written = written;
+        }
+        m_cv.notify_all();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done.store(true, std::memory_order_release);
+    }
+    m_cv.notify_all();
+}
+
+bool AudioEngine::ConvertAhead::playedOut() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_done.load(std::memory_order_acquire) && m_read >= m_written;
+}
+
+size_t AudioEngine::ConvertAhead::read(uint8_t* out, size_t samples) {
+    uint64_t from;
+    size_t n;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_written > m_read || m_done.load(std::memory_order_acquire); });
+        from = m_read;
+        n = static_cast<size_t>(std::min<uint64_t>(samples, m_written - m_read));
+    }
+    
+    // Converted samples stay put until m_read moves past them: copy outside the lock
+    size_t at = static_cast<size_t>(from % m_capacity);
+    size_t first = std::min(n, m_capacity - at);
+    std::memcpy(out, m_ring.data() + bytesForSamples(m_info, at), bytesForSamples(m_info, first));
+    if (n > first) {
+        std::memcpy(out + bytesForSamples(m_info, first), m_ring.data(), bytesForSamples(m_info, n - first));
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_read += n;
+    }
+    m_cv.notify_all();
+    return n;
+}
+
+bool AudioEngine::ConvertAhead::seek(double seconds) {
+    halt();
+    bool moved = m_decoder->seek(seconds);
+    start();
+    return moved;
+}
+
+void AudioEngine::startPreload(const std::string& uri, const std::string& metadata) {
+    // One preload at a time: a newer SetNextURI supersedes the previous one
+    std::lock_guard<std::mutex> threadLock(m_preloadThreadMutex);
+    m_preloadRunning.store(false, std::memory_order_release);
+    if (m_preloadThread.joinable()) {
+        m_preloadThread.join();
+    }
+    clearPreloaded();
+    
+    int64_t prefetchSize = m_prefetchSize;
+    int decodeThreads = m_decodeThreads;
+    bool memoryNext = m_memoryPlayNext;
+    DidlHints hints = DidlHints::parse(metadata, uri);
+    m_preloadRunning.store(true, std::memory_order_release);
+    
+    m_preloadThread = std::thread([this, uri, prefetchSize, decodeThreads, memoryNext, hints]() {
+        auto start = std::chrono::steady_clock::now();
+        DEBUG_LOG("[AudioEngine] 📥 Preloading next track in background...");
+        
+        auto decoder = std::make_unique<AudioDecoder>();
+        decoder->setPrefetchSize(prefetchSize);
+        decoder->setDecodeThreads(decodeThreads);
+        decoder->setHints(hints);
+        
+        if (!decoder->open(uri)) {
+            std::cerr << "[AudioEngine] ⚠️  Background preload failed to open next track" << std::endl;
+            m_preloadRunning.store(false, std::memory_order_release);
+            return;
+        }
+        
+        double openMs = msSince(start);
+        const TrackInfo& info = decoder->getTrackInfo();
+        
+        // ⭐ Memory play: the whole track decodes into RAM instead
+        std::unique_ptr<MemoryTrack> memory;
+        if (memoryNext) {
+            memory = startMemoryTrack(decoder.get());
+        }
+        
+        // Decode the first seconds, bounded
+        Prebuffer prebuffer;
+        size_t target = memory ? 0 : static_cast<size_t>(info.sampleRate) * PREBUFFER_SECONDS;
+        const size_t chunkSamples = 8192;
+        AudioBuffer chunk;
+        
+        prebuffer.data.reserve(bytesForSamples(info, target));
+        while (prebuffer.samples < target && m_preloadRunning.load(std::memory_order_acquire)) {
+            size_t n = decoder->readSamples(chunk, std::min(chunkSamples, target - prebuffer.samples),
+                                            info.sampleRate, info.bitDepth);
+            if (n == 0) {
+                break;
+            }
+            size_t bytes = bytesForSamples(info, n);
+            prebuffer.data.insert(prebuffer.data.end(), chunk.data(), chunk.data() + bytes);
+            prebuffer.samples += n;
+        }
+        
+        if (!m_preloadRunning.load(std::memory_order_acquire)) {
+            DEBUG_LOG("[AudioEngine] Background preload cancelled");
+            return;
+        }
+        
+        std::cout << "[AudioEngine] ⏱️  Next track preloaded: open " << static_cast<int>(openMs)
+                  << "ms, " << static_cast<double>(prebuffer.samples) / info.sampleRate
+                  << "s decoded ahead in " << static_cast<int>(msSince(start)) << "ms"
+                  << (memory ? ", decoding into memory" : "") << std::endl;
+        
+        {
+            std::lock_guard<std::mutex> lock(m_preloadMutex);
+            m_preloaded.uri = uri;
+            m_preloaded.decoder = std::move(decoder);
+            m_preloaded.prebuffer = std::move(prebuffer);
+            m_preloaded.memory = std::move(memory);
+        }
+        m_preloadReady.store(true, std::memory_order_release);
+        m_preloadRunning.store(false, std::memory_order_release);
+    });
+}
+
+void AudioEngine::adoptPreloaded() {
+    // Note: called from the audio thread with m_mutex held
+    if (!m_preloadReady.load(std::memory_order_acquire)) {
+        return;
+    }
+    
+    PreloadedTrack entry;
+    {
+        std::lock_guard<std::mutex> lock(m_preloadMutex);
+        entry = std::move(m_preloaded);
+        m_preloaded = PreloadedTrack();
+    }
+    m_preloadReady.store(false, std::memory_order_release);
+    
+    if (!entry.decoder || entry.uri != m_nextURI || m_nextDecoder) {
+        DEBUG_LOG("[AudioEngine] Discarding stale preload");
+        return;
+    }
+    
+    m_nextDecoder = std::move(entry.decoder);
+    m_nextPrebuffer = std::move(entry.prebuffer);
+    m_nextMemory = std::move(entry.memory);
+    
+    const TrackInfo& nextInfo = m_nextDecoder->getTrackInfo();
+    m_nextFormatChanges = (
+        nextInfo.sampleRate != m_currentTrackInfo.sampleRate ||
+        nextInfo.bitDepth != m_currentTrackInfo.bitDepth ||
+        nextInfo.channels != m_currentTrackInfo.channels ||
+        nextInfo.isDSD != m_currentTrackInfo.isDSD
+    );
+    
+    DEBUG_LOG("[AudioEngine] ✓ Next track ready (" << nextInfo.codec << ", "
+              << m_nextPrebuffer.samples << " samples pre-decoded)"
+              << (m_nextFormatChanges ? " - format change" : " - gapless"));
+    
+    if (m_nextFormatChanges && m_formatAnnounceCallback) {
+        m_formatAnnounceCallback(nextInfo);
+    }
+}
+
+void AudioEngine::clearPreloaded() {
+    std::unique_ptr<AudioDecoder> stale;
+    {
+        std::lock_guard<std::mutex> lock(m_preloadMutex);
+        stale = std::move(m_preloaded.decoder);
+        m_preloaded = PreloadedTrack();
+    }
+    m_preloadReady.store(false, std::memory_order_release);
+}
 bool AudioDecoder::seek(double seconds) {
-    if (!m_formatContext || m_audioStreamIndex < 0) {
+    // ⭐ Decoded-PCM cache: the position is an offset in the mapped file
+    if (m_pcmHit) {
+        const PcmCache::Header& header = m_pcmHit->header();
+        uint64_t target = (seconds > 0.0) ? static_cast<uint64_t>(seconds * header.outputRate) : 0;
+        target -= target % (header.isDSD ? 32 : header.frameSamples);
+        m_pcmPos = std::min(target, header.samples);
+        m_eof = (m_pcmPos >= header.samples);
+        std::cout << "[AudioDecoder] ✓ Seek to " << seconds << "s in cached PCM" << std::endl;
+        return true;
+    }
+    
+    // Only a decode from the start to the end is recorded
+    if (m_pcmRecord || m_pcmWriter) {
+        DEBUG_LOG("[AudioDecoder] Seek: decoded-PCM recording dropped");
+        m_pcmRecord = false;
+        m_pcmWriter.reset();
+    }
+    
+    if (!m_formatContext || !m_formatContext->pb || m_audioStreamIndex < 0) {
         std::cerr << "[AudioDecoder] Cannot seek: no file open" << std::endl;
         return false;
     }
     
-    // ⭐ v1.2.0: DSD raw seek with file repositioning
+    // ⭐ DSD: block-aligned seek in the native reader
     if (m_rawDSD) {
-        std::cout << "[AudioDecoder] DSD seek to " << seconds << "s (with file repositioning)" << std::endl;
-        
-        // Calculate byte position in DSD file
-        // For DSD: sampleRate = bits per second per channel
-        int64_t bitsPerSecond = m_trackInfo.sampleRate * m_trackInfo.channels;
-        int64_t targetBit = static_cast<int64_t>(seconds * bitsPerSecond);
-        int64_t targetByte = targetBit / 8;
-        
-        std::cout << "[AudioDecoder]   Target: " << targetByte << " bytes (" << targetBit << " bits)" << std::endl;
-        std::cout << "[AudioDecoder]   Format: " << m_trackInfo.sampleRate << " Hz, " 
-                  << m_trackInfo.channels << " channels" << std::endl;
-        
-        // Seek in file using byte position
-        AVIOContext* avio = m_formatContext->pb;
-        if (avio) {
-            // Use SEEK_SET to position from start of file
-            int64_t result = avio_seek(avio, targetByte, SEEK_SET);
-            if (result >= 0) {
-                std::cout << "[AudioDecoder]   ✓ File repositioned to byte " << result << std::endl;
-            } else {
-                std::cerr << "[AudioDecoder]   ⚠️  avio_seek failed, code: " << result << std::endl;
-                // Continue anyway - may still work approximately
-            }
-        } else {
-            std::cerr << "[AudioDecoder]   ⚠️  No AVIOContext available for file seek" << std::endl;
+        if (!m_dsdReader) {
+            std::cerr << "[AudioDecoder] DSD seek needs the native DSF/DFF reader" << std::endl;
+            return false;
         }
         
-        // Flush codec buffers to clear old data
-        if (m_codecContext) {
-            avcodec_flush_buffers(m_codecContext);
-            std::cout << "[AudioDecoder]   ✓ Codec buffers flushed" << std::endl;
+        std::cout << "[AudioDecoder] DSD seek to " << seconds << "s" << std::endl;
+        if (!m_dsdReader->seek(seconds)) {
+            return false;
         }
         
-        // Reset internal buffers
         m_remainingCount = 0;
         m_eof = false;
-        
-        std::cout << "[AudioDecoder]   ✓ DSD seek completed" << std::endl;
         return true;
     }
     
@@ -1614,30 +3173,54 @@ bool AudioDecoder::seek(double seconds) {
         stream->time_base
     );
     
+    // ⭐ Index cache: straight to the byte offset of the second before
+    m_skipSamples = 0;
+    bool indexed = seekIndexed(timestamp);
+    
     // Effectuer le seek
     // AVSEEK_FLAG_BACKWARD : cherche le keyframe le plus proche AVANT la position
-    int ret = av_seek_frame(m_formatContext, m_audioStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, sizeof(errbuf));
-        std::cerr << "[AudioDecoder] Seek failed: " << errbuf << std::endl;
-        return false;
+    if (!indexed) {
+        int ret = av_seek_frame(m_formatContext, m_audioStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            std::cerr << "[AudioDecoder] Seek failed: " << errbuf << std::endl;
+            return false;
+        }
     }
     
     // Vider les buffers du codec
     if (m_codecContext) {
         avcodec_flush_buffers(m_codecContext);
     }
+    m_draining = false;
+    m_resumePos = -1;
+    m_resumePts = AV_NOPTS_VALUE;
     
     // Réinitialiser les buffers internes
     m_remainingCount = 0;
     m_eof = false;
     
-    std::cout << "[AudioDecoder] ✓ Seek successful to ~" << seconds << "s" << std::endl;
+    // Resampler history belongs to the old position (re-created on the next read)
+    if (m_swrContext) {
+        swr_free(&m_swrContext);
+    }
+    m_swrFlushed = false;
+    
+    std::cout << "[AudioDecoder] ✓ Seek successful to ~" << seconds << "s"
+              << (indexed ? " (index)" : "") << std::endl;
     
     return true;
 }
 
+bool AudioDecoder::getInputStats(PrefetchIO::Stats& stats) const {
+    if (!m_prefetch) {
+        return false;
+    }
+    stats = m_prefetch->getStats();
+    return true;
+}
+
 
 // ============================================================================
 // AudioEngine::seek() - Seek avec mise à jour de la position
@@ -1722,6 +3305,12 @@ bool AudioEngine::seek(const std::string& timeStr) {
     return seek(totalSeconds);
  }
 
+bool AudioEngine::canSeek() const {
+    // Memory play / ConvertAhead seek through the decoder outside their buffer
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_currentDecoder && m_currentDecoder->canSeek();
+}
+
 uint32_t AudioEngine::getCurrentSampleRate() const {
     return m_currentTrackInfo.sampleRate;
 }
@@ -1749,6 +3338,9 @@ void AudioEngine::prepareNextTrackForGapless() {
         if (!m_nextDecoder) {
             DEBUG_LOG("[AudioEngine] Opening next track decoder...");
             m_nextDecoder = std::make_unique<AudioDecoder>();
+            m_nextDecoder->setPrefetchSize(m_prefetchSize);
+            m_nextDecoder->setDecodeThreads(m_decodeThreads);
+            m_nextDecoder->setHints(DidlHints::parse(m_nextMetadata, m_nextURI));
             
             if (!m_nextDecoder->open(m_nextURI)) {
                 std::cerr << "[AudioEngine] ❌ Failed to open next track for gapless" << std::endl;
@@ -1756,6 +3348,9 @@ void AudioEngine::prepareNextTrackForGapless() {
                 return;
             }
             DEBUG_LOG("[AudioEngine] ✓ Next track decoder opened");
+        } else if (m_nextMemory) {
+            DEBUG_LOG("[AudioEngine] Next track is decoding into memory, nothing to prepare");
+            return;
         } else {
             DEBUG_LOG("[AudioEngine] ♻️  Reusing pre-loaded next track decoder");
         }
@@ -1802,6 +3397,7 @@ void AudioEngine::prepareNextTrackForGapless() {
     } catch (const std::exception& e) {
         std::cerr << "[AudioEngine] ❌ Exception preparing next track: " 
                   << e.what() << std::endl;
+        m_nextMemory.reset();
         m_nextDecoder.reset();  // Cleanup on exception
     }
 }
@@ -9,6 +9,18 @@
 #include <condition_variable>
 #include <functional>
 #include <thread>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "PrefetchIO.h"
+#include "MappedFileIO.h"
+#include "DidlHints.h"
+#include "PcmKernels.h"
+#include "DsdReader.h"
+#include "DsdKernels.h"
+#include "StreamIndexCache.h"
+#include "PcmCache.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -96,10 +108,36 @@ public:
     void close();
     
     /**
-     * @brief Get track information
+     * @brief Get track information, in the format to ask readSamples() for
+     * 
+     * The source format, except with a fixed output format where PCM
+     * reports the output rate and bit depth (duration in output samples).
+     * 
      * @return Track info
      */
-    const TrackInfo& getTrackInfo() const { return m_trackInfo; }
+    const TrackInfo& getTrackInfo() const { return m_outputInfo; }
+    
+    /**
+     * @brief Format of the source itself
+     */
+    const TrackInfo& getSourceInfo() const { return m_trackInfo; }
+    
+    /**
+     * @brief True if readSamples() converts the sample rate of this track
+     */
+    bool resamples() const { return !m_trackInfo.isDSD && m_outputInfo.sampleRate != m_trackInfo.sampleRate; }
+    
+    /**
+     * @brief Audio held in the resampler filter (latency), in milliseconds
+     */
+    double resamplerDelayMs() const;
+    
+    /**
+     * @brief Convert all PCM to one format (soxr resampling), DSD untouched
+     * @param rate Output sample rate, 0 = each track in its own format
+     * @param bits Output bit depth (16, 24 or 32)
+     */
+    static void setFixedOutput(uint32_t rate, uint32_t bits);
     
     /**
      * @brief Read and decode audio samples
@@ -125,17 +163,50 @@ public:
      */
     bool seek(double seconds);
     
+    /**
+     * @brief seek() can work: raw DSD needs the native DSF/DFF reader
+     */
+    bool canSeek() const { return !m_rawDSD || m_dsdReader; }
+    
+    /**
+     * @brief Read-ahead statistics of the network source
+     * @return false if the input is not read through PrefetchIO
+     */
+    bool getInputStats(PrefetchIO::Stats& stats) const;
+    
+    /**
+     * @brief Set the read-ahead ring size for network sources (call before open)
+     * @param bytes Ring size in bytes, PrefetchIO::WHOLE_TRACK, or 0 to disable
+     */
+    void setPrefetchSize(int64_t bytes) { m_prefetchSize = bytes; }
+    
+    /**
+     * @brief Set format hints from the track's DIDL-Lite (call before open)
+     */
+    void setHints(const DidlHints& hints) { m_hints = hints; }
+    
+    /**
+     * @brief Set the decoder worker count (call before open)
+     * @param threads 1 = decode on the calling thread; more = frame-parallel
+     *        decoding for codecs that support it (FLAC, ALAC, ...)
+     */
+    void setDecodeThreads(int threads) { m_decodeThreads = std::max(threads, 1); }
+    
 private:
     AVFormatContext* m_formatContext;
     AVCodecContext* m_codecContext;
     SwrContext* m_swrContext;
     int m_audioStreamIndex;
     TrackInfo m_trackInfo;
+    TrackInfo m_outputInfo;          // getTrackInfo(): m_trackInfo in the output format
     bool m_eof;
+    bool m_swrFlushed = false;       // Resampler tail drained at the end of the stream
     
     // ⭐ DSD Native Mode
     bool m_rawDSD;           // True if reading raw DSD packets (no decoding)
     AVPacket* m_packet;      // For raw packet reading
+    std::unique_ptr<DsdReader> m_dsdReader;  // ⭐ Native DSF/DFF reader (FFmpeg packets if null)
+    AudioBuffer m_dsdScratch;                // ⭐ One raw DSD packet in sink layout
     
     // CRITICAL: Buffer interne pour les samples excédentaires
     // Quand une frame décodée contient plus de samples que demandé,
@@ -154,6 +225,76 @@ private:
     bool m_resamplingLogged = false;
     bool m_resamplerInitLogged = false;
     
+    // ⭐ Network read-ahead
+    int64_t m_prefetchSize = PrefetchIO::DEFAULT_SIZE;
+    std::unique_ptr<PrefetchIO> m_prefetch;
+    
+    // ⭐ Local files: mapped input (the native DSD reader takes spans of it)
+    std::unique_ptr<MappedFileIO> m_mapped;
+    
+    // ⭐ Container known from DIDL-Lite: probe just the header
+    static constexpr int64_t HINTED_PROBESIZE = 64 * 1024;
+    static constexpr int64_t HINTED_ANALYZE_DURATION = 100000;   // 0.1s (AV_TIME_BASE units)
+    DidlHints m_hints;
+    
+    // ⭐ WAV/AIFF passthrough: raw packets through PcmKernels, no codec/swr
+    bool m_passthrough = false;
+    PcmKernels::Kernel m_pcmKernel = nullptr;
+    size_t m_sourceSampleBytes = 0;   // Bytes per sample in the packets
+    
+    // ⭐ Identity rate: decoded frames through PcmKernels instead of swr
+    PcmKernels::FrameKernel m_frameKernel = nullptr;
+    
+    // ⭐ Frame-parallel decoding
+    int m_decodeThreads = 1;
+    bool m_draining = false;          // Flush packet sent, collecting the frames still in flight
+    
+    // ⭐ Persistent stream parameters + seek index
+    static constexpr int64_t INDEX_MAX_GAP = 2 * AV_TIME_BASE;   // Index point → target, beyond: FFmpeg seek
+    std::string m_url;
+    StreamIndexCache::Entry m_index;
+    bool m_indexing = false;       // Recording seek points for this track
+    bool m_indexDirty = false;     // Entry changed since it was loaded
+    int64_t m_skipSamples = 0;     // Source samples to drop after an indexed seek
+    
+    // ⭐ Direct HTTP input (--prefetch 0, PrefetchIO fallback): reconnect
+    // after a timeout or reset instead of ending the track
+    static constexpr int RESUME_ATTEMPTS = 3;
+    int64_t m_resumePos = -1;                  // Byte after the last packet read
+    int64_t m_resumePts = AV_NOPTS_VALUE;      // End of the last audio packet (stream time base)
+    int m_resumeAttempts = 0;                  // Since the last packet read
+    
+    // ⭐ Decoded-PCM cache: a hit is served from the mapped file, with
+    // no input opened; a miss decoded from the start is recorded
+    std::unique_ptr<PcmCache::Reader> m_pcmHit;
+    uint64_t m_pcmPos = 0;                          // Hit: samples already read
+    std::thread m_revalidateThread;                 // Hit on HTTP: source check (revalidateCached)
+    std::atomic<bool> m_revalidateStop{false};
+    std::unique_ptr<PcmCache::Writer> m_pcmWriter;
+    bool m_pcmRecord = false;                       // Record from the first read (output format known then)
+    
+    enum class Probe { Full, Hinted, Cached };
+    
+    bool openSource(const std::string& url);
+    bool openCached(const std::string& url);
+    void revalidateCached(std::string url, int64_t length, std::string etag);
+    void stopRevalidation();
+    void updateOutputInfo();
+    bool leaveCached();
+    size_t readCached(AudioBuffer& buffer, size_t numSamples);
+    void recordSamples(const AudioBuffer& buffer, size_t samples, uint32_t outputRate, uint32_t outputBits);
+    size_t decodeSamples(AudioBuffer& buffer, size_t numSamples, uint32_t outputRate, uint32_t outputBits);
+    bool openInput(const std::string& url, const AVInputFormat* format, Probe probe,
+                   double& inputMs, double& probeMs);
+    void closeInput();
+    bool hintsMatch() const;
+    bool cacheMatches();
+    void indexPacket(const AVPacket* packet);
+    bool seekIndexed(int64_t timestamp);
+    bool resumeDirect();
+    bool openCodec(const AVCodec* codec, const AVCodecParameters* codecpar, bool& reused);
+    size_t readPassthrough(uint8_t* output, size_t numSamples, size_t bytesPerFrame);
+    size_t dsdPacketToSink(const uint8_t* data, size_t size, uint8_t* out);
     bool initResampler(uint32_t outputRate, uint32_t outputBits);
 };
 
@@ -162,6 +303,37 @@ private:
 // ═══════════════════════════════════════════════════════════════
 struct AudioFormat;
 
+/**
+ * @brief Audible playback position, as of a point in time
+ *
+ * Derived from the sink side: samples handed to the output minus what
+ * the output still holds (SDK buffer plus target latency). Between two
+ * snapshots the position advances in real time, but never by more than
+ * the audio that was already queued when the snapshot was taken.
+ */
+struct PlaybackPosition {
+    double seconds = 0.0;      // Audible position at `timestamp`
+    double queued = 0.0;       // Audio handed to the output but not yet audible
+    std::chrono::steady_clock::time_point timestamp;
+    
+    /**
+     * @brief Interpolated position at `now` (for a running clock)
+     */
+    double at(std::chrono::steady_clock::time_point now) const {
+        double elapsed = std::chrono::duration<double>(now - timestamp).count();
+        return seconds + std::max(0.0, std::min(elapsed, queued));
+    }
+};
+
+/**
+ * @brief Input side of the playing track, as of a point in time
+ */
+struct InputStats {
+    bool prefetch = false;             // Network source read through PrefetchIO
+    PrefetchIO::Stats prefetchStats;   // Valid if prefetch
+    HttpConnectionPool::Stats pool;    // Process-wide keep-alive pool
+};
+
 /**
  * @brief Audio Engine with gapless playback support
  * 
@@ -223,6 +395,36 @@ public:
      */
     using NextTrackCallback = std::function<void(const uint8_t*, size_t, const AudioFormat&)>;
     
+    /**
+     * @brief Callback for completed seek
+     * 
+     * Called from the audio thread after the decoder has moved, before
+     * the first audio from the new position is produced. Lets the output
+     * discard what was buffered from the old position.
+     * 
+     * @param seconds New position in seconds
+     */
+    using SeekCallback = std::function<void(double)>;
+    
+    /**
+     * @brief Callback returning the output delay
+     * 
+     * Called from the audio thread after each buffer is handed over:
+     * seconds of audio sent to the output that are not audible yet.
+     */
+    using OutputDelayCallback = std::function<double()>;
+    
+    /**
+     * @brief Callback announcing the next track's format ahead of time
+     * 
+     * Called from the audio thread as soon as a preloaded next track is
+     * known to differ in format from the current one, so the output can
+     * prepare the reconfiguration before the splice point.
+     * 
+     * @param info Next track info
+     */
+    using FormatAnnounceCallback = std::function<void(const TrackInfo&)>;
+    
     // ═══════════════════════════════════════════════════════════════
     
     /**
@@ -265,6 +467,46 @@ public:
     
     // ═══════════════════════════════════════════════════════════════
     
+    /**
+     * @brief Set seek callback (output flush)
+     * @param callback Callback function
+     */
+    void setSeekCallback(const SeekCallback& callback);
+    
+    /**
+     * @brief Set next-track format announcement callback
+     * @param callback Callback function
+     */
+    void setFormatAnnounceCallback(const FormatAnnounceCallback& callback);
+    
+    /**
+     * @brief Set output delay callback (sink-side position)
+     * @param callback Callback function
+     */
+    void setOutputDelayCallback(const OutputDelayCallback& callback);
+    
+    /**
+     * @brief Set the network read-ahead size for decoders opened from now on
+     * @param bytes Ring size in bytes, PrefetchIO::WHOLE_TRACK, or 0 to disable
+     */
+    void setPrefetchSize(int64_t bytes) { m_prefetchSize = bytes; }
+    
+    /**
+     * @brief Set the decoder worker count for decoders opened from now on
+     */
+    void setDecodeThreads(int threads) { m_decodeThreads = threads; }
+    
+    /**
+     * @brief Memory play: decode whole tracks into page-locked RAM
+     * @param capBytes Buffer cap per track (0 = off); a longer track plays
+     *        the buffered part first, then continues from the decoder
+     * @param nextTrack Also decode the preloaded next track in full
+     */
+    void setMemoryPlay(size_t capBytes, bool nextTrack) {
+        m_memoryPlayBytes = capBytes;
+        m_memoryPlayNext = nextTrack;
+    }
+    
     /**
      * @brief Set current track URI
      * @param uri Track URI
@@ -316,11 +558,24 @@ public:
     const TrackInfo& getCurrentTrackInfo() const { return m_currentTrackInfo; }
     
     /**
-     * @brief Get playback position in seconds
+     * @brief Get the audible playback position in seconds
+     * 
+     * Interpolated from the last sink-side snapshot while playing.
+     * 
      * @return Position in seconds
      */
     double getPosition() const;
     
+    /**
+     * @brief Last sink-side position snapshot, with its timestamp
+     */
+    PlaybackPosition getPlaybackPosition() const;
+    
+    /**
+     * @brief Last input snapshot (read-ahead fill, throughput, recoveries)
+     */
+    InputStats getInputStats() const;
+    
     /**
      * @brief Seek to a specific position (in seconds)
      * @param seconds Position in seconds
@@ -334,6 +589,11 @@ public:
      * @return true if successful, false otherwise
      */
     bool seek(const std::string& timeStr);
+    
+    /**
+     * @brief The current track can be seeked (see AudioDecoder::canSeek())
+     */
+    bool canSeek() const;
  
     /**
      * @brief Get current sample rate
@@ -368,6 +628,23 @@ private:
     TrackChangeCallback m_trackChangeCallback;
     TrackEndCallback m_trackEndCallback;
     NextTrackCallback m_nextTrackCallback;  // ⭐ v1.2.0: Gapless Pro
+    SeekCallback m_seekCallback;
+    FormatAnnounceCallback m_formatAnnounceCallback;
+    OutputDelayCallback m_outputDelayCallback;
+    
+    // ⭐ Network read-ahead size for new decoders (0 = off)
+    std::atomic<int64_t> m_prefetchSize{PrefetchIO::DEFAULT_SIZE};
+    
+    // ⭐ Decoder worker count for new decoders (1 = single-threaded)
+    std::atomic<int> m_decodeThreads{1};
+    
+    // ⭐ Memory play cap per track (0 = off)
+    std::atomic<size_t> m_memoryPlayBytes{0};
+    std::atomic<bool> m_memoryPlayNext{false};
+    
+    // ⭐ Track-start latency (open → first audio delivered)
+    std::chrono::steady_clock::time_point m_trackStartTime;
+    bool m_trackStartPending = false;
     
     // Synchronization
     mutable std::mutex m_mutex;
@@ -377,7 +654,11 @@ private:
     AudioBuffer m_buffer;
     
     // Playback tracking
-    uint64_t m_samplesPlayed;
+    uint64_t m_samplesPlayed;        // Samples handed to the output (this track)
+    mutable std::mutex m_positionMutex;
+    PlaybackPosition m_playbackPosition;
+    InputStats m_inputStats;                        // Under m_positionMutex
+    std::chrono::steady_clock::time_point m_inputStatsTime;
     int m_silenceCount;  // Pour drainage du buffer Diretta
     bool m_isDraining;   // Flag pour éviter de re-logger "Track finished"
     
@@ -385,6 +666,8 @@ private:
     bool m_nextTrackPrepared;  // True if next track already sent to DirettaOutput
     
     // Helper functions
+    void publishPosition(double queued);
+    void publishInputStats();
     bool openCurrentTrack();
     bool preloadNextTrack();
     void transitionToNextTrack();
@@ -398,8 +681,168 @@ private:
 
     // Preload thread management (replaces detached thread)
     std::thread m_preloadThread;
+    std::mutex m_preloadThreadMutex;   // Guards join/create (UPnP and audio threads)
     std::atomic<bool> m_preloadRunning{false};
     void waitForPreloadThread();
+    
+    // ⭐ Background preload, started by setNextURI(): the next track is
+    // opened, probed and its first seconds decoded off the audio thread
+    static constexpr size_t PREBUFFER_SECONDS = 2;
+    
+    struct Prebuffer {
+        std::vector<uint8_t> data;   // Decoded audio, readSamples() layout
+        size_t samples = 0;
+        size_t pos = 0;              // Samples already played out
+    };
+    
+    // ⭐ Memory play: a track decoded into page-locked RAM, in the
+    // readSamples() output format, by a thread of its own. Once it is
+    // decoded the audio thread only copies slices of it; a whole track
+    // also has its decoder closed.
+    class MemoryTrack {
+    public:
+        MemoryTrack(AudioDecoder* decoder, size_t capBytes);
+        ~MemoryTrack();
+        
+        MemoryTrack(const MemoryTrack&) = delete;
+        MemoryTrack& operator=(const MemoryTrack&) = delete;
+        
+        bool valid() const { return m_data != nullptr; }
+        
+        /**
+         * @brief Copy from the play position, waiting if decoding is behind
+         * @return Samples copied, 0 once played out
+         */
+        size_t read(uint8_t* out, size_t samples);
+        
+        /**
+         * @brief Instant inside the buffer; elsewhere the decoder seeks and
+         *        the buffer refills from the new position
+         */
+        bool seek(double seconds);
+        
+        /**
+         * @brief True while reads must come from here: not played out yet,
+         *        or the buffer is the whole track (decoder closed)
+         */
+        bool covers() const;
+        
+        /**
+         * @brief Decoding is over and every decoded sample was read
+         */
+        bool playedOut() const;
+        
+        /**
+         * @brief Decoding reached the end of the track
+         */
+        bool decodedToEnd() const { return m_complete.load(std::memory_order_acquire); }
+        
+    private:
+        void start();
+        void halt();
+        void fill();
+        
+        AudioDecoder* m_decoder;
+        TrackInfo m_info;
+        uint8_t* m_data = nullptr;
+        size_t m_capacity = 0;                 // Bytes mapped
+        size_t m_maxSamples = 0;
+        bool m_locked = false;
+        
+        uint64_t m_startSample = 0;            // Track position of the first buffered sample
+        size_t m_pos = 0;                      // Play position (audio thread)
+        size_t m_samples = 0;                  // Decoded (under m_mutex)
+        bool m_done = false;                   // Fill thread finished (under m_mutex)
+        std::atomic<bool> m_complete{false};
+        std::atomic<bool> m_whole{false};      // From sample 0 to the end: decoder closed
+        std::atomic<bool> m_stop{false};
+        
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::thread m_thread;
+    };
+    
+    // ⭐ Fixed output: a track that needs rate conversion is decoded and
+    // resampled into a short ring by a thread of its own; the audio
+    // thread only copies from it.
+    class ConvertAhead {
+    public:
+        static constexpr double AHEAD_SECONDS = 1.0;
+        static constexpr size_t CHUNK_SAMPLES = 4096;
+        
+        explicit ConvertAhead(AudioDecoder* decoder);
+        ~ConvertAhead();
+        
+        ConvertAhead(const ConvertAhead&) = delete;
+        ConvertAhead& operator=(const ConvertAhead&) = delete;
+        
+        /**
+         * @brief Copy from the ring, waiting if conversion is behind
+         * @return Samples copied, 0 once the track is played out
+         */
+        size_t read(uint8_t* out, size_t samples);
+        
+        /**
+         * @brief Seek the decoder and refill from the new position
+         */
+        bool seek(double seconds);
+        
+        /**
+         * @brief The fill thread finished (end of track, or halted for a seek)
+         */
+        bool done() const { return m_done.load(std::memory_order_acquire); }
+        
+        /**
+         * @brief Conversion is over and every converted sample was read
+         */
+        bool playedOut() const;
+        
+    private:
+        void start();
+        void halt();
+        void fill();
+        
+        AudioDecoder* m_decoder;   // Decoder state (EOF) belongs to the fill thread
+        TrackInfo m_info;
+        std::vector<uint8_t> m_ring;
+        size_t m_capacity = 0;                 // Samples
+        uint64_t m_written = 0;                // Converted (under m_mutex)
+        uint64_t m_read = 0;                   // Played (under m_mutex)
+        std::atomic<bool> m_done{false};       // Fill thread finished (set under m_mutex)
+        std::atomic<bool> m_stop{false};
+        
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::thread m_thread;
+    };
+    
+    struct PreloadedTrack {
+        std::string uri;
+        std::unique_ptr<AudioDecoder> decoder;
+        Prebuffer prebuffer;
+        std::unique_ptr<MemoryTrack> memory;   // After decoder: destroyed first
+    };
+    
+    std::mutex m_preloadMutex;
+    PreloadedTrack m_preloaded;              // Filled by the preload thread
+    std::atomic<bool> m_preloadReady{false};
+    
+    // Audio thread only (under m_mutex). MemoryTrack and ConvertAhead
+    // read their decoder from a thread of their own: they are declared
+    // after the decoders, so they are destroyed (threads joined) first.
+    Prebuffer m_nextPrebuffer;               // Goes with m_nextDecoder
+    Prebuffer m_prebuffer;                   // Being played out before the decoder
+    std::unique_ptr<MemoryTrack> m_memory;       // Goes with m_currentDecoder
+    std::unique_ptr<MemoryTrack> m_nextMemory;   // Goes with m_nextDecoder
+    std::unique_ptr<ConvertAhead> m_ahead;       // Goes with m_currentDecoder
+    bool m_nextFormatChanges = false;        // m_nextDecoder needs an output reconfiguration
+    
+    void startPreload(const std::string& uri, const std::string& metadata);
+    void adoptPreloaded();
+    void clearPreloaded();
+    static size_t bytesForSamples(const TrackInfo& info, size_t samples);
+    static size_t samplesForBytes(const TrackInfo& info, size_t bytes);
+    std::unique_ptr<MemoryTrack> startMemoryTrack(AudioDecoder* decoder);
 
     // ⭐⭐⭐ NEW: Async seek mechanism to avoid deadlock
     // The UPnP thread sets these flags, the audio thread processes the seek
@@ -0,0 +1,181 @@
+#include "CycleTuneCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+
+constexpr char MAGIC[4] = {'D', 'R', 'C', 'T'};
+constexpr uint32_t MAX_KEY = 4096;
+
+std::mutex s_mutex;
+std::string s_directory;
+std::map<std::string, CycleTuneStats> s_memory;
+
+uint64_t fnv1a(const std::string& s) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool makeDirectories(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (::mkdir(prefix.c_str(), 0755) < 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+// Native-endian binary fields: the cache never leaves the machine
+template <typename T>
+void put(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool get(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+void CycleTuneCache::setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_directory.clear();
+
+    if (directory.empty()) {
+        return;
+    }
+
+    if (!makeDirectories(directory) || ::access(directory.c_str(), W_OK) != 0) {
+        std::cerr << "[CycleTuneCache] ⚠️  Cannot use " << directory << ": " << std::strerror(errno)
+                  << ", tuned cycle times kept until restart only" << std::endl;
+        return;
+    }
+
+    s_directory = directory;
+    DEBUG_LOG("[CycleTuneCache] Using " << s_directory);
+}
+
+std::string CycleTuneCache::pathFor(const std::string& key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.tune", static_cast<unsigned long long>(fnv1a(key)));
+    return s_directory + "/" + name;
+}
+
+bool CycleTuneCache::load(const std::string& key, CycleTuneStats& stats) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto it = s_memory.find(key);
+        if (it != s_memory.end()) {
+            stats = it->second;
+            return true;
+        }
+        if (s_directory.empty()) {
+            return false;
+        }
+        path = pathFor(key);
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t keySize = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !get(in, version) || version != FORMAT_VERSION || !get(in, keySize) || keySize > MAX_KEY) {
+        return false;
+    }
+
+    // Hash collision
+    std::string storedKey(keySize, '\0');
+    if (keySize > 0 && !in.read(&storedKey[0], keySize)) {
+        return false;
+    }
+    if (storedKey != key) {
+        return false;
+    }
+
+    CycleTuneStats loaded;
+    bool ok = get(in, loaded.cycleTime) && get(in, loaded.calculatedCycle) &&
+              get(in, loaded.utilization) && get(in, loaded.lateCycles) && get(in, loaded.windows);
+    if (!ok || loaded.cycleTime == 0) {
+        std::cerr << "[CycleTuneCache] ⚠️  Corrupt entry " << path << ", ignored" << std::endl;
+        return false;
+    }
+    loaded.converged = true;
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_memory[key] = loaded;
+    }
+    stats = loaded;
+    return true;
+}
+
+void CycleTuneCache::store(const std::string& key, const CycleTuneStats& stats) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_memory[key] = stats;
+        if (s_directory.empty()) {
+            return;
+        }
+        path = pathFor(key);
+    }
+    std::string temp = path + ".tmp" + std::to_string(::getpid());
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            DEBUG_LOG("[CycleTuneCache] Cannot write " << temp);
+            return;
+        }
+
+        out.write(MAGIC, sizeof(MAGIC));
+        put(out, FORMAT_VERSION);
+        put(out, static_cast<uint32_t>(key.size()));
+        out.write(key.data(), static_cast<std::streamsize>(key.size()));
+        put(out, stats.cycleTime);
+        put(out, stats.calculatedCycle);
+        put(out, stats.utilization);
+        put(out, stats.lateCycles);
+        put(out, stats.windows);
+
+        if (!out) {
+            out.close();
+            std::remove(temp.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return;
+    }
+
+    DEBUG_LOG("[CycleTuneCache] 💾 Stored " << stats.cycleTime << " µs for " << key);
+}
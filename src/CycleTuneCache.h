@@ -0,0 +1,53 @@
+#ifndef CYCLE_TUNE_CACHE_H
+#define CYCLE_TUNE_CACHE_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Cycle time tuning metrics (per format + target)
+ */
+struct CycleTuneStats {
+    unsigned int cycleTime = 0;       // Current / converged cycle time (µs)
+    unsigned int calculatedCycle = 0; // Starting point from DirettaCycleCalculator (µs)
+    double utilization = 0.0;         // Payload per packet / efficient MTU
+    uint64_t lateCycles = 0;          // SDK buffer ran empty (sink starved)
+    int windows = 0;                  // Observation windows evaluated
+    bool converged = false;
+    bool remembered = false;          // Result reused from a previous session
+};
+
+/**
+ * @brief Converged cycle times, kept across restarts
+ *
+ * Keyed by target address and format (see DirettaOutput). Every result
+ * is kept in memory for the lifetime of the process and, when a
+ * directory is set, written there as one small file per key, so a DAC
+ * is not tuned again from scratch after the daemon restarts.
+ */
+class CycleTuneCache {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr const char* DEFAULT_DIRECTORY = "/var/cache/diretta-renderer/cycle";
+
+    /**
+     * @brief Set the cache directory (created if missing); empty keeps results in memory only
+     */
+    static void setDirectory(const std::string& directory);
+
+    /**
+     * @brief Converged result for key, from memory or disk
+     * @return true if found (stats.remembered is not set here)
+     */
+    static bool load(const std::string& key, CycleTuneStats& stats);
+
+    /**
+     * @brief Remember a converged result (atomic replace on disk)
+     */
+    static void store(const std::string& key, const CycleTuneStats& stats);
+
+private:
+    static std::string pathFor(const std::string& key);
+};
+
+#endif // CYCLE_TUNE_CACHE_H
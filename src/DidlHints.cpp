@@ -0,0 +1,183 @@
+#include "DidlHints.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+std::string unescapeXml(const std::string& s) {
+    static const struct { const char* entity; char c; } entities[] = {
+        {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}, {"&amp;", '&'}
+    };
+
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        bool replaced = false;
+        if (s[i] == '&') {
+            for (const auto& e : entities) {
+                size_t len = std::strlen(e.entity);
+                if (s.compare(i, len, e.entity) == 0) {
+                    out += e.c;
+                    i += len - 1;
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+        if (!replaced) {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+/**
+ * Value of name="..." (or name='...') inside a start tag
+ */
+std::string attribute(const std::string& tag, const std::string& name) {
+    size_t pos = 0;
+    while ((pos = tag.find(name, pos)) != std::string::npos) {
+        // Whole attribute name only: preceded by whitespace, followed by '='
+        bool startOk = (pos > 0 && std::isspace(static_cast<unsigned char>(tag[pos - 1])));
+        size_t eq = pos + name.size();
+        while (eq < tag.size() && std::isspace(static_cast<unsigned char>(tag[eq]))) {
+            eq++;
+        }
+        if (startOk && eq < tag.size() && tag[eq] == '=') {
+            size_t quote = eq + 1;
+            while (quote < tag.size() && std::isspace(static_cast<unsigned char>(tag[quote]))) {
+                quote++;
+            }
+            if (quote < tag.size() && (tag[quote] == '"' || tag[quote] == '\'')) {
+                size_t end = tag.find(tag[quote], quote + 1);
+                if (end != std::string::npos) {
+                    return unescapeXml(tag.substr(quote + 1, end - quote - 1));
+                }
+            }
+        }
+        pos += name.size();
+    }
+    return "";
+}
+
+/**
+ * "H:MM:SS", "H:MM:SS.fff" or "H:MM:SS.F0/F1"
+ */
+double parseDuration(const std::string& s) {
+    int h = 0, m = 0;
+    double sec = 0.0;
+    size_t c1 = s.find(':');
+    size_t c2 = (c1 == std::string::npos) ? std::string::npos : s.find(':', c1 + 1);
+    if (c2 == std::string::npos) {
+        return 0.0;
+    }
+    h = std::atoi(s.substr(0, c1).c_str());
+    m = std::atoi(s.substr(c1 + 1, c2 - c1 - 1).c_str());
+    sec = std::atof(s.substr(c2 + 1).c_str());
+    return h * 3600.0 + m * 60.0 + sec;
+}
+
+} // namespace
+
+DidlHints DidlHints::parse(const std::string& didlIn, const std::string& uri) {
+    DidlHints hints;
+
+    // Some control points send the metadata escaped once more
+    std::string didl = didlIn;
+    if (didl.find("<res") == std::string::npos && didl.find("&lt;res") != std::string::npos) {
+        didl = unescapeXml(didl);
+    }
+
+    std::string chosenTag;
+    size_t pos = 0;
+    while ((pos = didl.find("<res", pos)) != std::string::npos) {
+        size_t tagEnd = didl.find('>', pos);
+        if (tagEnd == std::string::npos) {
+            break;
+        }
+        // "<res" must be the element name, not a prefix ("<resource")
+        char next = didl[pos + 4];
+        if (next != ' ' && next != '>' && next != '\t' && next != '\n' && next != '\r') {
+            pos += 4;
+            continue;
+        }
+
+        std::string tag = didl.substr(pos, tagEnd - pos);
+        size_t contentEnd = didl.find("</res>", tagEnd);
+        std::string content = (contentEnd == std::string::npos) ? ""
+            : unescapeXml(didl.substr(tagEnd + 1, contentEnd - tagEnd - 1));
+
+        size_t b = content.find_first_not_of(" \t\r\n");
+        size_t e = content.find_last_not_of(" \t\r\n");
+        content = (b == std::string::npos) ? "" : content.substr(b, e - b + 1);
+
+        if (chosenTag.empty()) {
+            chosenTag = tag;
+        }
+        if (!uri.empty() && content == uri) {
+            chosenTag = tag;
+            break;
+        }
+        pos = tagEnd;
+    }
+
+    if (chosenTag.empty()) {
+        return hints;
+    }
+
+    // protocolInfo = "http-get:*:audio/flac:DLNA.ORG_..."
+    std::string protocolInfo = attribute(chosenTag, "protocolInfo");
+    size_t f1 = protocolInfo.find(':');
+    size_t f2 = (f1 == std::string::npos) ? std::string::npos : protocolInfo.find(':', f1 + 1);
+    if (f2 != std::string::npos) {
+        size_t f3 = protocolInfo.find(':', f2 + 1);
+        std::string mime = protocolInfo.substr(f2 + 1, f3 == std::string::npos ? std::string::npos : f3 - f2 - 1);
+        std::transform(mime.begin(), mime.end(), mime.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        // Drop MIME parameters ("audio/L16;rate=44100")
+        hints.mimeType = mime.substr(0, mime.find(';'));
+    }
+
+    hints.sampleRate = static_cast<uint32_t>(std::strtoul(attribute(chosenTag, "sampleFrequency").c_str(), nullptr, 10));
+    hints.bitsPerSample = static_cast<uint32_t>(std::strtoul(attribute(chosenTag, "bitsPerSample").c_str(), nullptr, 10));
+    hints.channels = static_cast<uint32_t>(std::strtoul(attribute(chosenTag, "nrAudioChannels").c_str(), nullptr, 10));
+    hints.durationSeconds = parseDuration(attribute(chosenTag, "duration"));
+
+    std::string size = attribute(chosenTag, "size");
+    if (!size.empty()) {
+        hints.size = std::strtoll(size.c_str(), nullptr, 10);
+    }
+
+    return hints;
+}
+
+const char* DidlHints::demuxer() const {
+    static const struct { const char* mime; const char* demuxer; } table[] = {
+        {"audio/flac", "flac"},
+        {"audio/x-flac", "flac"},
+        {"audio/wav", "wav"},
+        {"audio/wave", "wav"},
+        {"audio/x-wav", "wav"},
+        {"audio/aiff", "aiff"},
+        {"audio/x-aiff", "aiff"},
+        {"audio/dsf", "dsf"},
+        {"audio/x-dsf", "dsf"},
+        {"audio/dff", "iff"},
+        {"audio/x-dff", "iff"},
+        {"audio/mpeg", "mp3"},
+        {"audio/mp4", "mov"},
+        {"audio/x-m4a", "mov"},
+        {"audio/m4a", "mov"},
+        {"audio/ogg", "ogg"},
+    };
+
+    for (const auto& entry : table) {
+        if (mimeType == entry.mime) {
+            return entry.demuxer;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,41 @@
+#ifndef DIDL_HINTS_H
+#define DIDL_HINTS_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Stream hints from DIDL-Lite track metadata
+ *
+ * Control points send the track's <res> element with SetAVTransportURI:
+ * protocolInfo (MIME type), sampleFrequency, bitsPerSample,
+ * nrAudioChannels, duration and size. Knowing the container up front
+ * lets the decoder force the demuxer and cap probing instead of
+ * downloading megabytes to guess what the server already told us.
+ */
+struct DidlHints {
+    std::string mimeType;        // From protocolInfo, e.g. "audio/flac"
+    uint32_t sampleRate = 0;     // sampleFrequency (0 = not given)
+    uint32_t bitsPerSample = 0;
+    uint32_t channels = 0;
+    double durationSeconds = 0.0;
+    int64_t size = -1;
+
+    /**
+     * @brief Parse the <res> matching uri (or the first one) from DIDL-Lite
+     * @param didl DIDL-Lite metadata (plain or XML-escaped)
+     * @param uri Track URI, used to pick the right <res>
+     * @return Hints (empty if nothing usable)
+     */
+    static DidlHints parse(const std::string& didl, const std::string& uri);
+
+    /**
+     * @brief FFmpeg demuxer name for the MIME type
+     * @return Short name for av_find_input_format(), nullptr if unknown
+     */
+    const char* demuxer() const;
+
+    bool empty() const { return mimeType.empty() && sampleRate == 0; }
+};
+
+#endif // DIDL_HINTS_H
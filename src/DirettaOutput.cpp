@@ -4,11 +4,13 @@
  */
 
 #include "DirettaOutput.h"
+#include "PathMtuProbe.h"
 #include <iostream>
 #include <cstring>
 #include <thread>
 #include <chrono>
 #include <iomanip> 
+#include <sstream>
 // ════════════════════════════════════════════════════════════════
 // ⭐ v1.2.0 : Bit reversal lookup table for DSD MSB<->LSB conversion
 // ════════════════════════════════════════════════════════════════
@@ -67,14 +69,56 @@ void DirettaOutput::setMTU(uint32_t mtu) {
     }
     
     m_mtu = mtu;
+    m_mtuOverride = mtu;
     
-    DEBUG_LOG("[DirettaOutput] ✓ MTU configured: " << m_mtu << " bytes");
+    DEBUG_LOG("[DirettaOutput] ✓ MTU configured: " << m_mtu << " bytes"
+              << (mtu > 1500 ? " (jumbo frames)" : ""));
+}
+
+void DirettaOutput::setMTUCeiling(uint32_t ceiling) {
+    m_mtuCeiling = (ceiling > 0) ? ceiling : PathMtuProbe::DEFAULT_CEILING;
+    DEBUG_LOG("[DirettaOutput] ✓ MTU probe ceiling: " << m_mtuCeiling << " bytes");
+}
+
+uint32_t DirettaOutput::measureTargetMTU(DIRETTA::Find& find, const ACQUA::IPAddress& address) {
+    // User override wins, no probing
+    if (m_mtuOverride > 0) {
+        return m_mtuOverride;
+    }
     
-    if (mtu > 1500) {
-        std::cout << " (jumbo frames)";
+    std::string key = address.get_str();
+    uint32_t mtu = 0;
+    if (PathMtuProbe::getCached(key, mtu)) {
+        return std::min(mtu, m_mtuCeiling);
     }
     
-    std::cout << std::endl;
+    // Only sizes the far end acknowledged count: the SDK measurement is an
+    // exchange with the target, echo probes must come back. A DF send on
+    // its own never sees a switch that silently drops jumbo frames.
+    uint32_t sdkMTU = 0;
+    bool sdkOk = find.measSendMTU(address, sdkMTU) && sdkMTU > 0;
+    uint32_t ceiling = sdkOk ? std::min(sdkMTU, m_mtuCeiling) : m_mtuCeiling;
+    uint32_t route = PathMtuProbe::routeMTU(key);
+    if (route > 0) {
+        ceiling = std::min(ceiling, route);
+    }
+    
+    PathMtuProbe::Result path;
+    if (m_mtuEchoPort > 0) {
+        path = PathMtuProbe::discover(key, PathMtuProbe::makeEchoProbe(key, m_mtuEchoPort), ceiling);
+    }
+    if (path.ok) {
+        mtu = path.mtu;
+    } else if (sdkOk) {
+        mtu = ceiling;
+        PathMtuProbe::setCached(key, mtu);
+    }
+    
+    DEBUG_LOG("[DirettaOutput] 📊 MTU probe: SDK " << (sdkOk ? std::to_string(sdkMTU) : "n/a")
+              << ", echo " << (path.ok ? std::to_string(path.mtu) : "n/a")
+              << " → " << mtu << " bytes");
+    
+    return mtu;
 }
 void DirettaOutput::setTransferMode(TransferMode mode) {
     if (m_connected) {
@@ -98,6 +142,7 @@ bool DirettaOutput::open(const AudioFormat& format, int bufferSeconds) {
               << format.channels << "ch");
     
     m_currentFormat = format;
+    m_requestedBufferSeconds = bufferSeconds;
     m_totalSamplesSent = 0;
     DEBUG_LOG("[DirettaOutput] ⭐ m_totalSamplesSent RESET to 0");
     
@@ -146,10 +191,7 @@ bool DirettaOutput::open(const AudioFormat& format, int bufferSeconds) {
         return false;
     }
     
-    DEBUG_LOG("[DirettaOutput] ✓ Diretta configured");
-    
-    // Network optimization
-    optimizeNetworkConfig(format);
+    DEBUG_LOG("[DirettaOutput] ✓ Diretta configured (network optimized)");
     
     std::cout << "[DirettaOutput] ✅ Connection established" << std::endl;
     std::cout << "[DirettaOutput]    Format: ";
@@ -167,6 +209,12 @@ bool DirettaOutput::open(const AudioFormat& format, int bufferSeconds) {
 }
 
 void DirettaOutput::close() {
+    // A format change in progress is abandoned
+    cancelFormatChange();
+    closeConnection();
+}
+
+void DirettaOutput::closeConnection() {
     // ⭐ v1.2.0 Stable: Protection contre double close
     if (!m_connected) {
         DEBUG_LOG("[DirettaOutput] Already closed, skipping");
@@ -178,7 +226,13 @@ void DirettaOutput::close() {
     // Marquer comme déconnecté IMMÉDIATEMENT pour éviter ré-entrée
     m_connected = false;
     m_playing = false;
+    m_holding = false;
+    m_lingering = false;
+    m_flushPending = false;
+    m_flushMeasuring = false;
     
+    // Readers on other threads hold the stream mutex (format change: worker thread)
+    std::unique_lock<std::mutex> streamLock(m_streamMutex);
     if (m_syncBuffer) {
         DEBUG_LOG("[DirettaOutput] 1. Disconnecting SyncBuffer...");
         
@@ -192,11 +246,14 @@ void DirettaOutput::close() {
         DEBUG_LOG("[DirettaOutput] 2. Releasing SyncBuffer...");
         m_syncBuffer.reset();
     }
+    streamLock.unlock();
     
     DEBUG_LOG("[DirettaOutput] 3. Resetting UDP sockets...");
     m_udp.reset();
     m_raw.reset();
     
+    releaseMarkers(true);
+    
     DEBUG_LOG("[DirettaOutput] ✓ Connection closed");
 }
 
@@ -226,6 +283,8 @@ bool DirettaOutput::play() {
 }
 
 void DirettaOutput::stop(bool immediate) {
+    cancelFormatChange();
+    
     if (!m_playing) {
         DEBUG_LOG("[DirettaOutput] ⚠️  stop() called but not playing");
         return;
@@ -278,15 +337,21 @@ void DirettaOutput::stop(bool immediate) {
     
     m_playing = false;
     m_isPaused = false;      // Reset état pause
+    m_holding = false;
+    m_lingering = false;
     m_pausedPosition = 0;    // Reset position sauvegardée
     m_totalSamplesSent = 0;
     
+    releaseMarkers(true);
+    
     std::cout << "[DirettaOutput] ✓ Stopped" << std::endl;
 }
 
-void DirettaOutput::pause() {
+double DirettaOutput::pause(bool hold) {
+    finishFormatChange();
+    
     if (!m_playing || m_isPaused) {
-        return;
+        return 0.0;
     }
     
     DEBUG_LOG("[DirettaOutput] ⏸️  Pausing...");
@@ -294,6 +359,27 @@ void DirettaOutput::pause() {
     // Sauvegarder la position actuelle
     m_pausedPosition = m_totalSamplesSent;
     
+    // ⭐ Hold the session with silence instead of stopping the SDK
+    // (DSD: sampleRate is the bit rate, silence is the 0x69 idle pattern)
+    if (hold && m_syncBuffer && m_currentFormat.sampleRate > 0) {
+        int64_t discarded;
+        {
+            std::lock_guard<std::mutex> lock(m_streamMutex);
+            discarded = discardBuffered();
+            m_flushPending = false;
+            m_flushMeasuring = false;
+        }
+        releaseMarkers(true);
+        
+        m_holding = true;
+        m_isPaused = true;
+        
+        double discardedSeconds = static_cast<double>(discarded) / m_currentFormat.sampleRate;
+        DEBUG_LOG("[DirettaOutput] ✓ Paused, session held with silence ("
+                  << static_cast<int>(discardedSeconds * 1000.0) << " ms discarded)");
+        return discardedSeconds;
+    }
+    
     // Arrêter la lecture
     if (m_syncBuffer) {
         m_syncBuffer->stop();
@@ -303,6 +389,7 @@ void DirettaOutput::pause() {
     m_playing = false;
     
     DEBUG_LOG("[DirettaOutput] ✓ Paused at sample " << m_pausedPosition);
+    return 0.0;
 }
 
 void DirettaOutput::resume() {
@@ -312,6 +399,14 @@ void DirettaOutput::resume() {
     
     DEBUG_LOG("[DirettaOutput] ▶️  Resuming...");
     
+    // Session was held with silence: audio simply takes over again
+    if (m_holding) {
+        m_holding = false;
+        m_isPaused = false;
+        DEBUG_LOG("[DirettaOutput] ✓ Resumed (session held)");
+        return;
+    }
+    
     if (m_syncBuffer) {
         // DSD: Just play
         // PCM: Seek then play
@@ -342,6 +437,13 @@ bool DirettaOutput::changeFormat(const AudioFormat& newFormat) {
     }
     
     std::cout << "[DirettaOutput] ⚠️  Format change - COMPLETE CLOSE/REOPEN REQUIRED" << std::endl;
+    
+    if (m_formatAnnounced && m_announcedFormat == newFormat) {
+        auto ahead = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - m_announceTime).count();
+        std::cout << "[DirettaOutput]    (announced " << ahead << "ms ahead, next track already decoded)" << std::endl;
+    }
+    m_formatAnnounced = false;
     std::cout << "[DirettaOutput]    (DAC hardware needs time to reinitialize)" << std::endl;
     
     bool wasPlaying = m_playing;
@@ -361,7 +463,7 @@ bool DirettaOutput::changeFormat(const AudioFormat& newFormat) {
     
     // ⭐ STEP 3: REOPEN WITH NEW FORMAT
     std::cout << "[DirettaOutput] 3. Reopening with new format..." << std::endl;
-    if (!open(newFormat, m_bufferSeconds)) {
+    if (!open(newFormat, m_requestedBufferSeconds)) {
         std::cerr << "[DirettaOutput] ❌ Failed to reopen with new format" << std::endl;
         return false;
     }
@@ -385,7 +487,153 @@ bool DirettaOutput::changeFormat(const AudioFormat& newFormat) {
     
     return true;
 }
+bool DirettaOutput::beginFormatChange(const AudioFormat& newFormat) {
+    if (!m_connected || !m_playing || !m_syncBuffer || m_reconfiguring) {
+        return false;
+    }
+    if (m_formatThread.joinable()) {
+        m_formatThread.join();
+    }
+    
+    std::cout << "[DirettaOutput] 🔄 Format change at track boundary: "
+              << m_currentFormat.sampleRate << "Hz/" << m_currentFormat.bitDepth << "bit"
+              << " → " << newFormat.sampleRate << "Hz/" << newFormat.bitDepth << "bit"
+              << " (next track staged meanwhile)" << std::endl;
+    m_formatAnnounced = false;
+    
+    {
+        std::lock_guard<std::mutex> stageLock(m_stageMutex);
+        m_staged.clear();
+        m_stagedSamples = 0;
+        m_pendingFormat = newFormat;
+        m_formatCancel = false;
+        m_formatSkipDrain = false;
+        m_formatChangeStart = std::chrono::steady_clock::now();
+        m_reconfiguring = true;
+    }
+    
+    m_formatThread = std::thread(&DirettaOutput::formatChangeThread, this);
+    return true;
+}
+
+bool DirettaOutput::finishFormatChange() {
+    if (m_formatThread.joinable() && std::this_thread::get_id() != m_formatThread.get_id()) {
+        m_formatThread.join();
+    }
+    return m_connected;
+}
+
+void DirettaOutput::cancelFormatChange() {
+    if (!m_formatThread.joinable() || std::this_thread::get_id() == m_formatThread.get_id()) {
+        return;
+    }
+    
+    m_formatCancel = true;
+    m_formatThread.join();
+    // Only the worker's target search may see it: a later open() waits again
+    m_formatCancel = false;
+}
+
+void DirettaOutput::formatChangeThread() {
+    using Clock = std::chrono::steady_clock;
+    
+    // ⭐ STEP 1: the previous track plays out of the SDK buffer (up to the boundary)
+    auto drainLimit = m_formatChangeStart + std::chrono::milliseconds(
+        static_cast<int>(m_bufferSeconds * 1000.0f) + 1000);
+    while (!m_formatCancel && !m_formatSkipDrain && m_syncBuffer &&
+           !m_syncBuffer->buffer_empty() && Clock::now() < drainLimit) {
+        releaseMarkers();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto drained = Clock::now();
+    
+    // ⭐ STEP 2: reconfigure the sink (close, DAC relock, reopen)
+    closeConnection();
+    for (int waited = 0; waited < FORMAT_RELOCK_MS && !m_formatCancel; waited += 10) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    bool ready = false;
+    if (!m_formatCancel) {
+        ready = open(m_pendingFormat, m_requestedBufferSeconds) && play();
+        if (!ready) {
+            std::cerr << "[DirettaOutput] ❌ Failed to reopen with new format" << std::endl;
+        }
+    }
+    
+    // ⭐ STEP 3: the staged next track goes out at once
+    size_t prefilled = 0;
+    {
+        std::lock_guard<std::mutex> streamLock(m_streamMutex);
+        std::lock_guard<std::mutex> stageLock(m_stageMutex);
+        if (ready) {
+            for (const auto& staged : m_staged) {
+                writeAudioLocked(staged.data.data(), staged.samples);
+                prefilled += staged.samples;
+            }
+        }
+        m_staged.clear();
+        m_stagedSamples = 0;
+        m_reconfiguring = false;
+    }
+    m_stageCV.notify_all();
+    
+    if (ready) {
+        auto now = Clock::now();
+        auto drainMs = std::chrono::duration_cast<std::chrono::milliseconds>(drained - m_formatChangeStart).count();
+        auto gapMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - drained).count();
+        double prefillMs = m_currentFormat.sampleRate > 0
+            ? (prefilled * 1000.0) / m_currentFormat.sampleRate : 0.0;
+        std::cout << "[DirettaOutput] ✅ Format changed: " << gapMs << " ms gap after "
+                  << drainMs << " ms play-out, " << static_cast<int>(prefillMs)
+                  << " ms of the next track prefilled" << std::endl;
+    } else if (m_formatCancel) {
+        DEBUG_LOG("[DirettaOutput] Format change cancelled");
+    }
+}
+
+void DirettaOutput::announceFormat(const AudioFormat& format) {
+    m_announcedFormat = format;
+    m_announceTime = std::chrono::steady_clock::now();
+    m_formatAnnounced = true;
+    
+    std::cout << "[DirettaOutput] 📣 Next track format announced: ";
+    if (format.isDSD) {
+        std::cout << "DSD" << (format.sampleRate / 44100);
+    } else {
+        std::cout << format.sampleRate << "Hz/" << format.bitDepth << "bit";
+    }
+    std::cout << "/" << format.channels << "ch" << std::endl;
+}
+
 bool DirettaOutput::sendAudio(const uint8_t* data, size_t numSamples) {
+    // ⭐ Format change in progress: stage the new track until the session is back
+    if (m_reconfiguring) {
+        std::unique_lock<std::mutex> stageLock(m_stageMutex);
+        if (m_reconfiguring) {
+            size_t stageLimit = static_cast<size_t>(m_pendingFormat.sampleRate) *
+                                std::max(1, m_requestedBufferSeconds);
+            if (m_stagedSamples < stageLimit) {
+                size_t bytes;
+                if (m_pendingFormat.isDSD) {
+                    bytes = (numSamples * m_pendingFormat.channels) / 8;
+                } else {
+                    bytes = numSamples * m_pendingFormat.channels *
+                            ((m_pendingFormat.bitDepth == 24) ? 4 : (m_pendingFormat.bitDepth / 8));
+                }
+                StagedAudio staged;
+                staged.data.assign(data, data + bytes);
+                staged.samples = numSamples;
+                m_staged.push_back(std::move(staged));
+                m_stagedSamples += numSamples;
+                return true;
+            }
+            
+            // Staging full: wait for the new session
+            m_stageCV.wait(stageLock, [this] { return !m_reconfiguring.load(); });
+        }
+    }
+    
     if (!m_connected || !m_playing) {
         return false;
     }
@@ -394,6 +642,16 @@ bool DirettaOutput::sendAudio(const uint8_t* data, size_t numSamples) {
         return false;
     }
     
+    {
+        std::lock_guard<std::mutex> streamLock(m_streamMutex);
+        writeAudioLocked(data, numSamples);
+    }
+    releaseMarkers();
+    
+    return true;
+}
+
+bool DirettaOutput::writeAudioLocked(const uint8_t* data, size_t numSamples) {
     // CRITICAL: Different calculation for DSD vs PCM
     size_t dataSize;
     
@@ -456,6 +714,33 @@ if (!m_currentFormat.isDSD && m_currentFormat.bitDepth == 24) {
     }
     m_syncBuffer->setStream(stream);
     m_totalSamplesSent += numSamples;
+    
+    // ⭐ Seek-to-sound: from the request until the target consumes the
+    // first sample sent after the flush (polled once per send)
+    if (m_flushPending) {
+        m_flushPending = false;
+        m_flushMeasuring = true;
+        m_flushFirstSample = m_totalSamplesSent - static_cast<int64_t>(numSamples);
+    } else if (m_flushMeasuring) {
+        int64_t consumed = m_totalSamplesSent - static_cast<int64_t>(m_syncBuffer->getLastBufferCount());
+        if (consumed > m_flushFirstSample) {
+            m_flushMeasuring = false;
+            
+            auto measured = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - m_flushRequestTime).count();
+            int64_t staleMs = (m_currentFormat.sampleRate > 0) 
+                ? (m_flushStaleSamples * 1000) / m_currentFormat.sampleRate : 0;
+            m_lastSeekToSoundMs = measured;
+            
+            std::cout << "[DirettaOutput] ⏱️  Seek-to-sound: " << measured << " ms measured ("
+                      << staleMs << " ms of stale audio " << (m_seekFlush ? "dropped" : "played first")
+                      << ")" << std::endl;
+        }
+    }
+    
+    if (m_cycleAutoTune) {
+        observeCycleTuning(numSamples);
+    }
 
     static int callCount = 0;
     if (++callCount % 500 == 0) {
@@ -463,13 +748,216 @@ if (!m_currentFormat.isDSD && m_currentFormat.bitDepth == 24) {
         DEBUG_LOG("[DirettaOutput] Position: " << seconds << "s (" 
                   << m_totalSamplesSent << " samples)");
     }
+    
+    return true;
+}
+
+void DirettaOutput::addMarker(TrackMarker marker) {
+    {
+        std::lock_guard<std::mutex> lock(m_markerMutex);
+        marker.sample = m_totalSamplesSent;
+        m_markers.push_back(std::move(marker));
+    }
+    
+    // No session: nothing queued in front of the boundary
+    releaseMarkers(!m_connected || !m_playing);
+}
+
+void DirettaOutput::setMarkerCallback(const std::function<void(const TrackMarker&)>& callback) {
+    std::lock_guard<std::mutex> lock(m_markerMutex);
+    m_markerCallback = callback;
+}
+
+bool DirettaOutput::hasPendingMarkers() const {
+    std::lock_guard<std::mutex> lock(m_markerMutex);
+    return !m_markers.empty();
+}
+
+int64_t DirettaOutput::consumedSamples() const {
+    // Samples handed to the SDK minus those still queued = consumed by the target
+    std::lock_guard<std::mutex> lock(m_streamMutex);
+    int64_t consumed = m_totalSamplesSent;
+    if (m_connected && m_syncBuffer) {
+        consumed -= static_cast<int64_t>(m_syncBuffer->getLastBufferCount());
+    }
+    return consumed;
+}
 
+void DirettaOutput::releaseMarkers(bool all) {
+    if (!all && !hasPendingMarkers()) {
+        return;
+    }
+    int64_t consumed = all ? 0 : consumedSamples();
+    
+    std::vector<TrackMarker> due;
+    std::function<void(const TrackMarker&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(m_markerMutex);
+        if (m_markers.empty()) {
+            return;
+        }
         
-    return true;
+        while (!m_markers.empty() && (all || m_markers.front().sample <= consumed)) {
+            due.push_back(std::move(m_markers.front()));
+            m_markers.pop_front();
+        }
+        callback = m_markerCallback;
+    }
+    
+    for (const auto& marker : due) {
+        DEBUG_LOG("[DirettaOutput] 🏁 Track " << marker.trackNumber << " boundary at sample "
+                  << marker.sample << (all ? " (buffer dropped)" : " reached target"));
+        if (callback) {
+            callback(marker);
+        }
+    }
 }
 
 float DirettaOutput::getBufferLevel() const {
-    return 0.5f;
+    std::lock_guard<std::mutex> lock(m_streamMutex);
+    if (!m_syncBuffer || m_bufferCapacity <= 0) {
+        return 0.0f;
+    }
+    
+    float level = static_cast<float>(m_syncBuffer->getLastBufferCount()) / 
+                  static_cast<float>(m_bufferCapacity);
+    return std::min(1.0f, std::max(0.0f, level));
+}
+
+double DirettaOutput::getOutputDelay() const {
+    // Staged next track: not sent yet
+    if (m_reconfiguring && m_pendingFormat.sampleRate > 0) {
+        return static_cast<double>(m_stagedSamples) / m_pendingFormat.sampleRate + m_targetLatencyMs / 1000.0;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_streamMutex);
+    if (!m_connected || !m_syncBuffer || m_currentFormat.sampleRate == 0) {
+        return 0.0;
+    }
+    
+    double queued = static_cast<double>(m_syncBuffer->getLastBufferCount()) / m_currentFormat.sampleRate;
+    return queued + m_targetLatencyMs / 1000.0;
+}
+
+bool DirettaOutput::sendSilence(size_t numSamples) {
+    if (!m_connected || !m_playing) {
+        return false;
+    }
+    
+    bool sent;
+    {
+        std::lock_guard<std::mutex> lock(m_streamMutex);
+        sent = pushSilence(numSamples);
+    }
+    releaseMarkers();
+    return sent;
+}
+
+bool DirettaOutput::pushSilence(size_t numSamples) {
+    if (!m_syncBuffer || numSamples == 0) {
+        return false;
+    }
+    
+    size_t dataSize;
+    if (m_currentFormat.isDSD) {
+        dataSize = (numSamples * m_currentFormat.channels) / 8;
+    } else {
+        dataSize = numSamples * (m_currentFormat.bitDepth / 8) * m_currentFormat.channels;
+    }
+    
+    DIRETTA::Stream stream;
+    stream.resize(dataSize);
+    memset(stream.get(), m_currentFormat.isDSD ? 0x69 : 0x00, dataSize);
+    
+    m_syncBuffer->setStream(stream);
+    m_totalSamplesSent += numSamples;
+    return true;
+}
+
+int64_t DirettaOutput::discardBuffered() {
+    int64_t stale = static_cast<int64_t>(m_syncBuffer->getLastBufferCount());
+    
+    // Drop everything queued, then a short silence run so the DAC stays locked
+    m_syncBuffer->seek_front();
+    
+    size_t silence = static_cast<size_t>(m_currentFormat.sampleRate) * FLUSH_SILENCE_MS / 1000;
+    pushSilence(silence & ~static_cast<size_t>(31));
+    
+    return stale;
+}
+
+int64_t DirettaOutput::flush(std::chrono::steady_clock::time_point requestTime) {
+    // Seek into the track being staged: drop it, skip the old tail
+    if (m_reconfiguring) {
+        std::lock_guard<std::mutex> stageLock(m_stageMutex);
+        if (m_reconfiguring) {
+            int64_t staged = static_cast<int64_t>(m_stagedSamples);
+            m_staged.clear();
+            m_stagedSamples = 0;
+            m_formatSkipDrain = true;
+            DEBUG_LOG("[DirettaOutput] 🧹 Dropped " << staged << " staged samples (format change)");
+            return staged;
+        }
+    }
+    
+    if (!m_connected || !m_playing || !m_syncBuffer) {
+        return 0;
+    }
+    
+    int64_t stale;
+    {
+        std::lock_guard<std::mutex> lock(m_streamMutex);
+        m_flushRequestTime = requestTime;
+        m_flushPending = true;
+        m_flushMeasuring = false;
+        
+        // Baseline: stale audio plays out first, only the latency is measured
+        if (!m_seekFlush) {
+            m_flushStaleSamples = static_cast<int64_t>(m_syncBuffer->getLastBufferCount());
+            return 0;
+        }
+        
+        stale = discardBuffered();
+        m_flushStaleSamples = stale;
+    }
+    releaseMarkers(true);
+    
+    DEBUG_LOG("[DirettaOutput] 🧹 Flushed " << stale << " buffered samples (session kept)");
+    return stale;
+}
+
+bool DirettaOutput::linger() {
+    finishFormatChange();
+    
+    if (!m_connected || !m_playing || !m_syncBuffer) {
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_streamMutex);
+        discardBuffered();
+        m_flushPending = false;
+        m_flushMeasuring = false;
+    }
+    releaseMarkers(true);
+    
+    m_isPaused = false;
+    m_holding = true;
+    m_lingering = true;
+    
+    DEBUG_LOG("[DirettaOutput] ✓ Session lingering (silence)");
+    return true;
+}
+
+void DirettaOutput::endLinger() {
+    if (!m_lingering) {
+        return;
+    }
+    
+    m_lingering = false;
+    m_holding = false;
+    
+    DEBUG_LOG("[DirettaOutput] ✓ Linger ended, session reused");
 }
 
 bool DirettaOutput::findTarget() {
@@ -503,10 +991,11 @@ bool DirettaOutput::findTarget() {
     m_targetAddress = targets.begin()->first;
     
 // ⭐ TOUJOURS mesurer le MTU physique
-    uint32_t measuredMTU = 1500;
-    if (find.measSendMTU(m_targetAddress, measuredMTU)) {
+    uint32_t measuredMTU = measureTargetMTU(find, m_targetAddress);
+    if (measuredMTU > 0) {
         DEBUG_LOG("[DirettaOutput] 📊 Physical MTU measured: " << measuredMTU << " bytes");
     } else {
+        measuredMTU = 1500;
         std::cerr << "[DirettaOutput] ⚠️  Failed to measure MTU" << std::endl;
     }
     
@@ -531,6 +1020,13 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
     
     bool infiniteMode = (TARGET_FIND_MAX_RETRIES < 0);
     
+    // A cancelled format change (close/stop) must not wait for a target
+    auto retryWait = [this]() {
+        for (int waited = 0; waited < TARGET_FIND_RETRY_DELAY_MS && !m_formatCancel; waited += 50) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    };
+    
     if (infiniteMode) {
         std::cout << "[DirettaOutput] 🔍 Searching for Diretta targets (infinite wait mode)..." << std::endl;
     } else {
@@ -538,7 +1034,7 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
                   << TARGET_FIND_MAX_RETRIES << " attempts)..." << std::endl;
     }
     
-    while (!targetFound && (infiniteMode || retryCount < TARGET_FIND_MAX_RETRIES)) {
+    while (!targetFound && !m_formatCancel && (infiniteMode || retryCount < TARGET_FIND_MAX_RETRIES)) {
         DIRETTA::Find find(findSetting);
         
         // Try to open Find
@@ -547,7 +1043,7 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
                 std::cerr << "[DirettaOutput] ⚠️  Failed to open Find, retrying..." << std::endl;
             }
             retryCount++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(TARGET_FIND_RETRY_DELAY_MS));
+            retryWait();
             continue;
         }
         
@@ -557,7 +1053,7 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
                 std::cerr << "[DirettaOutput] ⚠️  Failed to find outputs, retrying..." << std::endl;
             }
             retryCount++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(TARGET_FIND_RETRY_DELAY_MS));
+            retryWait();
             continue;
         }
         
@@ -590,7 +1086,7 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
             }
             
             retryCount++;
-            std::this_thread::sleep_for(std::chrono::milliseconds(TARGET_FIND_RETRY_DELAY_MS));
+            retryWait();
             continue;
         }
         
@@ -598,6 +1094,11 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
         targetFound = true;
     }
     
+    if (!targetFound && m_formatCancel) {
+        DEBUG_LOG("[DirettaOutput] Target search cancelled");
+        return false;
+    }
+    
     // Final check: did we find any targets?
     if (!targetFound || targets.empty()) {
         // Only fail if not in infinite mode
@@ -632,10 +1133,10 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
         // Measure MTU for selected target
         DIRETTA::Find find(findSetting);
         if (find.open()) {
-            uint32_t measuredMTU = 1500;
             DEBUG_LOG("[DirettaOutput] Measuring network MTU...");
+            uint32_t measuredMTU = measureTargetMTU(find, m_targetAddress);
             
-            if (find.measSendMTU(m_targetAddress, measuredMTU)) {
+            if (measuredMTU > 0) {
                 DEBUG_LOG("[DirettaOutput] 📊 Physical MTU measured: " << measuredMTU << " bytes");
                 
                 if (measuredMTU >= 9000) {
@@ -719,7 +1220,7 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
     DEBUG_LOG("[DirettaOutput] Measuring network MTU...");
     
     DIRETTA::Find find(findSetting);
-    if (find.open() && find.measSendMTU(m_targetAddress, measuredMTU)) {
+    if (find.open() && (measuredMTU = measureTargetMTU(find, m_targetAddress)) > 0) {
         DEBUG_LOG("[DirettaOutput] 📊 Physical MTU measured: " << measuredMTU << " bytes");
         
         if (measuredMTU >= 9000) {
@@ -731,6 +1232,7 @@ bool DirettaOutput::findAndSelectTarget(int targetIndex) {
         }
         std::cout << std::endl;
     } else {
+        measuredMTU = 1500;
         std::cerr << "[DirettaOutput] ⚠️  Failed to measure MTU, using default: " 
                   << measuredMTU << " bytes" << std::endl;
     }
@@ -958,6 +1460,20 @@ bool DirettaOutput::verifyTargetAvailable() {
             std::cout << "[DirettaOutput] " << std::endl;
         }
         
+        // ⭐ Measure the MTU now, while startup runs: the first open()
+        // takes it from the per-target cache instead of measuring on Play
+        if (m_targetIndex >= 0 || targets.size() == 1) {
+            auto it = targets.begin();
+            std::advance(it, std::max(m_targetIndex, 0));
+            auto mtuStart = std::chrono::steady_clock::now();
+            uint32_t mtu = measureTargetMTU(find, it->first);
+            auto mtuMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - mtuStart).count();
+            std::cout << "[DirettaOutput] ⏱️  MTU measured ahead of Play: "
+                      << (mtu > 0 ? std::to_string(mtu) + " bytes" : std::string("n/a"))
+                      << " (" << mtuMs << "ms)" << std::endl;
+        }
+        
         return true;
     }
     
@@ -969,13 +1485,16 @@ bool DirettaOutput::configureDiretta(const AudioFormat& format) {
     DEBUG_LOG("[DirettaOutput] Configuring SyncBuffer...");
     
     // ⭐ v1.2.0 : TOUJOURS recréer m_syncBuffer pour éviter les blocages
-    if (m_syncBuffer) {
-        DEBUG_LOG("[DirettaOutput] Destroying existing SyncBuffer...");
-        m_syncBuffer.reset();  // Détruire l'ancien
+    {
+        std::lock_guard<std::mutex> lock(m_streamMutex);
+        if (m_syncBuffer) {
+            DEBUG_LOG("[DirettaOutput] Destroying existing SyncBuffer...");
+            m_syncBuffer.reset();  // Détruire l'ancien
+        }
+        
+        DEBUG_LOG("[DirettaOutput] Creating new SyncBuffer...");
+        m_syncBuffer = std::make_unique<DIRETTA::SyncBuffer>();
     }
-    
-    DEBUG_LOG("[DirettaOutput] Creating new SyncBuffer...");
-    m_syncBuffer = std::make_unique<DIRETTA::SyncBuffer>();
   
     
   
@@ -1193,6 +1712,7 @@ bool DirettaOutput::configureDiretta(const AudioFormat& format) {
     
     // Setup buffer (network config will be optimized below)
     const int fs1sec = format.sampleRate;
+    m_bufferCapacity = static_cast<int64_t>(fs1sec * m_bufferSeconds);
     m_syncBuffer->setupBuffer(fs1sec * m_bufferSeconds, 4, false);
     
     // ⭐ v1.2.0 Stable: Optimize network config for format
@@ -1266,7 +1786,12 @@ void DirettaOutput::optimizeNetworkConfig(const AudioFormat& format) {
     
     // In Fix mode with user-specified cycle-time, use that value
     // Otherwise calculate optimal cycle time dynamically
-    if (m_transferMode == TransferMode::Fix && m_cycleTime != 10000) {
+    bool userCycleTime = (m_transferMode == TransferMode::Fix && m_cycleTime != 10000);
+    
+    // For DSD, use 1 bit per sample; for PCM use actual bit depth
+    int bitsPerSample = format.isDSD ? 1 : format.bitDepth;
+    
+    if (userCycleTime) {
         // User specified --cycle-time for precise control
         cycleTime = m_cycleTime;
         DEBUG_LOG("[DirettaOutput]    Cycle time: " << cycleTime 
@@ -1275,9 +1800,6 @@ void DirettaOutput::optimizeNetworkConfig(const AudioFormat& format) {
         // Calculate optimal cycle time dynamically (v1.3.0 feature)
         DirettaCycleCalculator calculator(m_mtu);
         
-        // For DSD, use 1 bit per sample; for PCM use actual bit depth
-        int bitsPerSample = format.isDSD ? 1 : format.bitDepth;
-        
         cycleTime = calculator.calculate(
             format.sampleRate, 
             format.channels, 
@@ -1287,42 +1809,211 @@ void DirettaOutput::optimizeNetworkConfig(const AudioFormat& format) {
                   << " µs (calculated)");
     }
     
+    // ═══════════════════════════════════════════════════════════════
+    // ⭐ Closed-loop auto-tuning: reuse a converged value or start tuning
+    // ═══════════════════════════════════════════════════════════════
+    
+    if (m_cycleAutoTune && !userCycleTime) {
+        std::lock_guard<std::mutex> lock(m_tuneMutex);
+        
+        std::ostringstream key;
+        key << m_targetAddress.get_str() << "|" 
+            << (format.isDSD ? "DSD" : "PCM") << "/" << format.sampleRate 
+            << "/" << bitsPerSample << "/" << format.channels;
+        bool sameKey = (key.str() == m_cycleTuneKey);
+        m_cycleTuneKey = key.str();
+        
+        CycleTuneStats remembered;
+        if (sameKey && m_cycleTuner.isActive()) {
+            // Tuning in progress: this session tries the next candidate
+            m_cycleTuner.resume();
+            cycleTime = m_cycleTuner.getStats().cycleTime;
+            DEBUG_LOG("[DirettaOutput] 📈 Cycle tuner: trying " << cycleTime 
+                      << " µs for " << m_cycleTuneKey);
+        } else if (CycleTuneCache::load(m_cycleTuneKey, remembered)) {
+            m_cycleTuner.restore(remembered);
+            cycleTime = remembered.cycleTime;
+            std::cout << "[DirettaOutput] 📈 Cycle tuner: using remembered " << cycleTime 
+                      << " µs for " << m_cycleTuneKey << std::endl;
+        } else {
+            double bytesPerSecond = static_cast<double>(format.sampleRate) * 
+                                    format.channels * bitsPerSample / 8.0;
+            m_cycleTuner.start(cycleTime, bytesPerSecond, 
+                               static_cast<int>(m_mtu) - DirettaCycleCalculator::OVERHEAD);
+            DEBUG_LOG("[DirettaOutput] 📈 Cycle tuner: starting from " << cycleTime 
+                      << " µs for " << m_cycleTuneKey);
+        }
+    }
+    
+    applyTransferConfig(cycleTime);
+}
+
+void DirettaOutput::applyTransferConfig(unsigned int cycleTime) {
+    // ═══════════════════════════════════════════════════════════════
+    // ⭐ v1.3.0: Configure transfer mode
+    // ═══════════════════════════════════════════════════════════════
+    
+    if (m_transferMode == TransferMode::VarMax) {
+        // VarMax: Adaptive cycle time
+        ACQUA::Clock cycle = ACQUA::Clock::MicroSeconds(cycleTime);
+        m_syncBuffer->configTransferVarMax(cycle);
+        
+        DEBUG_LOG("[DirettaOutput] ✓ Transfer: VarMax (adaptive), cycle " << cycleTime << " µs");
+        
+    } else {
+        // Fix: Fixed period timing (as per Yu Harada's example)
+        ACQUA::Clock cycle = ACQUA::Clock::MicroSeconds(cycleTime);  // ← MicroSeconds()!
+        int periodTime = cycleTime;  // Same value in microseconds
+        bool success = m_syncBuffer->configTransferFix(cycle, periodTime);
+        
+        if (success) {
+            double freq_hz = 1000000.0 / cycleTime;
+            
+            DEBUG_LOG("[DirettaOutput] ✓ Transfer: Fix (precise timing), period " << cycleTime 
+                      << " µs (" << std::fixed << std::setprecision(2) << freq_hz << " Hz)");
+        } else {
+            std::cerr << "[DirettaOutput] ❌ configTransferFix failed!" << std::endl;
+            std::cerr << "[DirettaOutput]    Falling back to VarMax..." << std::endl;
+            ACQUA::Clock fallback = ACQUA::Clock::MicroSeconds(cycleTime);
+            m_syncBuffer->configTransferVarMax(fallback);
+        }
+    }
+    
+    DEBUG_LOG("[DirettaOutput] ✓ Network configured");
+}
+
 // ═══════════════════════════════════════════════════════════════
-// ⭐ v1.3.0: Configure transfer mode
+// ⭐ Closed-loop cycle time auto-tuning
 // ═══════════════════════════════════════════════════════════════
 
-if (m_transferMode == TransferMode::VarMax) {
-    // VarMax: Adaptive cycle time
-    ACQUA::Clock cycle = ACQUA::Clock::MicroSeconds(cycleTime);
-    m_syncBuffer->configTransferVarMax(cycle);
+void DirettaCycleTuner::start(unsigned int calculatedCycle, double bytesPerSecond, int efficientMTU) {
+    m_stats = CycleTuneStats();
+    m_bytesPerSecond = bytesPerSecond;
+    m_efficientMTU = efficientMTU;
     
-    DEBUG_LOG("[DirettaOutput]    Mode: VarMax (adaptive)");
-    std::cout << "[DirettaOutput] ✓ Transfer: VarMax (adaptive)" << std::endl;
+    // Calculated value = 100% payload per packet, never go above it
+    m_upper = calculatedCycle;
+    m_lower = std::max(MIN_CYCLE_US, calculatedCycle / 4);
     
-} else {
-    // Fix: Fixed period timing (as per Yu Harada's example)
-    ACQUA::Clock cycle = ACQUA::Clock::MicroSeconds(cycleTime);  // ← MicroSeconds()!
-    int periodTime = cycleTime;  // Same value in microseconds
-    bool success = m_syncBuffer->configTransferFix(cycle, periodTime);
+    m_stats.calculatedCycle = calculatedCycle;
+    m_stats.cycleTime = calculatedCycle;
+    m_stats.utilization = utilizationFor(calculatedCycle);
     
-    if (success) {
-        double freq_hz = 1000000.0 / cycleTime;
-        
-        DEBUG_LOG("[DirettaOutput]    Mode: Fix (precise timing)");
-        std::cout << "[DirettaOutput] ✓ Transfer: Fix (precise timing)" << std::endl;
-        std::cout << "[DirettaOutput]    Fixed period: " << cycleTime 
-                  << " µs (" << std::fixed << std::setprecision(2) 
-                  << freq_hz << " Hz)" << std::endl;
+    m_active = (calculatedCycle > MIN_CYCLE_US);
+    resume();
+}
+
+void DirettaCycleTuner::restore(const CycleTuneStats& remembered) {
+    m_stats = remembered;
+    m_stats.remembered = true;
+    m_active = false;
+    m_pending = false;
+}
+
+void DirettaCycleTuner::resume() {
+    m_pending = false;
+    m_sessionWindows = 0;
+    m_windowSeconds = 0.0;
+    m_windowLate = 0;
+}
+
+double DirettaCycleTuner::utilizationFor(unsigned int cycle) const {
+    if (m_efficientMTU <= 0) {
+        return 0.0;
+    }
+    return (cycle / 1000000.0) * m_bytesPerSecond / m_efficientMTU;
+}
+
+bool DirettaCycleTuner::observe(bool bufferEmpty, double seconds) {
+    // A chosen candidate is only judged once a session runs with it
+    if (!m_active || m_pending) {
+        return false;
+    }
+    
+    if (bufferEmpty) {
+        m_windowLate++;
+    }
+    
+    m_windowSeconds += seconds;
+    if (m_windowSeconds < WINDOW_SECONDS) {
+        return false;
+    }
+    
+    bool unstable = (m_windowLate > 0);
+    bool warmup = (++m_sessionWindows <= WARMUP_WINDOWS);
+    uint64_t late = m_windowLate;
+    
+    m_windowSeconds = 0.0;
+    m_windowLate = 0;
+    
+    if (warmup) {
+        return false;
+    }
+    
+    m_stats.windows++;
+    m_stats.lateCycles += late;
+    
+    unsigned int previous = m_stats.cycleTime;
+    
+    // Bisect between the largest stable and the smallest unstable cycle
+    if (unstable) {
+        m_upper = previous;
     } else {
-        std::cerr << "[DirettaOutput] ❌ configTransferFix failed!" << std::endl;
-        std::cerr << "[DirettaOutput]    Falling back to VarMax..." << std::endl;
-        ACQUA::Clock fallback = ACQUA::Clock::MicroSeconds(cycleTime);
-        m_syncBuffer->configTransferVarMax(fallback);
+        m_lower = previous;
     }
+    
+    bool narrow = (m_upper - m_lower) <= std::max(1u, m_upper / 50);
+    bool atMaximum = (!unstable && previous >= m_upper);
+    
+    if (narrow || atMaximum || m_stats.windows >= MAX_WINDOWS) {
+        m_stats.cycleTime = m_lower;
+        m_stats.converged = true;
+        m_active = false;
+    } else {
+        m_stats.cycleTime = m_lower + (m_upper - m_lower) / 2;
+    }
+    
+    m_stats.utilization = utilizationFor(m_stats.cycleTime);
+    
+    bool changed = (m_stats.cycleTime != previous);
+    m_pending = changed && m_active;
+    return changed;
 }
 
-DEBUG_LOG("[DirettaOutput] ✓ Network configured");
+void DirettaOutput::observeCycleTuning(size_t numSamples) {
+    std::lock_guard<std::mutex> lock(m_tuneMutex);
+    
+    if (!m_cycleTuner.isActive() || m_currentFormat.sampleRate == 0) {
+        return;
+    }
+    
+    double seconds = static_cast<double>(numSamples) / m_currentFormat.sampleRate;
+    bool changed = m_cycleTuner.observe(m_syncBuffer->buffer_empty(), seconds);
+    const CycleTuneStats& stats = m_cycleTuner.getStats();
+    
+    // The transfer is reconfigured at the next open, not under the writer
+    if (changed) {
+        DEBUG_LOG("[DirettaOutput] 📈 Cycle tuner: window " << stats.windows 
+                  << " → " << stats.cycleTime << " µs (utilization " 
+                  << std::fixed << std::setprecision(0) << (stats.utilization * 100.0) 
+                  << "%), applied at the next open");
+    }
+    
+    if (stats.converged) {
+        CycleTuneCache::store(m_cycleTuneKey, stats);
+        
+        std::cout << "[DirettaOutput] 📈 Cycle tuner converged for " << m_cycleTuneKey << ": "
+                  << stats.cycleTime << " µs (calculated " << stats.calculatedCycle << " µs), utilization " 
+                  << std::fixed << std::setprecision(0) << (stats.utilization * 100.0) << "%, "
+                  << stats.lateCycles << " late cycles, " << stats.windows << " windows" << std::endl;
+    }
 }
+
+CycleTuneStats DirettaOutput::getCycleTuneStats() const {
+    std::lock_guard<std::mutex> lock(m_tuneMutex);
+    return m_cycleTuner.getStats();
+}
+
 // ═══════════════════════════════════════════════════════════════
 // ⭐ v1.2.0: Gapless Pro - Implementation
 // ═══════════════════════════════════════════════════════════════
@@ -1412,6 +2103,7 @@ bool DirettaOutput::isNextTrackReady() const {
 
 // ⭐ v1.2.0 Stable: Buffer status check
 bool DirettaOutput::isBufferEmpty() const {
+    std::lock_guard<std::mutex> lock(m_streamMutex);
     if (!m_syncBuffer || !m_connected) {
         return true;  // Considérer vide si pas connecté
     }
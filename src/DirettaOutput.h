@@ -4,10 +4,18 @@
 #include <Diretta/SyncBuffer>
 #include <Diretta/Find>
 #include <ACQUA/UDPV6>
+#include "CycleTuneCache.h"
 #include <string>
 #include <memory>
 #include <atomic>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <map>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <chrono>
 #include <cmath>       
 #include <algorithm>
 const int TARGET_FIND_MAX_RETRIES = -1;      // -1 = infinite, 30 = ~60s, 90 = ~3min
@@ -51,6 +59,21 @@ struct AudioFormat {
     }
 };
 
+/**
+ * @brief Track boundary queued with the audio
+ * 
+ * Positioned in output samples (frames as counted by sendAudio), not
+ * bytes: 24-bit packing changes the byte size on the way to the SDK.
+ */
+struct TrackMarker {
+    int64_t sample = 0;          // First sample of the track (set by addMarker)
+    int trackNumber = 0;
+    std::string uri;
+    std::string metadata;
+    bool formatChange = false;   // Track starts in another format
+    AudioFormat format;
+};
+
 class DirettaCycleCalculator {
 public:
     static constexpr int OVERHEAD = 24;
@@ -95,6 +118,76 @@ enum class TransferMode {
     Fix      // Fixed (precise timing)
 };
 
+// ═══════════════════════════════════════════════════════════════════════════
+// ⭐ Closed-loop cycle time auto-tuning
+// ═══════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Closed-loop cycle time tuner
+ * 
+ * Starts from the calculated cycle time (maximum payload per packet) and
+ * evaluates one-second observation windows of the SDK buffer while
+ * playing. A window is unstable when the buffer ran empty (the sink was
+ * starved); a full buffer is the normal state with a real-time producer
+ * and says nothing about the cycle.
+ * 
+ * An unstable window shrinks the cycle, a stable one grows it back toward
+ * the last unstable value (bisection). Each candidate is applied when the
+ * session next opens, never while audio is being written, and observed
+ * from there. Tuning stops once the bracket is narrower than 2% or after
+ * MAX_WINDOWS windows.
+ */
+class DirettaCycleTuner {
+public:
+    static constexpr double WINDOW_SECONDS = 1.0;
+    static constexpr int WARMUP_WINDOWS = 1;    // Ignore prefill after each open
+    static constexpr int MAX_WINDOWS = 12;
+    static constexpr unsigned int MIN_CYCLE_US = 100;
+    
+    /**
+     * @brief Start tuning from the calculated cycle time
+     * @param calculatedCycle Cycle time from DirettaCycleCalculator (µs)
+     * @param bytesPerSecond Nominal payload byte rate of the format
+     * @param efficientMTU MTU minus protocol overhead
+     */
+    void start(unsigned int calculatedCycle, double bytesPerSecond, int efficientMTU);
+    
+    /**
+     * @brief Resume from a previously converged result (no tuning)
+     */
+    void restore(const CycleTuneStats& remembered);
+    
+    /**
+     * @brief A session opened with the current candidate: observe it
+     */
+    void resume();
+    
+    /**
+     * @brief Feed one observation (called per sendAudio)
+     * @param bufferEmpty True if the SDK buffer ran empty
+     * @param seconds Audio duration represented by this observation
+     * @return true if a new cycle time was chosen (applies at the next open)
+     */
+    bool observe(bool bufferEmpty, double seconds);
+    
+    bool isActive() const { return m_active; }
+    const CycleTuneStats& getStats() const { return m_stats; }
+    
+private:
+    double utilizationFor(unsigned int cycle) const;
+    
+    CycleTuneStats m_stats;
+    bool m_active = false;
+    bool m_pending = false;     // Candidate chosen, not applied yet
+    double m_bytesPerSecond = 0.0;
+    int m_efficientMTU = 0;
+    unsigned int m_lower = 0;   // Largest cycle confirmed stable
+    unsigned int m_upper = 0;   // Smallest cycle seen unstable
+    int m_sessionWindows = 0;   // Windows since the candidate was applied
+    double m_windowSeconds = 0.0;
+    uint64_t m_windowLate = 0;
+};
+
 /**
  * @brief Diretta output handler
  * 
@@ -151,6 +244,44 @@ public:
      */
     bool changeFormat(const AudioFormat& newFormat);
     
+    /**
+     * @brief Change format at a track boundary without blocking the caller
+     * 
+     * Runs in the background: the previous track plays out of the SDK
+     * buffer, the session is closed and reopened in the new format after
+     * the DAC relock delay, then play starts. Meanwhile sendAudio() keeps
+     * accepting the new track in the new format (staged, up to the buffer
+     * size) and the staged audio is queued at once when the session is
+     * back: the gap is the relock time only.
+     * 
+     * @param newFormat Format of the audio sent from now on
+     * @return false if no session is playing (use changeFormat())
+     */
+    bool beginFormatChange(const AudioFormat& newFormat);
+    
+    /**
+     * @brief Wait for a background format change to complete
+     * @return true if the session is connected afterwards
+     */
+    bool finishFormatChange();
+    
+    bool isReconfiguring() const { return m_reconfiguring; }
+    
+    /**
+     * @brief Format being switched to (valid while isReconfiguring())
+     */
+    const AudioFormat& getPendingFormat() const { return m_pendingFormat; }
+    
+    /**
+     * @brief Announce the format of the next track ahead of the splice
+     * 
+     * Called as soon as a preloaded next track is known to need a format
+     * change; changeFormat() then reports how far ahead it was known.
+     * 
+     * @param format Next track format
+     */
+    void announceFormat(const AudioFormat& format);
+    
     /**
      * @brief Get current audio format
      * @return Current format
@@ -165,12 +296,84 @@ public:
      */
     bool sendAudio(const uint8_t* data, size_t numSamples); 
     
+    /**
+     * @brief Send silence in the current format
+     * @param numSamples Number of samples (frames)
+     * @return true if successful, false otherwise
+     */
+    bool sendSilence(size_t numSamples);
+    
+    /**
+     * @brief Discard buffered audio without closing the session
+     * 
+     * Drops everything queued in the SDK buffer and queues a short
+     * silence run so the DAC stays locked. Once the target consumes the
+     * first sample sent afterwards, seek-to-sound latency measured from
+     * requestTime is logged. With setSeekFlush(false) nothing is dropped,
+     * only the measurement runs (baseline for comparison).
+     * 
+     * @param requestTime When the seek was requested
+     * @return Number of samples discarded
+     */
+    int64_t flush(std::chrono::steady_clock::time_point requestTime = std::chrono::steady_clock::now());
+    
+    /**
+     * @brief Drop buffered audio on seek (default), or let it play out
+     */
+    void setSeekFlush(bool enabled) { m_seekFlush = enabled; }
+    
+    /**
+     * @brief Last measured seek-to-sound latency in ms (-1 = none yet)
+     */
+    int64_t getLastSeekToSoundMs() const { return m_lastSeekToSoundMs; }
+    
+    /**
+     * @brief Queue a track boundary at the current write position
+     * 
+     * The marker callback fires once the SDK has consumed every sample
+     * sent before the boundary, i.e. when the new track reaches the
+     * target. Markers still queued when buffered audio is dropped
+     * (seek, pause, stop, close) fire at that point. Without an active
+     * session the marker fires immediately.
+     * 
+     * @param marker Boundary (sample is overwritten)
+     */
+    void addMarker(TrackMarker marker);
+    
+    /**
+     * @brief Set the handler for markers reaching the target
+     * 
+     * Called from the thread feeding the output, outside the stream lock.
+     */
+    void setMarkerCallback(const std::function<void(const TrackMarker&)>& callback);
+    
+    /**
+     * @brief True while a queued boundary has not reached the target yet
+     */
+    bool hasPendingMarkers() const;
+    
     /**
      * @brief Get buffer level (for monitoring)
      * @return Buffer fill level (0.0 to 1.0)
      */
     float getBufferLevel() const;
     
+    /**
+     * @brief Seconds of audio sent but not audible yet
+     * 
+     * Samples still queued in the SDK buffer plus the configured target
+     * latency; the playback position is derived from it.
+     * 
+     * @return Delay in seconds (0 when not connected)
+     */
+    double getOutputDelay() const;
+    
+    /**
+     * @brief Set the latency of the target and DAC after the SDK buffer
+     * @param ms Latency in milliseconds
+     */
+    void setTargetLatency(int ms) { m_targetLatencyMs = std::max(0, ms); }
+    
     /**
      * @brief Set MTU (Maximum Transmission Unit) for network packets
      * 
@@ -192,6 +395,18 @@ public:
      */
     uint32_t getMTU() const { return m_mtu; }
     
+    /**
+     * @brief Set the largest MTU tried by path-MTU probing
+     * @param ceiling MTU in bytes (0 = default)
+     */
+    void setMTUCeiling(uint32_t ceiling);
+    
+    /**
+     * @brief Confirm jumbo sizes with a UDP echo responder on the target host
+     * @param port Echo port (0 = off, the SDK measurement alone is used)
+     */
+    void setMTUEchoPort(uint16_t port) { m_mtuEchoPort = port; }
+    
     /**
      * @brief Set target index for selection
      * @param index Target index (-1 = interactive, >= 0 = specific target)
@@ -200,6 +415,10 @@ public:
     
     /**
      * @brief Verify that a Diretta target is available on the network
+     *
+     * When the target to use is known (index given, or only one found),
+     * its MTU is measured too, so the first open() finds it cached.
+     *
      * @return true if at least one target is available, false otherwise
      */
     bool verifyTargetAvailable();
@@ -213,10 +432,38 @@ public:
     // Playback control
     // ═══════════════════════════════════════════════════════════════
     
-    void pause();
+    /**
+     * @brief Pause playback
+     * 
+     * With hold, buffered audio is discarded and the session is held
+     * open with silence (see sendSilence()), PCM and DSD alike. Without
+     * it (source cannot seek back to the audible position): SDK stop,
+     * resumed in place.
+     * 
+     * @param hold Hold the session with silence
+     * @return Seconds of audio discarded (caller re-seeks on resume)
+     */
+    double pause(bool hold = true);
     void resume();
     bool isPaused() const { return m_isPaused; }
     bool isPlaying() const { return m_playing; } 
+    bool isHolding() const { return m_holding; }
+    
+    /**
+     * @brief Keep the session open after Stop, streaming silence
+     * 
+     * Buffered audio is dropped and the sink keeps receiving silence
+     * (see sendSilence()) until endLinger(), stop() or close().
+     * 
+     * @return true if the session is now lingering
+     */
+    bool linger();
+    
+    /**
+     * @brief Hand a lingering session back to normal playback
+     */
+    void endLinger();
+    bool isLingering() const { return m_lingering; }
     
     
     // ═══════════════════════════════════════════════════════════════
@@ -290,12 +537,31 @@ public:
      */
     void setTransferMode(TransferMode mode);
     
+    /**
+     * @brief Enable closed-loop cycle time auto-tuning
+     * 
+     * Converged values are remembered per format and target in
+     * CycleTuneCache (on disk when a directory is set). Ignored in Fix
+     * mode with a user-specified --cycle-time.
+     * 
+     * @param enabled true to enable auto-tuning
+     */
+    void setCycleAutoTune(bool enabled) { m_cycleAutoTune = enabled; }
+    
+    /**
+     * @brief Get cycle time tuning metrics for the current session
+     */
+    CycleTuneStats getCycleTuneStats() const;
+    
 private:
     // Network
     std::unique_ptr<ACQUA::UDPV6> m_udp;
     std::unique_ptr<ACQUA::UDPV6> m_raw;
     ACQUA::IPAddress m_targetAddress;
     uint32_t m_mtu;
+    uint32_t m_mtuOverride = 0;       // setMTU(): skip probing
+    uint32_t m_mtuCeiling = 16128;    // Path-MTU probe ceiling
+    uint16_t m_mtuEchoPort = 0;       // UDP echo responder on the target (0 = none)
     
     // Diretta
     std::unique_ptr<DIRETTA::SyncBuffer> m_syncBuffer;
@@ -310,6 +576,47 @@ private:
     int64_t m_totalSamplesSent;
     int64_t m_pausedPosition;
     
+    // Session-preserving flush (seek / pause hold)
+    static constexpr int FLUSH_SILENCE_MS = 50;
+    mutable std::mutex m_streamMutex;      // SDK writes and m_syncBuffer replacement
+    std::atomic<bool> m_holding{false};
+    std::atomic<bool> m_lingering{false};
+    bool m_seekFlush = true;
+    bool m_flushPending = false;           // Seek-to-sound: waiting for the first new sample
+    bool m_flushMeasuring = false;         // Seek-to-sound: waiting for the target to consume it
+    int64_t m_flushFirstSample = 0;
+    int64_t m_flushStaleSamples = 0;
+    std::chrono::steady_clock::time_point m_flushRequestTime;
+    std::atomic<int64_t> m_lastSeekToSoundMs{-1};
+    
+    // ⭐ Track boundaries still ahead of the target
+    mutable std::mutex m_markerMutex;
+    std::deque<TrackMarker> m_markers;
+    std::function<void(const TrackMarker&)> m_markerCallback;
+    
+    // ⭐ Background format change: next track staged in the new format
+    static constexpr int FORMAT_RELOCK_MS = 600;   // DAC reinitialization between close and reopen
+    struct StagedAudio {
+        std::vector<uint8_t> data;   // sendAudio() input layout
+        size_t samples = 0;
+    };
+    std::thread m_formatThread;
+    std::atomic<bool> m_reconfiguring{false};
+    std::atomic<bool> m_formatCancel{false};
+    std::atomic<bool> m_formatSkipDrain{false};   // Seek into the new track: old tail is moot
+    AudioFormat m_pendingFormat;
+    std::mutex m_stageMutex;
+    std::condition_variable m_stageCV;
+    std::deque<StagedAudio> m_staged;
+    size_t m_stagedSamples = 0;
+    std::chrono::steady_clock::time_point m_formatChangeStart;
+    int m_requestedBufferSeconds = 2;   // open() argument, before the DSD cap
+    
+    // ⭐ Next format, announced by the preload
+    bool m_formatAnnounced = false;
+    AudioFormat m_announcedFormat;
+    std::chrono::steady_clock::time_point m_announceTime;
+    
     // ⭐ v1.2.0: Gapless Pro state
     bool m_gaplessEnabled;
     bool m_nextTrackPrepared;
@@ -325,13 +632,32 @@ private:
     // ⭐ v1.3.0: Transfer mode
     TransferMode m_transferMode;
     
+    // Cycle time auto-tuning
+    bool m_cycleAutoTune = false;
+    DirettaCycleTuner m_cycleTuner;
+    std::string m_cycleTuneKey;
+    int64_t m_bufferCapacity = 0;   // setupBuffer() size (samples)
+    int m_targetLatencyMs = 0;      // Target + DAC latency, added to the output delay
+    mutable std::mutex m_tuneMutex;
+    
     // Helper functions
     bool findTarget();
     bool findAndSelectTarget(int targetIndex = -1);
+    uint32_t measureTargetMTU(DIRETTA::Find& find, const ACQUA::IPAddress& address);
+    bool pushSilence(size_t numSamples);
+    int64_t discardBuffered();
+    bool writeAudioLocked(const uint8_t* data, size_t numSamples);
+    void closeConnection();
+    void formatChangeThread();
+    void cancelFormatChange();
+    void releaseMarkers(bool all = false);
+    int64_t consumedSamples() const;
     bool configureDiretta(const AudioFormat& format);
     
     // ⭐ v1.2.0 Stable: Network optimization
     void optimizeNetworkConfig(const AudioFormat& format);
+    void applyTransferConfig(unsigned int cycleTime);
+    void observeCycleTuning(size_t numSamples);
     
     // ⭐ v1.2.0: Gapless Pro helper
     DIRETTA::Stream createStreamFromAudio(const uint8_t* data, 
@@ -17,6 +17,8 @@
 #include <ctime>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
+#include <cstdio>      // For std::rename
 #include <functional>  // For std::hash
 #include <unistd.h>    // For gethostname
 #include <cstring>     // For strcpy
@@ -57,6 +59,25 @@ DirettaRenderer::Config::Config() {
     targetIndex = -1;  // Default: interactive selection
     networkInterface = "";  // (vide = auto-detect)
     transferMode = TransferMode::VarMax;  // ← ADD: Default to VarMax
+    cycleAutoTune = false;
+    cycleTuneDir = CycleTuneCache::DEFAULT_DIRECTORY;
+    targetLatencyMs = 0;
+    lingerSeconds = 0.0f;
+    seekFlush = true;
+    prefetchMB = 16;
+    httpConnections = PrefetchIO::DEFAULT_CONNECTIONS;
+    indexCacheDir = StreamIndexCache::DEFAULT_DIRECTORY;
+    mediaCacheMB = static_cast<int>(MediaCache::DEFAULT_DISK_SIZE / (1024 * 1024));
+    mmapInput = true;
+    pcmCacheMB = static_cast<int>(PcmCache::DEFAULT_SIZE / (1024 * 1024));
+    fixedOutputRate = 0;
+    fixedOutputBits = 24;
+    decodeThreads = 1;
+    memoryPlayMB = 0;
+    memoryPlayNext = false;
+    mtuOverride = 0;
+    mtuCeiling = 16128;
+    mtuEchoPort = 0;
 }
 
 // ============================================================================
@@ -94,6 +115,13 @@ static double parseTimeString(const std::string& timeStr) {
 }
 
 
+// Log the duration of one startup phase (cold-start tracking across releases)
+static void logStartupPhase(const char* phase, std::chrono::steady_clock::time_point since) {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - since).count();
+    std::cout << "[DirettaRenderer] ⏱️  Startup phase '" << phase << "': " << ms << "ms" << std::endl;
+}
+
 bool DirettaRenderer::start() {
     if (m_running) {
         std::cerr << "[DirettaRenderer] Already running" << std::endl;
@@ -101,10 +129,19 @@ bool DirettaRenderer::start() {
     }
     
     DEBUG_LOG("[DirettaRenderer] Initializing components...");
+    auto startupBegin = std::chrono::steady_clock::now();
     
     try {
-        // ⭐ CRITICAL: Verify Diretta Target availability BEFORE starting UPnP
-        // This prevents the renderer from accepting connections when no DAC is available
+        // ═══════════════════════════════════════════════════════════════
+        // ⭐ Parallel startup: target discovery runs while UPnP comes up
+        //
+        //   [target discovery] ─> [MTU measurement] ──────┐
+        //   [UPnP init + SSDP] ─> [threads] ─> start()    └─> first Play
+        //
+        // start() returns as soon as UPnP is up; the renderer accepts
+        // SetURI meanwhile and the first Play waits for discovery. A
+        // discovery failure is reported through hasFailed().
+        // ═══════════════════════════════════════════════════════════════
         DEBUG_LOG("[DirettaRenderer] ");
         std::cout << "[DirettaRenderer] ══════════════════════════════════════════════════════" << std::endl;
         std::cout << "[DirettaRenderer] ⚠️  IMPORTANT: Checking Diretta Target availability..." << std::endl;
@@ -118,39 +155,66 @@ bool DirettaRenderer::start() {
         m_direttaOutput->setTransferMode(m_config.transferMode);
         // ⭐ v1.3.0: Set cycle time (CRITIQUE pour Fix mode!)
         m_direttaOutput->setCycleTime(m_config.cycleTime);
-
-
-        // ⭐ Verify target is available by attempting discovery
-        if (!m_direttaOutput->verifyTargetAvailable()) {
-            std::cerr << "[DirettaRenderer] " << std::endl;
-            std::cerr << "[DirettaRenderer] ══════════════════════════════════════════════════════" << std::endl;
-            std::cerr << "[DirettaRenderer] ❌ FATAL: No Diretta Target available!" << std::endl;
-            std::cerr << "[DirettaRenderer] ══════════════════════════════════════════════════════" << std::endl;
-            std::cerr << "[DirettaRenderer] " << std::endl;
-            std::cerr << "[DirettaRenderer] The renderer cannot start without a Diretta Target." << std::endl;
-            std::cerr << "[DirettaRenderer] " << std::endl;
-            std::cerr << "[DirettaRenderer] Please:" << std::endl;
-            std::cerr << "[DirettaRenderer]   1. Power on your Diretta Target device" << std::endl;
-            std::cerr << "[DirettaRenderer]   2. Ensure it's connected to the same network" << std::endl;
-            std::cerr << "[DirettaRenderer]   3. Check firewall settings" << std::endl;
-            std::cerr << "[DirettaRenderer]   4. Run: ./bin/DirettaRendererUPnP --list-targets" << std::endl;
-            std::cerr << "[DirettaRenderer] " << std::endl;
-            return false;
+        m_direttaOutput->setCycleAutoTune(m_config.cycleAutoTune);
+        if (m_config.cycleAutoTune) {
+            CycleTuneCache::setDirectory(m_config.cycleTuneDir);
         }
+        m_direttaOutput->setTargetLatency(m_config.targetLatencyMs);
+        m_direttaOutput->setSeekFlush(m_config.seekFlush);
         
-        std::cout << "[DirettaRenderer] ✓ Diretta Target verified and ready" << std::endl;
-        DEBUG_LOG("[DirettaRenderer] ");
-        
-        // Configure MTU
-        if (m_networkMTU != 1500) {
-            m_direttaOutput->setMTU(m_networkMTU);
+        // Configure MTU (override skips probing, ceiling bounds it)
+        if (m_config.mtuOverride > 0) {
+            m_direttaOutput->setMTU(m_config.mtuOverride);
         }
+        m_direttaOutput->setMTUCeiling(m_config.mtuCeiling);
+        m_direttaOutput->setMTUEchoPort(static_cast<uint16_t>(m_config.mtuEchoPort));
         
         // ⭐ v1.2.0: Configure Gapless Pro mode
         m_direttaOutput->setGaplessMode(m_config.gaplessEnabled);
         DEBUG_LOG("[DirettaRenderer] ✓ Gapless mode: " 
                   << (m_config.gaplessEnabled ? "ENABLED" : "DISABLED"));
         
+        // ⭐ Track boundary reached the target: now the controller may show the new track
+        m_direttaOutput->setMarkerCallback([this](const TrackMarker& marker) {
+            // CRITICAL: Update UPnP with new URI and metadata
+            DEBUG_LOG("[DirettaRenderer] 🔔 Notifying UPnP of track change (track "
+                      << marker.trackNumber << (marker.formatChange ? ", format change" : "") << ")");
+            m_upnp->setCurrentURI(marker.uri);
+            m_upnp->setCurrentMetadata(marker.metadata);
+            m_upnp->notifyTrackChange(marker.uri, marker.metadata);
+            m_upnp->notifyStateChange("PLAYING");
+        });
+        
+        // ⭐ Verify target is available by attempting discovery (background).
+        // Configure m_direttaOutput above this point: discovery uses it from now on.
+        m_targetDiscovery = std::async(std::launch::async, [this, startupBegin]() {
+            auto discoveryBegin = std::chrono::steady_clock::now();
+            bool found = m_direttaOutput->verifyTargetAvailable();
+            logStartupPhase("target discovery + MTU", discoveryBegin);
+            
+            if (!found) {
+                std::cerr << "[DirettaRenderer] " << std::endl;
+                std::cerr << "[DirettaRenderer] ══════════════════════════════════════════════════════" << std::endl;
+                std::cerr << "[DirettaRenderer] ❌ FATAL: No Diretta Target available!" << std::endl;
+                std::cerr << "[DirettaRenderer] ══════════════════════════════════════════════════════" << std::endl;
+                std::cerr << "[DirettaRenderer] " << std::endl;
+                std::cerr << "[DirettaRenderer] The renderer cannot start without a Diretta Target." << std::endl;
+                std::cerr << "[DirettaRenderer] " << std::endl;
+                std::cerr << "[DirettaRenderer] Please:" << std::endl;
+                std::cerr << "[DirettaRenderer]   1. Power on your Diretta Target device" << std::endl;
+                std::cerr << "[DirettaRenderer]   2. Ensure it's connected to the same network" << std::endl;
+                std::cerr << "[DirettaRenderer]   3. Check firewall settings" << std::endl;
+                std::cerr << "[DirettaRenderer]   4. Run: ./bin/DirettaRendererUPnP --list-targets" << std::endl;
+                std::cerr << "[DirettaRenderer] " << std::endl;
+                m_startupFailed = true;
+                return false;
+            }
+            
+            std::cout << "[DirettaRenderer] ✓ Diretta Target verified and ready" << std::endl;
+            logStartupPhase("total (target ready)", startupBegin);
+            return true;
+        }).share();
+        
         // Create other components
         UPnPDevice::Config upnpConfig;
         upnpConfig.friendlyName = m_config.name;
@@ -163,6 +227,22 @@ bool DirettaRenderer::start() {
         m_upnp = std::make_unique<UPnPDevice>(upnpConfig);        
         
         m_audioEngine = std::make_unique<AudioEngine>();
+        m_audioEngine->setPrefetchSize(m_config.prefetchMB < 0
+            ? PrefetchIO::WHOLE_TRACK
+            : static_cast<int64_t>(m_config.prefetchMB) * 1024 * 1024);
+        m_audioEngine->setDecodeThreads(m_config.decodeThreads);
+        m_audioEngine->setMemoryPlay(static_cast<size_t>(m_config.memoryPlayMB) * 1024 * 1024,
+                                     m_config.memoryPlayNext);
+        PrefetchIO::setMaxConnections(m_config.httpConnections);
+        StreamIndexCache::setDirectory(m_config.indexCacheDir);
+        if (!m_config.mediaCache.empty()) {
+            MediaCache::configure(m_config.mediaCache == "ram" ? "" : m_config.mediaCache,
+                                  static_cast<int64_t>(m_config.mediaCacheMB) * 1024 * 1024);
+        }
+        MappedFileIO::setEnabled(m_config.mmapInput);
+        PcmCache::configure(m_config.pcmCacheDir, static_cast<int64_t>(m_config.pcmCacheMB) * 1024 * 1024);
+        AudioDecoder::setFixedOutput(static_cast<uint32_t>(m_config.fixedOutputRate),
+                                     static_cast<uint32_t>(m_config.fixedOutputBits));
 
         
         
@@ -238,11 +318,30 @@ m_audioEngine->setAudioCallback(
         // ⭐ Format change detection (works EVEN after close())
         // ═══════════════════════════════════════════════════════════════
         
+        // ⭐ Format change running in the background: the new track is staged
+        if (m_direttaOutput->isReconfiguring()) {
+            if (m_direttaOutput->getPendingFormat() == currentFormat) {
+                if (!m_direttaOutput->sendAudio(buffer.data(), samples)) {
+                    std::cerr << "[Callback] ❌ Failed to send audio" << std::endl;
+                    return false;
+                }
+                return true;
+            }
+            m_direttaOutput->finishFormatChange();
+        }
         
         if (m_direttaOutput->isConnected()) {
             // Case 1: Already connected - check against current connection
             const AudioFormat& connectedFormat = m_direttaOutput->getFormat();
             
+            // ⭐ Warm session kept after Stop: take it over, no reconnect
+            if (m_direttaOutput->isLingering()) {
+                m_direttaOutput->endLinger();
+                if (connectedFormat == currentFormat) {
+                    std::cout << "[Callback] 🔥 Reusing lingering Diretta session (no reconnect)" << std::endl;
+                }
+            }
+            
             if (connectedFormat != currentFormat) {
                 formatChanged = true;
                 
@@ -256,6 +355,18 @@ m_audioEngine->setAudioCallback(
                           << (currentFormat.isDSD ? " DSD" : " PCM") << std::endl;
                 std::cout << "════════════════════════════════════════" << std::endl;
                 
+                // ⭐ Track boundary: the old track plays out and the sink is
+                // reconfigured in the background while the new one is decoded
+                if (m_direttaOutput->beginFormatChange(currentFormat)) {
+                    lastFormat = currentFormat;
+                    hasLastFormat = true;
+                    if (!m_direttaOutput->sendAudio(buffer.data(), samples)) {
+                        std::cerr << "[Callback] ❌ Failed to send audio" << std::endl;
+                        return false;
+                    }
+                    return true;
+                }
+                
                 // ⭐ v1.2.0 Stable: Release callback flag BEFORE long operations
                 {
                     std::lock_guard<std::mutex> lk(m_callbackMutex);
@@ -389,6 +500,12 @@ if (trackInfo.isDSD) {
                 std::cout << "/" << channels << "ch" << std::endl;
             }
             
+            // ⭐ First Play may arrive while startup discovery is still running
+            if (!waitForTargetDiscovery()) {
+                std::cerr << "[DirettaRenderer] ❌ No Diretta Target available" << std::endl;
+                return false;
+            }
+            
             if (!m_direttaOutput->open(format, m_config.bufferSeconds)) {
                 std::cerr << "[DirettaRenderer] ❌ Failed to open Diretta output" << std::endl;
                 return false;
@@ -451,15 +568,57 @@ if (trackInfo.isDSD) {
                     std::cout << "/" << info.channels << "ch" << std::endl;
                 }
                 
-                // CRITICAL: Update UPnP with new URI and metadata
-                DEBUG_LOG("[DirettaRenderer] 🔔 Notifying UPnP of track change");
-                m_upnp->setCurrentURI(uri);
-                m_upnp->setCurrentMetadata(metadata);
-                m_upnp->notifyTrackChange(uri, metadata);
-                m_upnp->notifyStateChange("PLAYING");
+                // ⭐ The previous track is still queued in the output: announce the
+                // change once its last sample has reached the target
+                TrackMarker marker;
+                marker.trackNumber = trackNumber;
+                marker.uri = uri;
+                marker.metadata = metadata;
+                marker.format = AudioFormat(info.sampleRate, info.isDSD ? 1 : info.bitDepth, info.channels);
+                marker.format.isDSD = info.isDSD;
+                marker.formatChange = m_direttaOutput && marker.format != m_direttaOutput->getFormat();
+                
+                if (m_direttaOutput) {
+                    m_direttaOutput->addMarker(std::move(marker));
+                } else {
+                    m_upnp->setCurrentURI(uri);
+                    m_upnp->setCurrentMetadata(metadata);
+                    m_upnp->notifyTrackChange(uri, metadata);
+                    m_upnp->notifyStateChange("PLAYING");
+                }
             }
         );
 
+        // ⭐ Seek: drop audio buffered from the old position, keep the session
+        m_audioEngine->setSeekCallback([this](double seconds) {
+            if (m_direttaOutput && m_direttaOutput->isConnected() && m_direttaOutput->isPlaying()) {
+                std::chrono::steady_clock::time_point requested(
+                    std::chrono::steady_clock::duration(m_seekRequestTicks.load()));
+                m_direttaOutput->flush(requested);
+                DEBUG_LOG("[DirettaRenderer] ✓ Output flushed for seek to " << seconds << "s");
+            }
+        });
+
+        // ⭐ Position from the sink side: audio still queued in the output is not audible
+        m_audioEngine->setOutputDelayCallback([this]() {
+            return m_direttaOutput ? m_direttaOutput->getOutputDelay() : 0.0;
+        });
+
+        // ⭐ Next track needs another format: let the output know early
+        m_audioEngine->setFormatAnnounceCallback([this](const TrackInfo& info) {
+            if (!m_direttaOutput) {
+                return;
+            }
+            AudioFormat format(info.sampleRate, info.isDSD ? 1 : info.bitDepth, info.channels);
+            format.isDSD = info.isDSD;
+            format.isCompressed = info.isCompressed;
+            if (info.isDSD) {
+                format.dsdFormat = (info.dsdSourceFormat == TrackInfo::DSDSourceFormat::DFF)
+                    ? AudioFormat::DSDFormat::DFF : AudioFormat::DSDFormat::DSF;
+            }
+            m_direttaOutput->announceFormat(format);
+        });
+
          m_audioEngine->setTrackEndCallback([this]() {
             DEBUG_LOG("[DirettaRenderer] ✓ Track ended, notifying UPnP controller");
             m_upnp->notifyStateChange("STOPPED");
@@ -531,15 +690,8 @@ callbacks.onSetURI = [this](const std::string& uri, const std::string& metadata)
         // Wait for callback (has 5s timeout built-in, won't deadlock thanks to patch #10)
         waitForCallbackComplete();
 
-        // Stop and close DirettaOutput
-        if (m_direttaOutput) {
-            if (m_direttaOutput->isPlaying()) {
-                m_direttaOutput->stop(true);
-            }
-            if (m_direttaOutput->isConnected()) {
-                m_direttaOutput->close();
-            }
-        }
+        // Stop and close DirettaOutput (or keep it warm, see --linger)
+        stopOutput();
         
         // Notify state change
         m_upnp->notifyStateChange("STOPPED");
@@ -548,6 +700,7 @@ callbacks.onSetURI = [this](const std::string& uri, const std::string& metadata)
     }
     
     // Update URI (still under mutex lock - safe!)
+    m_resumePosition = -1.0;
     this->m_currentURI = uri;
     this->m_currentMetadata = metadata;
     m_audioEngine->setCurrentURI(uri, metadata);
@@ -586,7 +739,14 @@ callbacks.onPlay = [&lastStopTime, this]() {
             // Then AudioEngine
             if (m_audioEngine) {
                 m_audioEngine->play();
+                
+                // Audio discarded at pause: continue from what was actually heard
+                if (m_resumePosition >= 0.0) {
+                    m_seekRequestTicks = std::chrono::steady_clock::now().time_since_epoch().count();
+                    m_audioEngine->seek(m_resumePosition);
+                }
             }
+            m_resumePosition = -1.0;
             
             m_upnp->notifyStateChange("PLAYING");
             DEBUG_LOG("[DirettaRenderer] ✓ Resumed from pause");
@@ -611,7 +771,7 @@ callbacks.onPlay = [&lastStopTime, this]() {
         auto now = std::chrono::steady_clock::now();
         auto timeSinceStop = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastStopTime);
         
-        if (timeSinceStop.count() < 100) {
+        if (timeSinceStop.count() < 100 && !m_direttaOutput->isLingering()) {
             DEBUG_LOG("[DirettaRenderer] ⚠️  Stop was " << timeSinceStop.count() 
                       << "ms ago, adding safety delay");
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -633,12 +793,23 @@ callbacks.onPause = [this]() {
         if (m_audioEngine) {
             DEBUG_LOG("[DirettaRenderer] Pausing AudioEngine...");
             m_audioEngine->pause();  // ⭐ AJOUTER CETTE LIGNE
+            waitForCallbackComplete();
             DEBUG_LOG("[DirettaRenderer] ✓ AudioEngine paused");
         }
         
         if (m_direttaOutput && m_direttaOutput->isPlaying()) {
             DEBUG_LOG("[DirettaRenderer] Pausing DirettaOutput...");
-            m_direttaOutput->pause();
+            double audible = m_audioEngine
+                ? m_audioEngine->getPlaybackPosition().at(std::chrono::steady_clock::now()) : 0.0;
+            // Hold with silence when playback can resume at the audible position
+            m_direttaOutput->pause(!m_audioEngine || m_audioEngine->canSeek());
+            
+            // Buffered audio was dropped: resume at the audible position
+            // (sink side, the discarded audio is not part of it)
+            if (m_direttaOutput->isHolding() && m_audioEngine) {
+                m_resumePosition = audible;
+                DEBUG_LOG("[DirettaRenderer] ✓ Will resume at " << m_resumePosition << "s");
+            }
             DEBUG_LOG("[DirettaRenderer] ✓ DirettaOutput paused");
         }
         
@@ -657,6 +828,7 @@ callbacks.onStop = [&lastStopTime, this]() {
     
     // Record stop time for DAC stabilization delay
     lastStopTime = std::chrono::steady_clock::now();
+    m_resumePosition = -1.0;
     
     try {
         // SYNC: Stop with mutex held, then wait for callback
@@ -674,13 +846,10 @@ callbacks.onStop = [&lastStopTime, this]() {
         m_audioEngine->setCurrentURI(this->m_currentURI, this->m_currentMetadata, true);  // ⭐ AJOUTER true
         DEBUG_LOG("[DirettaRenderer] ✓ Position reset to 0");
     }			        
-        DEBUG_LOG("[DirettaRenderer] Calling DirettaOutput::stop(immediate=true)...");
-        m_direttaOutput->stop(true);
-        DEBUG_LOG("[DirettaRenderer] ✓ DirettaOutput stopped");
-        
-        DEBUG_LOG("[DirettaRenderer] Calling DirettaOutput::close()...");
-        m_direttaOutput->close();
-        DEBUG_LOG("[DirettaRenderer] ✓ DirettaOutput closed");
+        DEBUG_LOG("[DirettaRenderer] Stopping DirettaOutput...");
+        stopOutput();
+        DEBUG_LOG("[DirettaRenderer] ✓ DirettaOutput " 
+                  << (m_direttaOutput->isLingering() ? "lingering" : "closed"));
         
         DEBUG_LOG("[DirettaRenderer] Notifying UPnP state change...");
         m_upnp->notifyStateChange("STOPPED");
@@ -706,8 +875,11 @@ callbacks.onSeek = [this](const std::string& target) {
         double seconds = parseTimeString(target);
         std::cout << "[DirettaRenderer] Parsed time: " << seconds << "s" << std::endl;
         
-        // Seek dans AudioEngine SEULEMENT
-        // Le SDK Diretta se resynchronisera naturellement
+        // Start of the seek-to-sound measurement (see DirettaOutput::flush)
+        m_seekRequestTicks = std::chrono::steady_clock::now().time_since_epoch().count();
+        
+        // Seek dans AudioEngine, le buffer Diretta est vidé
+        // par le seek callback (session conservée)
         if (m_audioEngine) {
             std::cout << "[DirettaRenderer] Seeking AudioEngine..." << std::endl;
             if (!m_audioEngine->seek(seconds)) {
@@ -727,11 +899,14 @@ callbacks.onSeek = [this](const std::string& target) {
 
 m_upnp->setCallbacks(callbacks);       
       
-       // Start UPnP server
+       // Start UPnP server (SSDP advertising begins here)
+        auto upnpBegin = std::chrono::steady_clock::now();
         if (!m_upnp->start()) {
             std::cerr << "[DirettaRenderer] Failed to start UPnP server" << std::endl;
+            m_targetDiscovery.wait();
             return false;
         }
+        logStartupPhase("UPnP init + SSDP", upnpBegin);
         
         DEBUG_LOG("[DirettaRenderer] UPnP Server: " << m_upnp->getDeviceURL());
         DEBUG_LOG("[DirettaRenderer] Device URL: " << m_upnp->getDeviceURL() << "/description.xml");
@@ -743,17 +918,35 @@ m_upnp->setCallbacks(callbacks);
         m_audioThread = std::thread(&DirettaRenderer::audioThreadFunc, this);
         m_positionThread = std::thread(&DirettaRenderer::positionThreadFunc, this);
         
+        logStartupPhase("renderer ready (UPnP side)", startupBegin);
+        
+        // ⭐ Target discovery carries on in the background (not joined here)
         DEBUG_LOG("[DirettaRenderer] ✓ All components started");
         
         return true;
         
     } catch (const std::exception& e) {
         std::cerr << "[DirettaRenderer] Exception during start: " << e.what() << std::endl;
+        if (m_targetDiscovery.valid()) {
+            m_targetDiscovery.wait();
+        }
         stop();
         return false;
     }
 }
 
+bool DirettaRenderer::waitForTargetDiscovery() {
+    if (!m_targetDiscovery.valid()) {
+        return true;
+    }
+    
+    if (m_targetDiscovery.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        std::cout << "[DirettaRenderer] ⏳ Play received during startup, waiting for target discovery..." << std::endl;
+    }
+    
+    return m_targetDiscovery.get();
+}
+
 void DirettaRenderer::stop() {
     if (!m_running) {
         return;
@@ -769,6 +962,11 @@ void DirettaRenderer::stop() {
         m_upnp->notifyStateChange("STOPPED");
     }
     
+    // Startup discovery still uses the output
+    if (m_targetDiscovery.valid()) {
+        m_targetDiscovery.wait();
+    }
+    
     // Stop Diretta output
     if (m_direttaOutput) {
         m_direttaOutput->close();
@@ -796,6 +994,59 @@ void DirettaRenderer::stop() {
 
 
 
+void DirettaRenderer::writeMetrics() {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    
+    if (m_direttaOutput && m_config.cycleAutoTune) {
+        CycleTuneStats cycle = m_direttaOutput->getCycleTuneStats();
+        out << "# HELP diretta_cycle_time_us Cycle time in use (auto-tuned)\n"
+            << "diretta_cycle_time_us " << cycle.cycleTime << "\n"
+            << "diretta_cycle_calculated_us " << cycle.calculatedCycle << "\n"
+            << "diretta_cycle_utilization " << cycle.utilization << "\n"
+            << "diretta_cycle_late_total " << cycle.lateCycles << "\n"
+            << "diretta_cycle_tune_windows " << cycle.windows << "\n"
+            << "diretta_cycle_tune_converged " << (cycle.converged ? 1 : 0) << "\n"
+            << "diretta_cycle_tune_remembered " << (cycle.remembered ? 1 : 0) << "\n";
+    }
+    
+    if (m_direttaOutput) {
+        out << "# HELP diretta_seek_to_sound_ms Last seek request to first new sample at the target\n"
+            << "diretta_seek_to_sound_ms " << m_direttaOutput->getLastSeekToSoundMs() << "\n";
+    }
+    
+    if (m_audioEngine) {
+        InputStats input = m_audioEngine->getInputStats();
+        if (input.prefetch) {
+            const PrefetchIO::Stats& pf = input.prefetchStats;
+            out << "# HELP diretta_input_fill_level HTTP read-ahead ring fill (0..1)\n"
+                << "diretta_input_fill_level " << pf.fillLevel << "\n"
+                << "diretta_input_buffered_bytes " << pf.buffered << "\n"
+                << "diretta_input_throughput_bytes_per_second " << pf.throughput << "\n"
+                << "diretta_input_connections " << pf.connections << "\n"
+                << "diretta_input_stalls_total " << pf.stalls << "\n"
+                << "diretta_input_recoveries_total " << pf.recoveries << "\n"
+                << "diretta_input_recovery_seconds_total " << pf.recoverySeconds << "\n";
+        }
+        out << "# HELP diretta_http_connections_opened_total New TCP connections to media servers\n"
+            << "diretta_http_connections_opened_total " << input.pool.opened << "\n"
+            << "diretta_http_connections_reused_total " << input.pool.reused << "\n";
+    }
+    
+    // Written aside and renamed: readers never see a partial file
+    std::string temp = m_config.metricsFile + ".tmp";
+    std::ofstream file(temp, std::ios::trunc);
+    file << out.str();
+    file.close();
+    if (!file || std::rename(temp.c_str(), m_config.metricsFile.c_str()) != 0) {
+        static bool warned = false;
+        if (!warned) {
+            std::cerr << "[DirettaRenderer] ⚠️  Cannot write metrics to " << m_config.metricsFile << std::endl;
+            warned = true;
+        }
+    }
+}
+
 void DirettaRenderer::upnpThreadFunc() {
     std::cout << "[UPnP Thread] Started" << std::endl;
     
@@ -808,6 +1059,31 @@ void DirettaRenderer::upnpThreadFunc() {
     std::cout << "[UPnP Thread] Stopped" << std::endl;
 }
 
+void DirettaRenderer::stopOutput() {
+    if (!m_direttaOutput) {
+        return;
+    }
+    
+    // Keep the session warm: a following Play in the same format skips
+    // reconnect and DAC stabilization (closed by the audio thread on timeout)
+    if (m_config.lingerSeconds > 0.0f && m_direttaOutput->isPlaying() &&
+        m_direttaOutput->linger()) {
+        auto deadline = std::chrono::steady_clock::now() + 
+            std::chrono::milliseconds(static_cast<int64_t>(m_config.lingerSeconds * 1000.0f));
+        m_lingerDeadlineTicks = deadline.time_since_epoch().count();
+        std::cout << "[DirettaRenderer] 🔥 Keeping Diretta session warm for " 
+                  << m_config.lingerSeconds << "s" << std::endl;
+        return;
+    }
+    
+    if (m_direttaOutput->isPlaying()) {
+        m_direttaOutput->stop(true);
+    }
+    if (m_direttaOutput->isConnected()) {
+        m_direttaOutput->close();
+    }
+}
+
 void DirettaRenderer::audioThreadFunc() {
     DEBUG_LOG("[Audio Thread] Started");
     DEBUG_LOG("[Audio Thread] ⏱️  Precise timing enabled")
@@ -903,6 +1179,25 @@ bool success = m_audioEngine->process(currentSamplesPerCall);
                 failCount = 0;
             }
                    
+        } else if (lastInterval.count() > 0 && m_direttaOutput && m_direttaOutput->isHolding()) {
+            // ⭐ Pause hold / linger: keep the sink fed with silence at the stream rate
+            if (m_direttaOutput->isLingering() &&
+                std::chrono::steady_clock::now().time_since_epoch().count() >= m_lingerDeadlineTicks.load()) {
+                std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+                if (lock.owns_lock() && m_direttaOutput->isLingering()) {
+                    std::cout << "[Audio Thread] ⌛ Linger timeout, closing Diretta session" << std::endl;
+                    m_direttaOutput->stop(true);
+                    m_direttaOutput->close();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                continue;
+            }
+            
+            std::this_thread::sleep_until(nextProcessTime);
+            m_direttaOutput->sendSilence(currentSamplesPerCall);
+            nextProcessTime += lastInterval;
+            
         } else {
             // ← AJOUTER : Log quand en attente
             static int waitCount = 0;
@@ -936,10 +1231,14 @@ void DirettaRenderer::positionThreadFunc() {
         
         auto state = m_audioEngine->getState();
         
-        if (state == AudioEngine::State::PLAYING) {
-            // Récupérer la position actuelle depuis AudioEngine
-            double positionSeconds = m_audioEngine->getPosition();
-            int position = static_cast<int>(positionSeconds);
+        // ⭐ Previous track still playing out: the controller interpolates it to its end
+        bool boundaryPending = m_direttaOutput && m_direttaOutput->hasPendingMarkers();
+        
+        if (state == AudioEngine::State::PLAYING && !boundaryPending) {
+            // ⭐ Audible position (sink side) with its timestamp: GetPositionInfo
+            // interpolates from it between updates
+            PlaybackPosition playback = m_audioEngine->getPlaybackPosition();
+            int position = static_cast<int>(playback.at(std::chrono::steady_clock::now()));
             
             // Récupérer la durée de la piste
             const auto& trackInfo = m_audioEngine->getCurrentTrackInfo();
@@ -949,12 +1248,8 @@ void DirettaRenderer::positionThreadFunc() {
                 duration = trackInfo.duration / trackInfo.sampleRate;
             }
             
-            // Mettre à jour UPnP
-            m_upnp->setCurrentPosition(position);
-            m_upnp->setTrackDuration(duration);
-            
-            // Envoyer événement aux contrôleurs abonnés (mConnect, BubbleUPnP)
-            m_upnp->notifyPositionChange(position, duration);
+            // Mettre à jour UPnP et envoyer événement aux contrôleurs abonnés (mConnect, BubbleUPnP)
+            m_upnp->notifyPlaybackPosition(playback.seconds, playback.queued, playback.timestamp, duration);
             
             // Log périodique (toutes les 10 secondes pour ne pas polluer)
             static int lastLoggedPosition = -10;
@@ -964,6 +1259,10 @@ void DirettaRenderer::positionThreadFunc() {
             }
         }
         
+        if (!m_config.metricsFile.empty()) {
+            writeMetrics();
+        }
+        
         // Mise à jour toutes les secondes (standard UPnP)
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
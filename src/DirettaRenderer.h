@@ -7,6 +7,7 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <future>
 #include <iostream>
 
 // Forward declarations
@@ -22,6 +23,21 @@ public:
         std::string uuid;
         bool gaplessEnabled;
         float bufferSeconds;  // Changed from int to float (v1.0.9)
+        float lingerSeconds;  // Keep session warm after Stop (0 = close immediately)
+        bool seekFlush;       // Drop buffered audio on seek (false = baseline measurement)
+        int prefetchMB;       // HTTP read-ahead ring in MB (0 = off, -1 = whole track)
+        int httpConnections;  // Max parallel range connections per prefetched track (1 = single stream)
+        std::string indexCacheDir;  // Seek index / stream parameter cache (empty = off)
+        std::string mediaCache;     // Track content cache: empty = off, "ram", or disk tier directory
+        int mediaCacheMB;           // Disk tier size cap in MB
+        bool mmapInput;             // Map local files instead of FFmpeg's file protocol
+        std::string pcmCacheDir;    // Decoded-PCM cache directory (empty = off)
+        int pcmCacheMB;             // Decoded-PCM cache size cap in MB
+        int fixedOutputRate;        // Convert all PCM to this rate (0 = native rate)
+        int fixedOutputBits;        // Bit depth of the fixed output (16, 24 or 32)
+        int decodeThreads;    // Decoder workers (1 = single-threaded)
+        int memoryPlayMB;     // Memory play buffer cap per track in MB (0 = off)
+        bool memoryPlayNext;  // Memory play also decodes the next track in full
         int targetIndex;  // -1 = interactive selection, >= 0 = specific target
         TransferMode transferMode;  // ⭐ NEW: Transfer mode setting
      // ⭐ NEW: Advanced Diretta SDK settings
@@ -30,6 +46,12 @@ public:
         int cycleMinTime;    // CycleMinTime
         int infoCycle;       // InfoCycle
         int mtuOverride;     // MTU override (0 = auto)
+        int mtuCeiling;      // Largest MTU tried by path-MTU probing
+        int mtuEchoPort;     // UDP echo responder confirming jumbo sizes (0 = none)
+        bool cycleAutoTune;  // Closed-loop cycle time tuning
+        std::string cycleTuneDir;  // Converged cycle times across restarts (empty = until restart)
+        int targetLatencyMs; // Target/DAC latency past the SDK buffer (position)
+        std::string metricsFile;  // Prometheus text metrics, rewritten every second (empty = off)
     std::string networkInterface;  // Empty = auto-detect       
         Config();
     };
@@ -42,6 +64,11 @@ public:
     
     bool isRunning() const { return m_running; }
     
+    /**
+     * @brief Startup failed after start() returned (no Diretta target found)
+     */
+    bool hasFailed() const { return m_startupFailed; }
+    
 private:
     // UPnP Callbacks
     void onSetURI(const std::string& uri, const std::string& metadata);
@@ -56,14 +83,16 @@ private:
     void upnpThreadFunc();
     void ssdpThreadFunc();
     void positionThreadFunc();  // → NOUVEAU : mise à jour position pour eventing
+    void writeMetrics();        // Position thread: --metrics-file snapshot
     
     // Internal methods
     void updatePosition();
     void handleEOF();
+    void stopOutput();
+    bool waitForTargetDiscovery();
     
     // Configuration
     Config m_config;
-    uint32_t m_networkMTU = 16128;  // ⭐ MTU hardcodé pour performance maximale
     
     // Components
     std::unique_ptr<UPnPDevice> m_upnp;
@@ -78,8 +107,17 @@ private:
     
     // State
     std::atomic<bool> m_running;
+    std::atomic<bool> m_startupFailed{false};  // Background target discovery found nothing
     std::mutex m_mutex;
     
+    // ⭐ Target discovery runs in parallel with UPnP startup
+    std::shared_future<bool> m_targetDiscovery;
+    
+    // Seek / pause without tearing down the Diretta session
+    std::atomic<int64_t> m_seekRequestTicks{0};  // steady_clock ticks of last seek request
+    double m_resumePosition = -1.0;              // Audible position at pause (-1 = none)
+    std::atomic<int64_t> m_lingerDeadlineTicks{0};  // steady_clock ticks, session closes after
+    
     // Gapless
     std::string m_currentURI;
     std::string m_currentMetadata;
@@ -0,0 +1,159 @@
+#ifndef DSD_KERNELS_H
+#define DSD_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief DSD → sink layout in one pass
+ *
+ * The sink takes 32-bit groups per channel interleaved by channel
+ * ([L0..L3][R0..R3]...), LSB first. These kernels build that layout from
+ * stereo planar (DSF blocks, FFmpeg planar packets) or byte-interleaved
+ * (DFF) input and fold in the MSB→LSB bit reversal when asked, so the
+ * data is touched once. bytesPerChannel must be a multiple of 4.
+ *
+ * SSE2 / SSSE3 / NEON where the build has them, scalar tail and fallback.
+ */
+namespace DsdKernels {
+
+inline uint8_t reverseByte(uint8_t v) {
+    v = static_cast<uint8_t>(((v >> 1) & 0x55) | ((v & 0x55) << 1));
+    v = static_cast<uint8_t>(((v >> 2) & 0x33) | ((v & 0x33) << 2));
+    return static_cast<uint8_t>((v >> 4) | (v << 4));
+}
+
+#if defined(__SSSE3__)
+inline __m128i reverse16(__m128i v) {
+    // Nibble lookup: reverse each nibble, swap them
+    const __m128i table = _mm_setr_epi8(0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+                                        0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF);
+    const __m128i low = _mm_set1_epi8(0x0F);
+    __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(v, low));
+    __m128i hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), low));
+    return _mm_or_si128(_mm_slli_epi16(lo, 4), hi);
+}
+#elif defined(__SSE2__)
+inline __m128i reverse16(__m128i v) {
+    // Swap bits, pairs, nibbles; the byte masks keep 16-bit shifts inside each byte
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 1), m1), _mm_slli_epi16(_mm_and_si128(v, m1), 1));
+    v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 2), m2), _mm_slli_epi16(_mm_and_si128(v, m2), 2));
+    return _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 4), m4), _mm_slli_epi16(_mm_and_si128(v, m4), 4));
+}
+#endif
+
+/**
+ * @brief In-place bit reversal (any layout)
+ */
+inline void reverseBits(uint8_t* data, size_t size) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), reverse16(v));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= size; i += 16) {
+        vst1q_u8(data + i, vrbitq_u8(vld1q_u8(data + i)));
+    }
+#endif
+    for (; i < size; i++) {
+        data[i] = reverseByte(data[i]);
+    }
+}
+
+/**
+ * @brief Two planes → 32-bit groups interleaved
+ */
+template <bool Reverse>
+inline void planarStereo(const uint8_t* left, const uint8_t* right, uint8_t* out, size_t bytesPerChannel) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= bytesPerChannel; i += 16) {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+        if (Reverse) {
+            l = reverse16(l);
+            r = reverse16(r);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi32(l, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi32(l, r));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= bytesPerChannel; i += 16) {
+        uint8x16_t l = vld1q_u8(left + i);
+        uint8x16_t r = vld1q_u8(right + i);
+        if (Reverse) {
+            l = vrbitq_u8(l);
+            r = vrbitq_u8(r);
+        }
+        uint32x4x2_t v = { { vreinterpretq_u32_u8(l), vreinterpretq_u32_u8(r) } };
+        vst2q_u32(reinterpret_cast<uint32_t*>(out + i * 2), v);
+    }
+#endif
+    for (; i < bytesPerChannel; i += 4) {
+        for (size_t b = 0; b < 4; b++) {
+            out[i * 2 + b]     = Reverse ? reverseByte(left[i + b]) : left[i + b];
+            out[i * 2 + 4 + b] = Reverse ? reverseByte(right[i + b]) : right[i + b];
+        }
+    }
+}
+
+/**
+ * @brief Byte-interleaved stereo (L R L R ..., DFF) → 32-bit groups interleaved
+ */
+template <bool Reverse>
+inline void byteInterleavedStereo(const uint8_t* src, uint8_t* out, size_t bytesPerChannel) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i evenMask = _mm_set1_epi16(0x00FF);
+    for (; i + 16 <= bytesPerChannel; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2 + 16));
+        // Even bytes are left, odd bytes are right
+        __m128i l = _mm_packus_epi16(_mm_and_si128(a, evenMask), _mm_and_si128(b, evenMask));
+        __m128i r = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        if (Reverse) {
+            l = reverse16(l);
+            r = reverse16(r);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi32(l, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi32(l, r));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= bytesPerChannel; i += 16) {
+        uint8x16x2_t lr = vld2q_u8(src + i * 2);
+        if (Reverse) {
+            lr.val[0] = vrbitq_u8(lr.val[0]);
+            lr.val[1] = vrbitq_u8(lr.val[1]);
+        }
+        uint32x4x2_t v = { { vreinterpretq_u32_u8(lr.val[0]), vreinterpretq_u32_u8(lr.val[1]) } };
+        vst2q_u32(reinterpret_cast<uint32_t*>(out + i * 2), v);
+    }
+#endif
+    for (; i < bytesPerChannel; i += 4) {
+        for (size_t b = 0; b < 4; b++) {
+            uint8_t l = src[(i + b) * 2];
+            uint8_t r = src[(i + b) * 2 + 1];
+            out[i * 2 + b]     = Reverse ? reverseByte(l) : l;
+            out[i * 2 + 4 + b] = Reverse ? reverseByte(r) : r;
+        }
+    }
+}
+
+} // namespace DsdKernels
+
+#endif // DSD_KERNELS_H
@@ -0,0 +1,342 @@
+#include "DsdReader.h"
+#include "DsdKernels.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+
+uint32_t le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t le64(const uint8_t* p) {
+    return le32(p) | (static_cast<uint64_t>(le32(p + 4)) << 32);
+}
+
+uint16_t be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+uint64_t be64(const uint8_t* p) {
+    return (static_cast<uint64_t>(be32(p)) << 32) | be32(p + 4);
+}
+
+} // namespace
+
+DsdReader::DsdReader()
+    : m_io(nullptr)
+    , m_container(Container::DSF)
+    , m_sampleRate(0)
+    , m_channels(0)
+    , m_totalSamples(0)
+    , m_msbFirst(false)
+    , m_dataOffset(0)
+    , m_bytesPerChannel(0)
+    , m_blockSize(0)
+    , m_valid(0)
+    , m_pos(0)
+    , m_nextByte(0)
+    , m_eof(false)
+{
+}
+
+bool DsdReader::open(AVIOContext* io) {
+    m_io = io;
+
+    if (avio_seek(m_io, 0, SEEK_SET) < 0) {
+        std::cerr << "[DsdReader] ⚠️  Input not seekable" << std::endl;
+        return false;
+    }
+
+    uint8_t magic[4];
+    if (!readExact(magic, sizeof(magic))) {
+        return false;
+    }
+
+    bool ok;
+    if (std::memcmp(magic, "DSD ", 4) == 0) {
+        m_container = Container::DSF;
+        ok = parseDSF();
+    } else if (std::memcmp(magic, "FRM8", 4) == 0) {
+        m_container = Container::DFF;
+        ok = parseDFF();
+    } else {
+        DEBUG_LOG("[DsdReader] Not a DSF/DFF header");
+        return false;
+    }
+
+    if (!ok || m_channels == 0 || m_sampleRate == 0 || m_bytesPerChannel == 0) {
+        return false;
+    }
+
+    if (m_container == Container::DSF) {
+        m_data.resize(static_cast<size_t>(m_blockSize) * m_channels);
+    } else {
+        m_data.resize(DFF_READ_PER_CHANNEL * m_channels);
+    }
+
+    DEBUG_LOG("[DsdReader] ✓ " << (m_container == Container::DSF ? "DSF" : "DFF")
+              << " DSD" << (m_sampleRate / 44100) << ", " << m_channels << "ch, "
+              << (m_totalSamples / m_sampleRate) << "s, data at " << m_dataOffset
+              << (m_msbFirst ? ", MSB first" : ", LSB first"));
+
+    return seek(0.0);
+}
+
+bool DsdReader::parseDSF() {
+    // "DSD " chunk: size(8) totalFileSize(8) metadataPointer(8)
+    uint8_t dsd[24];
+    if (!readExact(dsd, sizeof(dsd))) {
+        return false;
+    }
+    uint64_t dsdChunkSize = le64(dsd);
+
+    // "fmt " chunk
+    if (avio_seek(m_io, static_cast<int64_t>(dsdChunkSize), SEEK_SET) < 0) {
+        return false;
+    }
+    uint8_t fmt[52];
+    if (!readExact(fmt, sizeof(fmt)) || std::memcmp(fmt, "fmt ", 4) != 0) {
+        std::cerr << "[DsdReader] ⚠️  DSF: fmt chunk missing" << std::endl;
+        return false;
+    }
+    uint64_t fmtChunkSize = le64(fmt + 4);
+    m_channels = le32(fmt + 24);
+    m_sampleRate = le32(fmt + 28);
+    uint32_t bitsPerSample = le32(fmt + 32);
+    m_totalSamples = le64(fmt + 36);
+    m_blockSize = le32(fmt + 44);
+
+    // bitsPerSample 1 = LSB first (the usual), 8 = MSB first
+    m_msbFirst = (bitsPerSample == 8);
+
+    if (m_blockSize == 0 || m_blockSize % 4 != 0) {
+        std::cerr << "[DsdReader] ⚠️  DSF: unsupported block size " << m_blockSize << std::endl;
+        return false;
+    }
+
+    // "data" chunk: id(4) size(8), payload follows
+    int64_t dataChunk = static_cast<int64_t>(dsdChunkSize + fmtChunkSize);
+    if (avio_seek(m_io, dataChunk, SEEK_SET) < 0) {
+        return false;
+    }
+    uint8_t data[12];
+    if (!readExact(data, sizeof(data)) || std::memcmp(data, "data", 4) != 0) {
+        std::cerr << "[DsdReader] ⚠️  DSF: data chunk missing" << std::endl;
+        return false;
+    }
+
+    m_dataOffset = dataChunk + 12;
+    m_bytesPerChannel = (m_totalSamples + 7) / 8;
+    return true;
+}
+
+bool DsdReader::parseDFF() {
+    // FRM8: size(8) formType(4)
+    uint8_t frm[12];
+    if (!readExact(frm, sizeof(frm)) || std::memcmp(frm + 8, "DSD ", 4) != 0) {
+        std::cerr << "[DsdReader] ⚠️  DFF: not a DSD form" << std::endl;
+        return false;
+    }
+    int64_t formEnd = 12 + static_cast<int64_t>(be64(frm));
+    int64_t pos = 16;
+
+    // Top-level chunks: FVER, PROP (FS, CHNL, CMPR...), DSD or DST, ...
+    while (pos + 12 <= formEnd) {
+        uint8_t header[12];
+        if (avio_seek(m_io, pos, SEEK_SET) < 0 || !readExact(header, sizeof(header))) {
+            return false;
+        }
+        uint64_t size = be64(header + 4);
+        int64_t body = pos + 12;
+
+        if (std::memcmp(header, "PROP", 4) == 0) {
+            uint8_t propType[4];
+            if (!readExact(propType, sizeof(propType)) || std::memcmp(propType, "SND ", 4) != 0) {
+                return false;
+            }
+
+            int64_t sub = body + 4;
+            int64_t propEnd = body + static_cast<int64_t>(size);
+            while (sub + 12 <= propEnd) {
+                uint8_t subHeader[12];
+                if (avio_seek(m_io, sub, SEEK_SET) < 0 || !readExact(subHeader, sizeof(subHeader))) {
+                    return false;
+                }
+                uint64_t subSize = be64(subHeader + 4);
+                uint8_t value[4];
+
+                if (std::memcmp(subHeader, "FS  ", 4) == 0 && readExact(value, 4)) {
+                    m_sampleRate = be32(value);
+                } else if (std::memcmp(subHeader, "CHNL", 4) == 0 && readExact(value, 2)) {
+                    m_channels = be16(value);
+                } else if (std::memcmp(subHeader, "CMPR", 4) == 0 && readExact(value, 4)) {
+                    if (std::memcmp(value, "DSD ", 4) != 0) {
+                        DEBUG_LOG("[DsdReader] DFF: compressed (DST), not handled natively");
+                        return false;
+                    }
+                }
+                sub += 12 + static_cast<int64_t>(subSize + (subSize & 1));
+            }
+        } else if (std::memcmp(header, "DSD ", 4) == 0) {
+            if (m_channels == 0) {
+                return false;
+            }
+            m_dataOffset = body;
+            m_bytesPerChannel = size / m_channels;
+            m_totalSamples = m_bytesPerChannel * 8;
+            m_msbFirst = true;   // DSDIFF is always MSB first
+            return true;
+        } else if (std::memcmp(header, "DST ", 4) == 0) {
+            return false;
+        }
+
+        // Chunks are padded to an even size
+        pos = body + static_cast<int64_t>(size + (size & 1));
+    }
+
+    std::cerr << "[DsdReader] ⚠️  DFF: DSD chunk missing" << std::endl;
+    return false;
+}
+
+bool DsdReader::readExact(uint8_t* buf, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        int n = avio_read(m_io, buf + done, static_cast<int>(size - done));
+        if (n <= 0) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+bool DsdReader::seek(double seconds) {
+    uint64_t sample = (seconds > 0.0) ? static_cast<uint64_t>(seconds * m_sampleRate) : 0;
+    uint64_t byte = std::min<uint64_t>(sample / 8, m_bytesPerChannel) & ~static_cast<uint64_t>(3);
+
+    // DSF: start of the block group holding the byte; DFF: the frame itself
+    uint64_t fillStart = (m_container == Container::DSF) ? byte - (byte % m_blockSize) : byte;
+    int64_t offset = m_dataOffset + static_cast<int64_t>(fillStart * m_channels);
+
+    if (!m_file && avio_seek(m_io, offset, SEEK_SET) < 0) {
+        std::cerr << "[DsdReader] ⚠️  Seek to byte " << offset << " failed" << std::endl;
+        return false;
+    }
+
+    m_nextByte = fillStart;
+    m_valid = 0;
+    m_pos = 0;
+    m_eof = false;
+
+    // Skip to the group within the block
+    if (byte > fillStart) {
+        if (!fillBuffer()) {
+            return false;
+        }
+        m_pos = static_cast<size_t>(byte - fillStart);
+    }
+
+    return true;
+}
+
+bool DsdReader::fillBuffer() {
+    if (m_nextByte >= m_bytesPerChannel) {
+        m_eof = true;
+        return false;
+    }
+
+    size_t perChannel = (m_container == Container::DSF) ? m_blockSize : DFF_READ_PER_CHANNEL;
+    size_t valid = static_cast<size_t>(std::min<uint64_t>(perChannel, m_bytesPerChannel - m_nextByte));
+
+    // DSF blocks are always full on disk (the last one is zero-padded)
+    size_t toRead = (m_container == Container::DSF) ? m_data.size() : valid * m_channels;
+    
+    // ⭐ Mapped file: interleave straight from the page cache
+    if (m_file) {
+        m_block = m_file->span(m_dataOffset + static_cast<int64_t>(m_nextByte * m_channels), toRead);
+        if (!m_block) {
+            std::cerr << "[DsdReader] ⚠️  File ends before byte " << m_nextByte << " per channel" << std::endl;
+            m_eof = true;
+            return false;
+        }
+    } else if (readExact(m_data.data(), toRead)) {
+        m_block = m_data.data();
+    } else {
+        std::cerr << "[DsdReader] ⚠️  Read error at byte " << m_nextByte << " per channel" << std::endl;
+        m_eof = true;
+        return false;
+    }
+
+    m_valid = valid;
+    m_pos = 0;
+    m_nextByte += perChannel;
+    return true;
+}
+
+void DsdReader::interleave(uint8_t* out, size_t bytesPerChannel) const {
+    // ⭐ Stereo, whole groups: fused SIMD interleave + bit reversal
+    if (m_channels == 2 && bytesPerChannel % 4 == 0 && m_pos + bytesPerChannel <= m_valid) {
+        const uint8_t* data = m_block;
+        if (m_container == Container::DSF) {
+            const uint8_t* left = data + m_pos;
+            const uint8_t* right = data + m_blockSize + m_pos;
+            m_msbFirst ? DsdKernels::planarStereo<true>(left, right, out, bytesPerChannel)
+                       : DsdKernels::planarStereo<false>(left, right, out, bytesPerChannel);
+        } else {
+            const uint8_t* src = data + m_pos * 2;
+            m_msbFirst ? DsdKernels::byteInterleavedStereo<true>(src, out, bytesPerChannel)
+                       : DsdKernels::byteInterleavedStereo<false>(src, out, bytesPerChannel);
+        }
+        return;
+    }
+
+    size_t stride = (m_container == Container::DSF) ? m_blockSize : 1;
+    size_t step = (m_container == Container::DSF) ? 1 : m_channels;
+
+    for (size_t group = 0; group < bytesPerChannel; group += 4) {
+        for (uint32_t ch = 0; ch < m_channels; ch++) {
+            // DSF: channel blocks one after the other; DFF: channels interleaved per byte
+            const uint8_t* src = m_block + ch * stride + (m_pos + group) * step;
+            for (size_t b = 0; b < 4; b++) {
+                if (m_pos + group + b < m_valid) {
+                    uint8_t v = src[b * step];
+                    *out++ = m_msbFirst ? DsdKernels::reverseByte(v) : v;
+                } else {
+                    *out++ = SILENCE;
+                }
+            }
+        }
+    }
+}
+
+size_t DsdReader::read(uint8_t* out, size_t bytesPerChannel) {
+    bytesPerChannel &= ~static_cast<size_t>(3);
+    size_t written = 0;
+
+    while (written < bytesPerChannel) {
+        if (m_pos >= m_valid && !fillBuffer()) {
+            break;
+        }
+
+        size_t n = std::min(bytesPerChannel - written, m_valid - m_pos);
+        interleave(out + written * m_channels, n);
+
+        // A short tail is padded to a whole group
+        size_t groupBytes = (n + 3) & ~static_cast<size_t>(3);
+        written += groupBytes;
+        m_pos += groupBytes;
+    }
+
+    return written;
+}
@@ -0,0 +1,98 @@
+#ifndef DSD_READER_H
+#define DSD_READER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "MappedFileIO.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief Native DSF / DSDIFF (DFF) reader
+ *
+ * Parses the container header itself and reads the DSD payload straight
+ * from an AVIOContext (local file, FFmpeg HTTP or PrefetchIO). Output is
+ * the sink layout: 32-bit groups per channel, interleaved by channel
+ * ([L0..L3][R0..R3]...), LSB-first bit order. DSF channel blocks and DFF
+ * byte-interleaved frames are converted in a single pass.
+ *
+ * Seeks go straight to the block (DSF) or frame (DFF) that holds the
+ * target sample, so over HTTP a seek costs one Range request.
+ *
+ * With a mapped local file, blocks are interleaved straight out of the
+ * mapping: no AVIO buffer and no copy into the block buffer.
+ */
+class DsdReader {
+public:
+    enum class Container { DSF, DFF };
+
+    static constexpr uint8_t SILENCE = 0x69;            // DSD idle pattern
+    static constexpr size_t DFF_READ_PER_CHANNEL = 16384; // Bytes per channel per DFF read
+
+    DsdReader();
+
+    /**
+     * @brief Parse the header and position at the start of the audio data
+     * @param io Seekable input (not owned, must outlive the reader)
+     * @return true for uncompressed DSF/DFF (DST-compressed DFF is rejected)
+     */
+    bool open(AVIOContext* io);
+
+    /**
+     * @brief Read the payload from the mapping instead of io (not owned, must outlive the reader)
+     */
+    void setMapping(MappedFileIO* file) { m_file = file; }
+
+    /**
+     * @brief Read interleaved DSD in sink layout
+     * @param out Output, bytesPerChannel × channels bytes
+     * @param bytesPerChannel Bytes wanted per channel (rounded down to 4)
+     * @return Bytes written per channel; less than asked only at the end
+     *         (the last group is padded with silence) or on a read error
+     */
+    size_t read(uint8_t* out, size_t bytesPerChannel);
+
+    /**
+     * @brief Jump to the group holding the sample at `seconds`
+     */
+    bool seek(double seconds);
+
+    Container container() const { return m_container; }
+    uint32_t sampleRate() const { return m_sampleRate; }   // DSD bit rate (2822400 for DSD64)
+    uint32_t channels() const { return m_channels; }
+    uint64_t totalSamples() const { return m_totalSamples; } // Per channel
+    bool isEOF() const { return m_eof; }
+
+private:
+    bool parseDSF();
+    bool parseDFF();
+    bool readExact(uint8_t* buf, size_t size);
+    bool fillBuffer();
+    void interleave(uint8_t* out, size_t bytesPerChannel) const;
+
+    AVIOContext* m_io;
+    MappedFileIO* m_file = nullptr;   // Zero-copy payload source, if set
+    Container m_container;
+    uint32_t m_sampleRate;
+    uint32_t m_channels;
+    uint64_t m_totalSamples;
+    bool m_msbFirst;                  // Needs bit reversal for the sink
+
+    int64_t m_dataOffset;             // First payload byte in the file
+    uint64_t m_bytesPerChannel;       // Payload per channel (DSF: without block padding)
+    uint32_t m_blockSize;             // DSF: bytes per channel block
+
+    // Current buffer: one DSF block group or one DFF read
+    std::vector<uint8_t> m_data;
+    const uint8_t* m_block = nullptr; // Current buffer: m_data, or a span of the mapping
+    size_t m_valid;                   // Valid bytes per channel in m_data
+    size_t m_pos;                     // Consumed bytes per channel in m_data
+    uint64_t m_nextByte;              // Per-channel byte index of the next fill
+    bool m_eof;
+};
+
+#endif // DSD_READER_H
@@ -0,0 +1,634 @@
+#include "HttpClient.h"
+
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+
+const size_t RECV_SIZE = 64 * 1024;
+const size_t MAX_HEADER_SIZE = 64 * 1024;
+const int POLL_SLICE_MS = 100;   // Interrupt check granularity
+
+struct IdleConnection {
+    int fd;
+    std::chrono::steady_clock::time_point since;
+};
+
+std::mutex s_poolMutex;
+std::map<std::string, std::vector<IdleConnection>> s_idle;
+HttpConnectionPool::Stats s_poolStats;
+
+std::string poolKey(const std::string& host, uint16_t port) {
+    return host + ":" + std::to_string(port);
+}
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+// ============================================================================
+// HttpConnectionPool
+// ============================================================================
+
+int HttpConnectionPool::acquire(const std::string& host, uint16_t port) {
+    std::lock_guard<std::mutex> lock(s_poolMutex);
+
+    auto it = s_idle.find(poolKey(host, port));
+    if (it == s_idle.end()) {
+        return -1;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto& idle = it->second;
+
+    while (!idle.empty()) {
+        IdleConnection conn = idle.back();
+        idle.pop_back();
+
+        if (now - conn.since > std::chrono::seconds(IDLE_TIMEOUT_S)) {
+            ::close(conn.fd);
+            continue;
+        }
+
+        // Still open? A closed (or chatty) socket is readable, a healthy idle one is not
+        char probe;
+        ssize_t rc = ::recv(conn.fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (rc < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            s_poolStats.reused++;
+            return conn.fd;
+        }
+        ::close(conn.fd);
+    }
+
+    return -1;
+}
+
+void HttpConnectionPool::release(const std::string& host, uint16_t port, int fd) {
+    std::lock_guard<std::mutex> lock(s_poolMutex);
+
+    auto& idle = s_idle[poolKey(host, port)];
+    if (static_cast<int>(idle.size()) >= MAX_IDLE_PER_HOST) {
+        ::close(idle.front().fd);
+        idle.erase(idle.begin());
+    }
+    idle.push_back({fd, std::chrono::steady_clock::now()});
+}
+
+void HttpConnectionPool::countOpened() {
+    std::lock_guard<std::mutex> lock(s_poolMutex);
+    s_poolStats.opened++;
+}
+
+HttpConnectionPool::Stats HttpConnectionPool::getStats() {
+    std::lock_guard<std::mutex> lock(s_poolMutex);
+    return s_poolStats;
+}
+
+// ============================================================================
+// HttpStream
+// ============================================================================
+
+HttpStream::HttpStream() {
+}
+
+HttpStream::~HttpStream() {
+    close();
+}
+
+bool HttpStream::parseURL(const std::string& url, std::string& host, uint16_t& port, std::string& path) {
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0) {
+        return false;
+    }
+
+    std::string rest = url.substr(scheme.size());
+    size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    path = (slash == std::string::npos) ? "/" : rest.substr(slash);
+
+    // Drop userinfo
+    size_t at = authority.rfind('@');
+    if (at != std::string::npos) {
+        authority = authority.substr(at + 1);
+    }
+
+    port = 80;
+    std::string portStr;
+    if (!authority.empty() && authority[0] == '[') {
+        size_t end = authority.find(']');
+        if (end == std::string::npos) {
+            return false;
+        }
+        host = authority.substr(1, end - 1);
+        if (end + 1 < authority.size() && authority[end + 1] == ':') {
+            portStr = authority.substr(end + 2);
+        }
+    } else {
+        size_t colon = authority.find(':');
+        host = authority.substr(0, colon);
+        if (colon != std::string::npos) {
+            portStr = authority.substr(colon + 1);
+        }
+    }
+
+    if (!portStr.empty()) {
+        int p = std::atoi(portStr.c_str());
+        if (p <= 0 || p > 65535) {
+            return false;
+        }
+        port = static_cast<uint16_t>(p);
+    }
+
+    return !host.empty();
+}
+
+bool HttpStream::open(const std::string& url, int64_t offset, int64_t end) {
+    std::string target = url;
+    m_rangeEnd = (end > offset) ? end : -1;
+
+    for (int redirects = 0; redirects <= MAX_REDIRECTS; redirects++) {
+        std::string location;
+        if (!request(target, offset, location)) {
+            return false;
+        }
+        if (location.empty()) {
+            return true;
+        }
+
+        // Relative redirect: keep scheme and authority
+        if (location[0] == '/') {
+            size_t authorityEnd = target.find('/', 7);
+            location = target.substr(0, authorityEnd) + location;
+        }
+
+        DEBUG_LOG("[HttpClient] ↪️  Redirect " << m_status << " → " << location.substr(0, 80));
+        target = location;
+    }
+
+    std::cerr << "[HttpClient] ❌ Too many redirects: " << url.substr(0, 80) << std::endl;
+    close();
+    return false;
+}
+
+bool HttpStream::request(const std::string& url, int64_t offset, std::string& redirect) {
+    close();
+
+    std::string host;
+    uint16_t port;
+    std::string path;
+    if (!parseURL(url, host, port, path)) {
+        return false;
+    }
+
+    m_url = url;
+    m_host = host;
+    m_port = port;
+    m_position = offset;
+
+    std::string hostHeader = (host.find(':') != std::string::npos) ? "[" + host + "]" : host;
+    if (port != 80) {
+        hostHeader += ":" + std::to_string(port);
+    }
+
+    std::string req = "GET " + path + " HTTP/1.1\r\n"
+                      "Host: " + hostHeader + "\r\n"
+                      "User-Agent: DirettaRenderer/1.0\r\n"
+                      "Accept: */*\r\n"
+                      "Connection: keep-alive\r\n"
+                      "Range: bytes=" + std::to_string(offset) + "-" +
+                      (m_rangeEnd > 0 ? std::to_string(m_rangeEnd - 1) : std::string()) + "\r\n"
+                      "\r\n";
+
+    std::string headers;
+    bool sent = false;
+
+    // A pooled connection may have been closed by the server in the
+    // meantime: retry once on a fresh one
+    for (int attempt = 0; attempt < 2 && !sent; attempt++) {
+        m_fd = (attempt == 0) ? HttpConnectionPool::acquire(host, port) : -1;
+        m_reused = (m_fd >= 0);
+
+        if (m_fd < 0) {
+            addrinfo hints;
+            std::memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            addrinfo* res = nullptr;
+            std::string service = std::to_string(port);
+            if (getaddrinfo(host.c_str(), service.c_str(), &hints, &res) != 0) {
+                std::cerr << "[HttpClient] ❌ Cannot resolve " << host << std::endl;
+                return false;
+            }
+
+            for (addrinfo* ai = res; ai && m_fd < 0; ai = ai->ai_next) {
+                m_fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (m_fd < 0) {
+                    continue;
+                }
+
+                int rc = ::connect(m_fd, ai->ai_addr, ai->ai_addrlen);
+                if (rc < 0 && errno == EINPROGRESS && waitFor(POLLOUT)) {
+                    int err = 0;
+                    socklen_t len = sizeof(err);
+                    getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                    rc = (err == 0) ? 0 : -1;
+                }
+
+                if (rc < 0) {
+                    ::close(m_fd);
+                    m_fd = -1;
+                }
+            }
+            freeaddrinfo(res);
+
+            if (m_fd < 0) {
+                std::cerr << "[HttpClient] ❌ Cannot connect to " << host << ":" << port << std::endl;
+                return false;
+            }
+
+            int one = 1;
+            setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            HttpConnectionPool::countOpened();
+        }
+
+        sent = sendAll(req) && readHeaders(headers);
+        if (!sent) {
+            dropConnection();
+            if (!m_reused || (m_interrupt && m_interrupt())) {
+                std::cerr << "[HttpClient] ❌ No response from " << host << ":" << port << std::endl;
+                return false;
+            }
+        }
+    }
+
+    if (!sent) {
+        return false;
+    }
+
+    // Status line
+    size_t lineEnd = headers.find("\r\n");
+    std::string statusLine = headers.substr(0, lineEnd);
+    size_t sp = statusLine.find(' ');
+    if (statusLine.compare(0, 5, "HTTP/") != 0 || sp == std::string::npos) {
+        std::cerr << "[HttpClient] ❌ Bad response: " << statusLine.substr(0, 40) << std::endl;
+        dropConnection();
+        return false;
+    }
+    m_status = std::atoi(statusLine.c_str() + sp + 1);
+    m_keepAlive = (statusLine.compare(0, 8, "HTTP/1.0") != 0);
+
+    // Header fields
+    int64_t contentLength = -1;
+    std::string contentRange;
+    std::string location;
+    m_chunked = false;
+    m_etag.clear();
+    m_lastModified.clear();
+    m_acceptRanges = false;
+
+    size_t pos = lineEnd + 2;
+    while (pos < headers.size()) {
+        size_t end = headers.find("\r\n", pos);
+        if (end == std::string::npos || end == pos) {
+            break;
+        }
+        std::string line = headers.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = toLower(trim(line.substr(0, colon)));
+        std::string value = trim(line.substr(colon + 1));
+
+        if (name == "content-length") {
+            contentLength = std::strtoll(value.c_str(), nullptr, 10);
+        } else if (name == "content-range") {
+            contentRange = value;
+        } else if (name == "transfer-encoding") {
+            m_chunked = (toLower(value).find("chunked") != std::string::npos);
+        } else if (name == "connection") {
+            std::string v = toLower(value);
+            if (v.find("close") != std::string::npos) {
+                m_keepAlive = false;
+            } else if (v.find("keep-alive") != std::string::npos) {
+                m_keepAlive = true;
+            }
+        } else if (name == "location") {
+            location = value;
+        } else if (name == "etag") {
+            m_etag = value;
+        } else if (name == "last-modified") {
+            m_lastModified = value;
+        } else if (name == "accept-ranges") {
+            m_acceptRanges = (toLower(value).find("bytes") != std::string::npos);
+        }
+    }
+
+    m_remaining = m_chunked ? 0 : contentLength;
+    m_bodyDone = false;
+
+    if (m_status >= 300 && m_status < 400 && !location.empty()) {
+        dropConnection();
+        redirect = location;
+        return true;
+    }
+
+    // "bytes first-last/total" or "bytes */total"
+    int64_t rangeTotal = -1;
+    size_t slash = contentRange.find('/');
+    if (slash != std::string::npos && contentRange[slash + 1] != '*') {
+        rangeTotal = std::strtoll(contentRange.c_str() + slash + 1, nullptr, 10);
+    }
+
+    if (m_status == 206) {
+        m_totalSize = rangeTotal;
+        size_t digits = contentRange.find_first_of("0123456789");
+        if (digits != std::string::npos) {
+            m_position = std::strtoll(contentRange.c_str() + digits, nullptr, 10);
+        }
+    } else if (m_status == 200) {
+        m_totalSize = contentLength;
+        m_position = 0;
+
+        // Range ignored by the server: skip up to the offset
+        std::vector<uint8_t> skip(RECV_SIZE);
+        while (m_position < offset) {
+            int n = read(skip.data(), static_cast<int>(std::min<int64_t>(skip.size(), offset - m_position)));
+            if (n <= 0) {
+                dropConnection();
+                return false;
+            }
+        }
+    } else if (m_status == 416) {
+        // Offset at or past the end
+        m_totalSize = rangeTotal;
+        m_position = offset;
+        dropConnection();
+        m_bodyDone = true;
+    } else {
+        std::cerr << "[HttpClient] ❌ HTTP " << m_status << " for " << url.substr(0, 80) << std::endl;
+        dropConnection();
+        return false;
+    }
+
+    DEBUG_LOG("[HttpClient] GET " << host << ":" << port << " @" << offset
+              << (m_reused ? " (reused connection)" : " (new connection)"));
+    return true;
+}
+
+bool HttpStream::readHeaders(std::string& headers) {
+    m_pending.clear();
+    m_pendingPos = 0;
+
+    std::vector<uint8_t> buf(RECV_SIZE);
+    std::string data;
+
+    while (data.size() < MAX_HEADER_SIZE) {
+        if (!waitFor(POLLIN)) {
+            return false;
+        }
+        ssize_t n = ::recv(m_fd, buf.data(), buf.size(), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+
+        size_t searchFrom = data.size() > 3 ? data.size() - 3 : 0;
+        data.append(reinterpret_cast<char*>(buf.data()), n);
+
+        size_t end = data.find("\r\n\r\n", searchFrom);
+        if (end != std::string::npos) {
+            headers = data.substr(0, end + 2);
+            m_pending.assign(data.begin() + end + 4, data.end());
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int HttpStream::rawRead(uint8_t* buf, int size) {
+    if (m_pendingPos >= m_pending.size()) {
+        m_pending.resize(RECV_SIZE);
+        m_pendingPos = 0;
+
+        while (true) {
+            if (!waitFor(POLLIN)) {
+                m_pending.clear();
+                return -1;
+            }
+            ssize_t n = ::recv(m_fd, m_pending.data(), m_pending.size(), 0);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                continue;
+            }
+            if (n <= 0) {
+                m_pending.clear();
+                return static_cast<int>(n);
+            }
+            m_pending.resize(n);
+            break;
+        }
+    }
+
+    size_t n = std::min(static_cast<size_t>(size), m_pending.size() - m_pendingPos);
+    std::memcpy(buf, m_pending.data() + m_pendingPos, n);
+    m_pendingPos += n;
+    return static_cast<int>(n);
+}
+
+bool HttpStream::readLine(std::string& line) {
+    line.clear();
+    uint8_t c;
+    while (line.size() < 1024) {
+        if (rawRead(&c, 1) != 1) {
+            return false;
+        }
+        if (c == '\n') {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            return true;
+        }
+        line.push_back(static_cast<char>(c));
+    }
+    return false;
+}
+
+int HttpStream::bodyRead(uint8_t* buf, int size) {
+    if (m_bodyDone) {
+        return 0;
+    }
+    if (m_fd < 0) {
+        return -1;
+    }
+
+    if (m_chunked) {
+        if (m_remaining <= 0) {
+            std::string line;
+            if (!readLine(line)) {
+                return -1;
+            }
+            m_remaining = std::strtoll(line.c_str(), nullptr, 16);
+            if (m_remaining <= 0) {
+                // Last chunk: skip trailers up to the empty line
+                while (readLine(line) && !line.empty()) {}
+                m_bodyDone = true;
+                return 0;
+            }
+        }
+
+        int n = rawRead(buf, static_cast<int>(std::min<int64_t>(size, m_remaining)));
+        if (n <= 0) {
+            return -1;
+        }
+        m_remaining -= n;
+
+        std::string crlf;
+        if (m_remaining == 0 && !readLine(crlf)) {
+            return -1;
+        }
+        return n;
+    }
+
+    if (m_remaining >= 0) {
+        if (m_remaining == 0) {
+            m_bodyDone = true;
+            return 0;
+        }
+        int n = rawRead(buf, static_cast<int>(std::min<int64_t>(size, m_remaining)));
+        if (n <= 0) {
+            return -1;   // Closed before Content-Length
+        }
+        m_remaining -= n;
+        return n;
+    }
+
+    // No length: body ends when the server closes
+    int n = rawRead(buf, size);
+    if (n == 0) {
+        m_keepAlive = false;
+        m_bodyDone = true;
+    }
+    return n;
+}
+
+int HttpStream::read(uint8_t* buf, int size) {
+    int n = bodyRead(buf, size);
+    if (n > 0) {
+        m_position += n;
+    }
+    return n;
+}
+
+bool HttpStream::seek(int64_t offset) {
+    if (offset == m_position && m_fd >= 0) {
+        return true;
+    }
+    return open(m_url, offset);
+}
+
+void HttpStream::close() {
+    if (m_fd >= 0) {
+        if (m_bodyDone && m_keepAlive && m_pendingPos >= m_pending.size()) {
+            HttpConnectionPool::release(m_host, m_port, m_fd);
+            m_fd = -1;
+        } else {
+            dropConnection();
+        }
+    }
+
+    m_pending.clear();
+    m_pendingPos = 0;
+    m_bodyDone = false;
+    m_remaining = -1;
+    m_chunked = false;
+}
+
+void HttpStream::dropConnection() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool HttpStream::sendAll(const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(m_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (!waitFor(POLLOUT)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HttpStream::waitFor(short events) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_timeoutMs);
+
+    while (true) {
+        if (m_interrupt && m_interrupt()) {
+            return false;
+        }
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            return false;
+        }
+
+        pollfd pfd;
+        pfd.fd = m_fd;
+        pfd.events = events;
+        pfd.revents = 0;
+
+        int rc = ::poll(&pfd, 1, static_cast<int>(std::min<int64_t>(left, POLL_SLICE_MS)));
+        if (rc > 0) {
+            return true;
+        }
+        if (rc < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+/**
+ * @brief Idle keep-alive connections, per host
+ *
+ * Media servers (MinimServer, Jriver, ...) serve a whole album from the
+ * same host: handing the finished connection to the next track skips
+ * DNS and the TCP handshake. Connections idle for longer than
+ * IDLE_TIMEOUT_S, or closed by the server, are dropped on acquire.
+ */
+class HttpConnectionPool {
+public:
+    static constexpr int MAX_IDLE_PER_HOST = 4;   // Parallel range connections of one track
+    static constexpr int IDLE_TIMEOUT_S = 30;
+
+    struct Stats {
+        int opened = 0;     // New TCP connections
+        int reused = 0;     // Requests served on a pooled connection
+    };
+
+    /**
+     * @brief Take an idle connection to host:port
+     * @return Connected socket, or -1 if none is available
+     */
+    static int acquire(const std::string& host, uint16_t port);
+
+    /**
+     * @brief Return a connection whose last response was fully read
+     */
+    static void release(const std::string& host, uint16_t port, int fd);
+
+    static void countOpened();
+    static Stats getStats();
+};
+
+/**
+ * @brief Minimal HTTP/1.1 GET stream with Range support
+ *
+ * Plain http:// only (https stays on FFmpeg's TLS stack). Follows
+ * redirects, handles chunked bodies, and returns the connection to
+ * HttpConnectionPool once the body has been read to the end.
+ */
+class HttpStream {
+public:
+    /**
+     * @brief Polled while waiting on the socket; return true to abort
+     */
+    using InterruptFunction = std::function<bool()>;
+
+    static constexpr int DEFAULT_TIMEOUT_MS = 10000;
+    static constexpr int MAX_REDIRECTS = 5;
+
+    HttpStream();
+    ~HttpStream();
+
+    HttpStream(const HttpStream&) = delete;
+    HttpStream& operator=(const HttpStream&) = delete;
+
+    /**
+     * @brief Send GET (with Range from offset) and read the response headers
+     * @param url http:// URL
+     * @param offset First byte wanted
+     * @param end Byte after the last one wanted, -1 = to the end
+     * @return true if the body is ready to read
+     */
+    bool open(const std::string& url, int64_t offset = 0, int64_t end = -1);
+
+    /**
+     * @brief Read body bytes
+     * @return Bytes read, 0 at end of body, -1 on error or interrupt
+     */
+    int read(uint8_t* buf, int size);
+
+    /**
+     * @brief Restart the body at a new offset (new request)
+     */
+    bool seek(int64_t offset);
+
+    /**
+     * @brief Close; the connection is pooled if the body was fully read
+     */
+    void close();
+
+    int64_t size() const { return m_totalSize; }
+    int64_t position() const { return m_position; }
+    bool connectionReused() const { return m_reused; }
+    int status() const { return m_status; }
+    const std::string& etag() const { return m_etag; }
+    const std::string& lastModified() const { return m_lastModified; }
+
+    /**
+     * @brief Server honours Range (206 reply or Accept-Ranges: bytes)
+     */
+    bool acceptsRanges() const { return m_status == 206 || m_acceptRanges; }
+
+    void setInterrupt(const InterruptFunction& interrupt) { m_interrupt = interrupt; }
+    void setTimeout(int ms) { m_timeoutMs = ms; }
+
+    /**
+     * @brief Split an http:// URL
+     * @return false for anything that is not plain http
+     */
+    static bool parseURL(const std::string& url, std::string& host, uint16_t& port, std::string& path);
+
+private:
+    bool request(const std::string& url, int64_t offset, std::string& redirect);
+    bool readHeaders(std::string& headers);
+    int rawRead(uint8_t* buf, int size);
+    int bodyRead(uint8_t* buf, int size);
+    bool readLine(std::string& line);
+    bool sendAll(const std::string& data);
+    bool waitFor(short events);
+    void dropConnection();
+
+    std::string m_url;
+    std::string m_host;
+    uint16_t m_port = 80;
+    int m_fd = -1;
+    bool m_reused = false;
+    bool m_keepAlive = false;
+    int m_status = 0;
+
+    // Bytes received past the headers, not yet returned
+    std::vector<uint8_t> m_pending;
+    size_t m_pendingPos = 0;
+
+    // Body framing
+    bool m_chunked = false;
+    int64_t m_remaining = -1;     // Bytes left in body (or current chunk), -1 = until close
+    bool m_bodyDone = false;
+
+    int64_t m_totalSize = -1;
+    int64_t m_position = 0;
+    int64_t m_rangeEnd = -1;      // Requested end (exclusive), -1 = open-ended
+    bool m_acceptRanges = false;
+    std::string m_etag;
+    std::string m_lastModified;
+
+    InterruptFunction m_interrupt;
+    int m_timeoutMs = DEFAULT_TIMEOUT_MS;
+};
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,167 @@
+#include "MappedFileIO.h"
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+std::atomic<bool> s_enabled{true};
+}
+
+MappedFileIO::MappedFileIO() {
+}
+
+MappedFileIO::~MappedFileIO() {
+    close();
+}
+
+void MappedFileIO::setEnabled(bool enabled) {
+    s_enabled.store(enabled);
+}
+
+bool MappedFileIO::enabled() {
+    return s_enabled.load();
+}
+
+bool MappedFileIO::isLocalURL(const std::string& url) {
+    return url.compare(0, 7, "file://") == 0 || (!url.empty() && url[0] == '/');
+}
+
+bool MappedFileIO::open(const std::string& url) {
+    close();
+
+    std::string path = (url.compare(0, 7, "file://") == 0) ? url.substr(7) : url;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);   // The mapping keeps the file
+    if (map == MAP_FAILED) {
+        DEBUG_LOG("[MappedFileIO] Cannot map " << path << ": " << std::strerror(errno));
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t*>(map);
+    m_size = static_cast<size_t>(st.st_size);
+    m_pos = 0;
+    m_advised = 0;
+    ::madvise(map, m_size, MADV_SEQUENTIAL);
+    advise(0);
+
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(AVIO_BUFFER_SIZE));
+    m_avio = buffer ? avio_alloc_context(buffer, static_cast<int>(AVIO_BUFFER_SIZE), 0, this,
+                                         &MappedFileIO::readPacket, nullptr,
+                                         &MappedFileIO::seekCallback)
+                    : nullptr;
+    if (!m_avio) {
+        std::cerr << "[MappedFileIO] Failed to allocate AVIOContext" << std::endl;
+        av_free(buffer);
+        close();
+        return false;
+    }
+
+    DEBUG_LOG("[MappedFileIO] ✓ Mapped " << (m_size / 1024) << " KB");
+    return true;
+}
+
+void MappedFileIO::close() {
+    if (m_avio) {
+        av_freep(&m_avio->buffer);
+        avio_context_free(&m_avio);
+    }
+    if (m_data) {
+        ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+    }
+    m_size = 0;
+    m_pos = 0;
+    m_advised = 0;
+}
+
+void MappedFileIO::advise(size_t offset) {
+    // Refill the window once half of it is consumed
+    if (offset + READAHEAD / 2 < m_advised || m_advised >= m_size) {
+        return;
+    }
+
+    long pageSize = ::sysconf(_SC_PAGESIZE);
+    size_t page = (pageSize > 0) ? static_cast<size_t>(pageSize) : 4096;
+    size_t start = std::max(offset, m_advised) & ~(page - 1);
+    size_t end = std::min(offset + READAHEAD, m_size);
+    if (end > start) {
+        ::madvise(const_cast<uint8_t*>(m_data) + start, end - start, MADV_WILLNEED);
+    }
+    m_advised = end;
+}
+
+void MappedFileIO::reposition(size_t offset) {
+    // Outside the current window (seek): restart it there
+    if (offset > m_advised || offset + READAHEAD < m_advised) {
+        m_advised = offset;
+    }
+}
+
+const uint8_t* MappedFileIO::span(int64_t offset, size_t length) {
+    if (!m_data || offset < 0 || static_cast<size_t>(offset) > m_size ||
+        length > m_size - static_cast<size_t>(offset)) {
+        return nullptr;
+    }
+
+    reposition(static_cast<size_t>(offset));
+    advise(static_cast<size_t>(offset) + length);
+    return m_data + offset;
+}
+
+int MappedFileIO::readPacket(void* opaque, uint8_t* buf, int size) {
+    auto* self = static_cast<MappedFileIO*>(opaque);
+    if (self->m_pos >= self->m_size) {
+        return AVERROR_EOF;
+    }
+
+    size_t n = std::min(static_cast<size_t>(size), self->m_size - self->m_pos);
+    std::memcpy(buf, self->m_data + self->m_pos, n);
+    self->m_pos += n;
+    self->advise(self->m_pos);
+    return static_cast<int>(n);
+}
+
+int64_t MappedFileIO::seekCallback(void* opaque, int64_t offset, int whence) {
+    auto* self = static_cast<MappedFileIO*>(opaque);
+
+    if (whence & AVSEEK_SIZE) {
+        return static_cast<int64_t>(self->m_size);
+    }
+
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET: target = offset; break;
+        case SEEK_CUR: target = static_cast<int64_t>(self->m_pos) + offset; break;
+        case SEEK_END: target = static_cast<int64_t>(self->m_size) + offset; break;
+        default: return AVERROR(EINVAL);
+    }
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+
+    self->m_pos = std::min(static_cast<size_t>(target), self->m_size);
+    self->reposition(self->m_pos);
+    self->advise(self->m_pos);
+    return target;
+}
@@ -0,0 +1,81 @@
+#ifndef MAPPED_FILE_IO_H
+#define MAPPED_FILE_IO_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief Memory-mapped AVIOContext for local files (local disk, NFS/SMB mounts)
+ *
+ * The file is mapped read-only instead of going through FFmpeg's file
+ * protocol: avio reads are a copy out of the page cache with no read()
+ * syscall, and the kernel is asked to read ahead (MADV_SEQUENTIAL, plus
+ * MADV_WILLNEED on the window in front of the read position).
+ *
+ * Readers that know the layout (DsdReader) take spans of the mapping
+ * directly and skip the AVIO buffer altogether.
+ *
+ * The file must not shrink while it is mapped: pages past the new end
+ * fault with SIGBUS. Disable with setEnabled(false) for libraries that are
+ * rewritten in place.
+ */
+class MappedFileIO {
+public:
+    static constexpr size_t AVIO_BUFFER_SIZE = 256 * 1024;
+    static constexpr size_t READAHEAD = 8 * 1024 * 1024;   // WILLNEED window ahead of the reads
+
+    MappedFileIO();
+    ~MappedFileIO();
+
+    MappedFileIO(const MappedFileIO&) = delete;
+    MappedFileIO& operator=(const MappedFileIO&) = delete;
+
+    /**
+     * @brief Map a local file
+     * @param url Path or file:// URL
+     * @return false if the file cannot be opened or mapped (use avio instead)
+     */
+    bool open(const std::string& url);
+    void close();
+
+    /**
+     * @brief AVIOContext to install as AVFormatContext::pb (AVFMT_FLAG_CUSTOM_IO)
+     */
+    AVIOContext* context() const { return m_avio; }
+
+    int64_t size() const { return static_cast<int64_t>(m_size); }
+
+    /**
+     * @brief Direct view of [offset, offset + length), readahead advised past it
+     * @return nullptr if the range is outside the file
+     */
+    const uint8_t* span(int64_t offset, size_t length);
+
+    /**
+     * @brief True for file:// URLs and absolute paths
+     */
+    static bool isLocalURL(const std::string& url);
+
+    static void setEnabled(bool enabled);
+    static bool enabled();
+
+private:
+    static int readPacket(void* opaque, uint8_t* buf, int size);
+    static int64_t seekCallback(void* opaque, int64_t offset, int whence);
+
+    void advise(size_t offset);
+    void reposition(size_t offset);
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_pos = 0;
+    size_t m_advised = 0;    // End of the WILLNEED window
+    AVIOContext* m_avio = nullptr;
+};
+
+#endif // MAPPED_FILE_IO_H
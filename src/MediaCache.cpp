@@ -0,0 +1,551 @@
+#include "MediaCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <list>
+#include <new>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+
+constexpr char MAGIC[4] = {'D', 'R', 'M', 'C'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr uint32_t MAX_STRING = 64 * 1024;
+
+std::mutex s_mutex;
+bool s_enabled = false;
+std::string s_directory;
+int64_t s_diskBytes = MediaCache::DEFAULT_DISK_SIZE;
+std::list<std::shared_ptr<MediaCache::Entry>> s_ram;   // Most recently opened first
+
+uint64_t fnv1a(const std::string& s) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool makeDirectories(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (::mkdir(prefix.c_str(), 0755) < 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+void putString(std::ofstream& out, const std::string& value) {
+    uint32_t size = static_cast<uint32_t>(value.size());
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(value.data(), size);
+}
+
+bool getString(std::ifstream& in, std::string& value) {
+    uint32_t size;
+    if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > MAX_STRING) {
+        return false;
+    }
+    value.resize(size);
+    return size == 0 || static_cast<bool>(in.read(&value[0], size));
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+} // namespace
+
+// ============================================================================
+// Validator
+// ============================================================================
+
+bool MediaCache::Validator::matches(const Validator& other) const {
+    if (length != other.length) {
+        return false;
+    }
+    if (!etag.empty() && !other.etag.empty() && etag != other.etag) {
+        return false;
+    }
+    if (!lastModified.empty() && !other.lastModified.empty() && lastModified != other.lastModified) {
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Entry
+// ============================================================================
+
+MediaCache::Entry::Entry(const std::string& uri, const Validator& validator)
+    : m_uri(uri)
+    , m_validator(validator)
+{
+    // Uninitialized: every byte is written before it is marked filled
+    m_data = new (std::nothrow) uint8_t[static_cast<size_t>(validator.length)];
+}
+
+MediaCache::Entry::Entry(const std::string& uri, const Validator& validator, const std::string& path)
+    : m_uri(uri)
+    , m_validator(validator)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size == validator.length && validator.length > 0) {
+        void* map = ::mmap(nullptr, static_cast<size_t>(validator.length), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            m_data = static_cast<uint8_t*>(map);
+            m_mapped = true;
+            m_ranges[0] = validator.length;
+            m_filled = validator.length;
+        }
+    }
+    ::close(fd);
+}
+
+MediaCache::Entry::~Entry() {
+    if (m_mapped) {
+        ::munmap(m_data, static_cast<size_t>(m_validator.length));
+    } else {
+        delete[] m_data;
+    }
+}
+
+bool MediaCache::Entry::complete() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_filled >= m_validator.length;
+}
+
+bool MediaCache::Entry::hasLocked(int64_t offset, int64_t& rangeEnd) const {
+    auto next = m_ranges.upper_bound(offset);
+    if (next == m_ranges.begin()) {
+        return false;
+    }
+    auto range = std::prev(next);
+    if (offset >= range->second) {
+        return false;
+    }
+    rangeEnd = range->second;
+    return true;
+}
+
+int MediaCache::Entry::read(int64_t offset, uint8_t* buf, int size, const std::atomic<bool>& stop,
+                            bool& waited) {
+    waited = false;
+    if (offset >= m_validator.length) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int64_t rangeEnd = 0;
+
+    if (!hasLocked(offset, rangeEnd)) {
+        // Seek target the writer is not heading for yet
+        if (m_wanted != offset) {
+            m_wanted = offset;
+            m_cv.notify_all();
+        }
+        waited = true;
+        m_cv.wait(lock, [&] { return hasLocked(offset, rangeEnd) || m_error != 0 || stop.load(); });
+
+        if (stop) {
+            return AVERROR_EXIT;
+        }
+        if (!hasLocked(offset, rangeEnd)) {
+            return m_error;
+        }
+    }
+    lock.unlock();
+
+    // Filled bytes never change: copy outside the lock
+    int n = static_cast<int>(std::min<int64_t>(size, rangeEnd - offset));
+    std::memcpy(buf, m_data + offset, n);
+    return n;
+}
+
+int64_t MediaCache::Entry::availableFrom(int64_t offset) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t rangeEnd = 0;
+    return hasLocked(offset, rangeEnd) ? rangeEnd - offset : 0;
+}
+
+void MediaCache::Entry::want(int64_t offset) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t rangeEnd = 0;
+    if (offset < m_validator.length && !hasLocked(offset, rangeEnd)) {
+        m_wanted = offset;
+        m_cv.notify_all();
+    }
+}
+
+void MediaCache::Entry::wake() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cv.notify_all();
+}
+
+bool MediaCache::Entry::claimWriter(const std::atomic<bool>& stop) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&] {
+        return !m_writer || m_filled >= m_validator.length || m_error != 0 || stop.load();
+    });
+
+    if (m_writer || m_filled >= m_validator.length || m_error != 0 || stop) {
+        return false;
+    }
+    m_writer = true;
+    return true;
+}
+
+void MediaCache::Entry::releaseWriter() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_writer = false;
+    m_cv.notify_all();
+}
+
+int64_t MediaCache::Entry::nextMissing(int64_t from, int64_t& end) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_filled >= m_validator.length) {
+        return -1;
+    }
+
+    // Gap starting at (or after) pos, or -1 if everything from pos on is filled
+    auto gapFrom = [&](int64_t pos) -> int64_t {
+        auto next = m_ranges.upper_bound(pos);
+        if (next != m_ranges.begin()) {
+            auto range = std::prev(next);
+            if (pos < range->second) {
+                pos = range->second;
+                next = m_ranges.upper_bound(pos);
+            }
+        }
+        if (pos >= m_validator.length) {
+            return -1;
+        }
+        end = (next == m_ranges.end()) ? m_validator.length : next->first;
+        return pos;
+    };
+
+    int64_t start = -1;
+    if (m_wanted >= 0) {
+        start = gapFrom(m_wanted);
+        m_wanted = -1;
+    }
+    if (start < 0) {
+        start = gapFrom(std::max<int64_t>(from, 0));
+    }
+    if (start < 0) {
+        start = gapFrom(0);
+    }
+    return start;
+}
+
+void MediaCache::Entry::write(int64_t offset, const uint8_t* data, size_t size) {
+    if (m_mapped || offset < 0 || offset >= m_validator.length) {
+        return;
+    }
+    int64_t end = std::min<int64_t>(offset + static_cast<int64_t>(size), m_validator.length);
+
+    // The writer only fetches gaps: nobody reads these bytes yet
+    std::memcpy(m_data + offset, data, static_cast<size_t>(end - offset));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Merge [offset, end) with the ranges it touches
+    int64_t start = offset;
+    auto it = m_ranges.upper_bound(offset);
+    if (it != m_ranges.begin() && std::prev(it)->second >= offset) {
+        --it;
+    }
+    while (it != m_ranges.end() && it->first <= end) {
+        start = std::min(start, it->first);
+        end = std::max(end, it->second);
+        m_filled -= it->second - it->first;
+        it = m_ranges.erase(it);
+    }
+    m_ranges[start] = end;
+    m_filled += end - start;
+
+    m_cv.notify_all();
+}
+
+void MediaCache::Entry::fail(int error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_error = (error < 0) ? error : AVERROR(EIO);
+    m_cv.notify_all();
+}
+
+// ============================================================================
+// Cache
+// ============================================================================
+
+void MediaCache::configure(const std::string& directory, int64_t diskBytes) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_enabled = true;
+    s_directory.clear();
+    s_diskBytes = (diskBytes > 0) ? diskBytes : DEFAULT_DISK_SIZE;
+
+    if (directory.empty()) {
+        DEBUG_LOG("[MediaCache] RAM tier only");
+        return;
+    }
+
+    if (!makeDirectories(directory) || ::access(directory.c_str(), W_OK) != 0) {
+        std::cerr << "[MediaCache] ⚠️  Cannot use " << directory << ": " << std::strerror(errno)
+                  << ", disk tier disabled" << std::endl;
+        return;
+    }
+
+    s_directory = directory;
+    DEBUG_LOG("[MediaCache] Using " << s_directory << " (" << (s_diskBytes / (1024 * 1024)) << " MB)");
+}
+
+void MediaCache::disable() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_enabled = false;
+    s_directory.clear();
+    s_ram.clear();
+}
+
+bool MediaCache::enabled() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_enabled;
+}
+
+std::string MediaCache::pathFor(const std::string& uri) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(fnv1a(uri)));
+    return s_directory + "/" + name;
+}
+
+void MediaCache::remember(const std::shared_ptr<Entry>& entry) {
+    // Caller holds s_mutex
+    s_ram.remove(entry);
+    s_ram.push_front(entry);
+    while (s_ram.size() > RAM_TRACKS) {
+        s_ram.pop_back();
+    }
+}
+
+std::shared_ptr<MediaCache::Entry> MediaCache::find(const std::string& uri) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_enabled) {
+        return nullptr;
+    }
+
+    for (const auto& entry : s_ram) {
+        if (entry->uri() == uri) {
+            auto hit = entry;
+            remember(hit);
+            DEBUG_LOG("[MediaCache] ⚡ RAM hit" << (hit->complete() ? "" : " (still downloading)"));
+            return hit;
+        }
+    }
+
+    if (s_directory.empty()) {
+        return nullptr;
+    }
+
+    std::string base = pathFor(uri);
+    std::ifstream in(base + ".meta", std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    std::string storedUri;
+    Validator validator;
+    bool ok = in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              in.read(reinterpret_cast<char*>(&version), sizeof(version)) && version == FORMAT_VERSION &&
+              getString(in, storedUri) &&
+              in.read(reinterpret_cast<char*>(&validator.length), sizeof(validator.length)) &&
+              getString(in, validator.etag) && getString(in, validator.lastModified);
+
+    // Hash collision or corrupt metadata
+    if (!ok || storedUri != uri) {
+        return nullptr;
+    }
+
+    auto entry = std::make_shared<Entry>(uri, validator, base + ".media");
+    if (!entry->valid()) {
+        std::cerr << "[MediaCache] ⚠️  Cannot map " << base << ".media, ignored" << std::endl;
+        return nullptr;
+    }
+
+    // LRU order on disk is the modification time
+    ::utimensat(AT_FDCWD, (base + ".media").c_str(), nullptr, 0);
+
+    remember(entry);
+    DEBUG_LOG("[MediaCache] ⚡ Disk hit (" << (validator.length / 1024) << " KB)");
+    return entry;
+}
+
+std::shared_ptr<MediaCache::Entry> MediaCache::create(const std::string& uri, const Validator& validator) {
+    if (validator.length <= 0 || validator.length > MAX_ENTRY_SIZE) {
+        return nullptr;
+    }
+
+    auto entry = std::make_shared<Entry>(uri, validator);
+    if (!entry->valid()) {
+        std::cerr << "[MediaCache] ⚠️  Cannot allocate " << (validator.length / (1024 * 1024))
+                  << " MB, track not cached" << std::endl;
+        return nullptr;
+    }
+
+    std::atomic<bool> never{false};
+    entry->claimWriter(never);
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_enabled) {
+        return nullptr;
+    }
+    for (const auto& other : s_ram) {
+        if (other->uri() == uri) {
+            s_ram.remove(other);
+            break;
+        }
+    }
+    remember(entry);
+    return entry;
+}
+
+void MediaCache::completed(const std::shared_ptr<Entry>& entry) {
+    if (entry->onDisk()) {
+        return;
+    }
+
+    std::string base;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_directory.empty()) {
+            return;
+        }
+        base = pathFor(entry->uri());
+    }
+    std::string suffix = ".tmp" + std::to_string(::getpid());
+    const Validator& validator = entry->validator();
+
+    // Data first, metadata last: a .meta file always has its .media
+    {
+        std::ofstream out(base + ".media" + suffix, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(entry->data()), static_cast<std::streamsize>(validator.length));
+        if (!out) {
+            out.close();
+            std::remove((base + ".media" + suffix).c_str());
+            std::cerr << "[MediaCache] ⚠️  Cannot write " << base << ".media" << std::endl;
+            return;
+        }
+    }
+    {
+        std::ofstream out(base + ".meta" + suffix, std::ios::binary | std::ios::trunc);
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(&FORMAT_VERSION), sizeof(FORMAT_VERSION));
+        putString(out, entry->uri());
+        out.write(reinterpret_cast<const char*>(&validator.length), sizeof(validator.length));
+        putString(out, validator.etag);
+        putString(out, validator.lastModified);
+        if (!out) {
+            out.close();
+            std::remove((base + ".media" + suffix).c_str());
+            std::remove((base + ".meta" + suffix).c_str());
+            return;
+        }
+    }
+
+    if (std::rename((base + ".media" + suffix).c_str(), (base + ".media").c_str()) != 0 ||
+        std::rename((base + ".meta" + suffix).c_str(), (base + ".meta").c_str()) != 0) {
+        std::remove((base + ".media" + suffix).c_str());
+        std::remove((base + ".meta" + suffix).c_str());
+        return;
+    }
+
+    DEBUG_LOG("[MediaCache] 💾 Stored " << (validator.length / 1024) << " KB");
+    prune();
+}
+
+void MediaCache::invalidate(const std::string& uri) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_ram.remove_if([&](const std::shared_ptr<Entry>& entry) { return entry->uri() == uri; });
+
+    if (!s_directory.empty()) {
+        std::string base = pathFor(uri);
+        std::remove((base + ".meta").c_str());
+        std::remove((base + ".media").c_str());
+    }
+}
+
+void MediaCache::prune() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    DIR* dir = ::opendir(s_directory.c_str());
+    if (!dir) {
+        return;
+    }
+
+    struct File {
+        time_t mtime;
+        int64_t size;
+        std::string base;
+    };
+    std::vector<File> files;
+    int64_t total = 0;
+    while (struct dirent* e = ::readdir(dir)) {
+        std::string name = e->d_name;
+        if (!endsWith(name, ".media")) {
+            continue;
+        }
+        std::string path = s_directory + "/" + name;
+        struct stat st;
+        if (::stat(path.c_str(), &st) == 0) {
+            files.push_back({st.st_mtime, static_cast<int64_t>(st.st_size),
+                             path.substr(0, path.size() - 6)});
+            total += st.st_size;
+        }
+    }
+    ::closedir(dir);
+
+    if (total <= s_diskBytes) {
+        return;
+    }
+
+    // Least recently used first; mapped entries stay readable after the unlink
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.mtime < b.mtime; });
+    size_t removed = 0;
+    for (const auto& file : files) {
+        if (total <= s_diskBytes) {
+            break;
+        }
+        std::remove((file.base + ".meta").c_str());
+        std::remove((file.base + ".media").c_str());
+        total -= file.size;
+        removed++;
+    }
+    DEBUG_LOG("[MediaCache] Pruned " << removed << " tracks");
+}
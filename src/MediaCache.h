@@ -0,0 +1,169 @@
+#ifndef MEDIA_CACHE_H
+#define MEDIA_CACHE_H
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Whole-track content cache for network sources (RAM + disk tiers)
+ *
+ * PrefetchIO downloads a cached track as a whole into an Entry and serves
+ * FFmpeg's reads from it. Entries are shared: a second open of the same
+ * URI (the preloaded next track, a replay) reads from the entry while it
+ * is still being filled, and takes over the download if the first reader
+ * goes away.
+ *
+ * RAM tier: the RAM_TRACKS most recently opened entries (current + next
+ * track) stay referenced. Disk tier (optional): completed entries are
+ * written to a directory and mapped back on a later hit; least recently
+ * used files go once the directory exceeds its size cap.
+ *
+ * Entries are keyed by URI and carry the validator seen on download
+ * (length, ETag, Last-Modified); a hit is revalidated in the background.
+ */
+class MediaCache {
+public:
+    static constexpr size_t RAM_TRACKS = 2;
+    static constexpr int64_t MAX_ENTRY_SIZE = 1024LL * 1024 * 1024;        // 1 GB, like WHOLE_TRACK
+    static constexpr int64_t DEFAULT_DISK_SIZE = 4096LL * 1024 * 1024;     // 4 GB
+
+    struct Validator {
+        int64_t length = -1;
+        std::string etag;
+        std::string lastModified;
+
+        /**
+         * @brief Same content: lengths equal, and the ETag / Last-Modified
+         *        equal where both sides have one
+         */
+        bool matches(const Validator& other) const;
+    };
+
+    class Entry {
+    public:
+        /**
+         * @brief Empty RAM entry to be filled (check valid())
+         */
+        Entry(const std::string& uri, const Validator& validator);
+
+        /**
+         * @brief Complete entry mapped from a disk-tier file (check valid())
+         */
+        Entry(const std::string& uri, const Validator& validator, const std::string& path);
+
+        ~Entry();
+
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        bool valid() const { return m_data != nullptr; }
+        const std::string& uri() const { return m_uri; }
+        const Validator& validator() const { return m_validator; }
+        int64_t size() const { return m_validator.length; }
+        bool complete() const;
+        bool onDisk() const { return m_mapped; }
+        const uint8_t* data() const { return m_data; }
+
+        // ── Readers ──
+
+        /**
+         * @brief Copy what is available at offset, waiting for the writer if needed
+         * @param stop Reader's stop flag (wake() makes the wait re-check it)
+         * @param waited Set when the call had to wait
+         * @return Bytes copied, 0 at the end, AVERROR_EXIT on stop, < 0 on download error
+         */
+        int read(int64_t offset, uint8_t* buf, int size, const std::atomic<bool>& stop, bool& waited);
+
+        /**
+         * @brief Bytes available from offset without waiting
+         */
+        int64_t availableFrom(int64_t offset) const;
+
+        /**
+         * @brief Ask the writer to fetch offset next (after a seek)
+         */
+        void want(int64_t offset);
+
+        /**
+         * @brief Wake every waiter so it re-checks its stop flag
+         */
+        void wake();
+
+        // ── Writer (one at a time) ──
+
+        /**
+         * @brief Become the writer once nobody else is
+         * @return false if the entry is complete or failed, or stop was set
+         */
+        bool claimWriter(const std::atomic<bool>& stop);
+        void releaseWriter();
+
+        /**
+         * @brief Next missing range: the wanted offset first, then the first gap from `from`
+         * @param end Set to the end of the gap
+         * @return Start of the gap, -1 if the entry is complete
+         */
+        int64_t nextMissing(int64_t from, int64_t& end);
+
+        void write(int64_t offset, const uint8_t* data, size_t size);
+        void fail(int error);
+
+    private:
+        bool hasLocked(int64_t offset, int64_t& rangeEnd) const;
+
+        std::string m_uri;
+        Validator m_validator;
+        uint8_t* m_data = nullptr;
+        bool m_mapped = false;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::map<int64_t, int64_t> m_ranges;   // Filled [start, end), merged
+        int64_t m_filled = 0;                  // Total filled bytes
+        int64_t m_wanted = -1;
+        bool m_writer = false;
+        int m_error = 0;
+    };
+
+    /**
+     * @brief Enable the cache
+     * @param directory Disk tier directory (created if missing), empty = RAM tier only
+     * @param diskBytes Disk tier size cap
+     */
+    static void configure(const std::string& directory, int64_t diskBytes);
+    static void disable();
+    static bool enabled();
+
+    /**
+     * @brief Cached or in-progress entry for uri (RAM tier, then disk tier), nullptr on miss
+     */
+    static std::shared_ptr<Entry> find(const std::string& uri);
+
+    /**
+     * @brief New entry for a download, owned by the caller as writer
+     * @return nullptr if the size is unknown or too large, or memory is short
+     */
+    static std::shared_ptr<Entry> create(const std::string& uri, const Validator& validator);
+
+    /**
+     * @brief Entry fully downloaded: write it to the disk tier
+     */
+    static void completed(const std::shared_ptr<Entry>& entry);
+
+    /**
+     * @brief Forget uri in both tiers (stale or failed)
+     */
+    static void invalidate(const std::string& uri);
+
+private:
+    static void remember(const std::shared_ptr<Entry>& entry);
+    static std::string pathFor(const std::string& uri);
+    static void prune();
+};
+
+#endif // MEDIA_CACHE_H
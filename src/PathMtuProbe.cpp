@@ -0,0 +1,305 @@
+#include "PathMtuProbe.h"
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+
+const uint16_t DISCARD_PORT = 9;   // RFC 863 discard: only used to pick the route
+
+std::mutex s_cacheMutex;
+std::map<std::string, uint32_t> s_cache;
+
+struct ProbeSocket {
+    int fd = -1;
+    int family = AF_INET;
+
+    ~ProbeSocket() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+/**
+ * Accepts "addr", "addr%scope", "[addr]:port" and "a.b.c.d:port"
+ */
+std::string hostOnly(const std::string& host) {
+    if (!host.empty() && host[0] == '[') {
+        size_t end = host.find(']');
+        return host.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+    }
+    if (std::count(host.begin(), host.end(), ':') == 1) {
+        return host.substr(0, host.find(':'));
+    }
+    return host;
+}
+
+std::shared_ptr<ProbeSocket> openProbeSocket(const std::string& host, uint16_t port) {
+    std::string addr = hostOnly(host);
+    std::string service = std::to_string(port);
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_NUMERICHOST;
+
+    addrinfo* res = nullptr;
+    if (getaddrinfo(addr.c_str(), service.c_str(), &hints, &res) != 0) {
+        hints.ai_flags = 0;
+        if (getaddrinfo(addr.c_str(), service.c_str(), &hints, &res) != 0) {
+            std::cerr << "[PathMtuProbe] ⚠️  Cannot resolve " << host << std::endl;
+            return nullptr;
+        }
+    }
+
+    auto sock = std::make_shared<ProbeSocket>();
+    sock->family = res->ai_family;
+    sock->fd = ::socket(res->ai_family, SOCK_DGRAM, 0);
+
+    bool ok = (sock->fd >= 0);
+
+    // Don't-Fragment: oversize sends fail with EMSGSIZE instead of fragmenting
+    if (ok && sock->family == AF_INET6) {
+        int val = IPV6_PMTUDISC_DO;
+        ok = (setsockopt(sock->fd, IPPROTO_IPV6, IPV6_MTU_DISCOVER, &val, sizeof(val)) == 0);
+    } else if (ok) {
+        int val = IP_PMTUDISC_DO;
+        ok = (setsockopt(sock->fd, IPPROTO_IP, IP_MTU_DISCOVER, &val, sizeof(val)) == 0);
+    }
+
+    if (ok) {
+        ok = (::connect(sock->fd, res->ai_addr, res->ai_addrlen) == 0);
+    }
+
+    freeaddrinfo(res);
+
+    if (!ok) {
+        std::cerr << "[PathMtuProbe] ⚠️  Cannot open probe socket to " << host
+                  << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+
+    return sock;
+}
+
+uint32_t headerSize(const ProbeSocket& sock) {
+    return (sock.family == AF_INET6 ? 40 : 20) + 8;   // IP + UDP
+}
+
+/**
+ * Path MTU the kernel currently holds for the connected route
+ */
+int kernelPathMTU(const ProbeSocket& sock) {
+    int mtu = 0;
+    socklen_t len = sizeof(mtu);
+    int rc = (sock.family == AF_INET6)
+        ? getsockopt(sock.fd, IPPROTO_IPV6, IPV6_MTU, &mtu, &len)
+        : getsockopt(sock.fd, IPPROTO_IP, IP_MTU, &mtu, &len);
+    return rc == 0 ? mtu : 0;
+}
+
+bool sendProbe(const ProbeSocket& sock, uint32_t mtu, std::vector<uint8_t>& buffer) {
+    uint32_t header = headerSize(sock);
+    if (mtu <= header) {
+        return true;
+    }
+
+    size_t payload = mtu - header;
+    buffer.assign(payload, 0xA5);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        ssize_t sent = ::send(sock.fd, buffer.data(), payload, 0);
+        if (sent == static_cast<ssize_t>(payload)) {
+            return true;
+        }
+        // ICMP port unreachable from an earlier probe surfaces on the next send
+        if (sent < 0 && errno == ECONNREFUSED) {
+            continue;
+        }
+        return false;
+    }
+    return false;
+}
+
+} // namespace
+
+PathMtuProbe::Result PathMtuProbe::search(const ProbeFunction& probe, uint32_t floor,
+                                          uint32_t ceiling, int attempts) {
+    Result result;
+
+    if (!probe) {
+        return result;
+    }
+
+    if (ceiling <= floor) {
+        result.mtu = ceiling;
+        result.ok = true;
+        return result;
+    }
+
+    auto accepted = [&](uint32_t mtu) {
+        for (int i = 0; i < attempts; i++) {
+            result.probes++;
+            if (probe(mtu)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (accepted(ceiling)) {
+        result.mtu = ceiling;
+        result.ok = true;
+        return result;
+    }
+
+    uint32_t lo = floor;
+    uint32_t hi = ceiling;
+
+    while (hi - lo > RESOLUTION) {
+        uint32_t mid = (lo + (hi - lo) / 2) & ~3u;
+        if (mid <= lo) {
+            break;
+        }
+        if (accepted(mid)) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    result.mtu = lo;
+    result.ok = true;
+    return result;
+}
+
+PathMtuProbe::Result PathMtuProbe::discover(const std::string& host, const ProbeFunction& probe,
+                                            uint32_t ceiling) {
+    Result result;
+
+    uint32_t cached = 0;
+    if (getCached(host, cached)) {
+        result.mtu = std::min(cached, ceiling);
+        result.fromCache = true;
+        result.ok = true;
+        DEBUG_LOG("[PathMtuProbe] Cached path MTU for " << host << ": " << result.mtu << " bytes");
+        return result;
+    }
+
+    if (!probe) {
+        return result;
+    }
+
+    // The route MTU is a hard upper bound, no need to probe above it
+    uint32_t hi = ceiling;
+    uint32_t route = routeMTU(host);
+    if (route > 0 && route < hi) {
+        hi = route;
+    }
+    uint32_t lo = std::min(MIN_MTU, hi);
+
+    // search() takes the floor as known-good: without an answer there,
+    // nothing on the far end is confirming anything
+    bool floorOk = false;
+    for (int i = 0; i < ATTEMPTS && !floorOk; i++) {
+        result.probes++;
+        floorOk = probe(lo);
+    }
+    if (!floorOk) {
+        DEBUG_LOG("[PathMtuProbe] ⚠️  No answer from " << host << " at " << lo << " bytes");
+        return result;
+    }
+
+    int floorProbes = result.probes;
+    result = search(probe, lo, hi);
+    result.probes += floorProbes;
+
+    if (result.ok) {
+        setCached(host, result.mtu);
+        DEBUG_LOG("[PathMtuProbe] 📊 Path MTU to " << host << ": " << result.mtu
+                  << " bytes (" << result.probes << " probes, ceiling " << ceiling << ")");
+    }
+
+    return result;
+}
+
+uint32_t PathMtuProbe::routeMTU(const std::string& host) {
+    // connect() on a UDP socket only picks the route, nothing is sent
+    auto sock = openProbeSocket(host, DISCARD_PORT);
+    if (!sock) {
+        return 0;
+    }
+    int mtu = kernelPathMTU(*sock);
+    return mtu > 0 ? static_cast<uint32_t>(mtu) : 0;
+}
+
+PathMtuProbe::ProbeFunction PathMtuProbe::makeEchoProbe(const std::string& host, uint16_t port,
+                                                        int timeoutMs) {
+    auto sock = openProbeSocket(host, port);
+    if (!sock) {
+        return ProbeFunction();
+    }
+
+    auto buffer = std::make_shared<std::vector<uint8_t>>();
+    return [sock, buffer, timeoutMs](uint32_t mtu) {
+        std::vector<uint8_t> reply(mtu + 1);
+
+        // Drop late echoes from earlier probes
+        while (::recv(sock->fd, reply.data(), reply.size(), MSG_DONTWAIT) > 0) {}
+
+        if (!sendProbe(*sock, mtu, *buffer)) {
+            return false;
+        }
+
+        pollfd pfd;
+        pfd.fd = sock->fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (::poll(&pfd, 1, timeoutMs) <= 0) {
+            return false;
+        }
+
+        ssize_t received = ::recv(sock->fd, reply.data(), reply.size(), 0);
+        return received == static_cast<ssize_t>(buffer->size());
+    };
+}
+
+bool PathMtuProbe::getCached(const std::string& host, uint32_t& mtu) {
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    auto it = s_cache.find(host);
+    if (it == s_cache.end()) {
+        return false;
+    }
+    mtu = it->second;
+    return true;
+}
+
+void PathMtuProbe::setCached(const std::string& host, uint32_t mtu) {
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    s_cache[host] = mtu;
+}
+
+void PathMtuProbe::invalidate(const std::string& host) {
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    s_cache.erase(host);
+}
@@ -0,0 +1,96 @@
+#ifndef PATH_MTU_PROBE_H
+#define PATH_MTU_PROBE_H
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+/**
+ * @brief Path-MTU discovery towards a Diretta target
+ *
+ * Binary-searches the largest datagram that is confirmed delivered, between
+ * a safe floor and a configurable ceiling. A Don't-Fragment send on its own
+ * only proves the local route: a switch that drops jumbo frames sends no
+ * ICMP back. Sizes therefore only count once the far end answered them
+ * (UDP echo responder, see makeEchoProbe()). The probe is injectable so the
+ * search can run against a loopback echo stand-in.
+ *
+ * Results are cached per target for the lifetime of the process.
+ */
+class PathMtuProbe {
+public:
+    /**
+     * @brief Probe one candidate MTU
+     * @param mtu Candidate MTU (IP packet size in bytes)
+     * @return true if a packet of that size was confirmed delivered
+     */
+    using ProbeFunction = std::function<bool(uint32_t mtu)>;
+
+    static constexpr uint32_t MIN_MTU = 1280;           // IPv6 minimum, always deliverable
+    static constexpr uint32_t DEFAULT_CEILING = 16128;  // Largest jumbo frame we try
+    static constexpr uint32_t RESOLUTION = 8;           // Stop when bracket is this narrow
+    static constexpr int ATTEMPTS = 2;                  // Retries before a size counts as lost
+
+    struct Result {
+        uint32_t mtu = 0;
+        int probes = 0;
+        bool fromCache = false;
+        bool ok = false;
+    };
+
+    /**
+     * @brief Binary search for the largest MTU accepted by the probe
+     *
+     * The floor is assumed to work. The ceiling is tried first, since
+     * a clean jumbo path resolves in a single probe.
+     *
+     * @param probe Probe function
+     * @param floor Known-good MTU
+     * @param ceiling Largest MTU to consider
+     * @param attempts Tries per candidate (guards against plain loss)
+     * @return Search result
+     */
+    static Result search(const ProbeFunction& probe, uint32_t floor, uint32_t ceiling,
+                         int attempts = ATTEMPTS);
+
+    /**
+     * @brief Discover the path MTU to a target, using the cache
+     *
+     * The search is bounded by the kernel's route MTU (which includes ICMP
+     * "fragmentation needed" feedback). Nothing is cached if the probe does
+     * not confirm even the floor (no responder).
+     *
+     * @param host Target address (as printed by ACQUA::IPAddress::get_str())
+     * @param probe Probe that confirms delivery (e.g. makeEchoProbe())
+     * @param ceiling Largest MTU to consider
+     * @return Search result (mtu = 0 and ok = false if the target cannot be probed)
+     */
+    static Result discover(const std::string& host, const ProbeFunction& probe,
+                           uint32_t ceiling = DEFAULT_CEILING);
+
+    /**
+     * @brief MTU of the local route to host (no packet is sent)
+     * @return Route MTU in bytes, 0 if unknown
+     */
+    static uint32_t routeMTU(const std::string& host);
+
+    /**
+     * @brief Probe that waits for the datagram to be echoed back
+     *
+     * Use with a UDP echo responder (e.g. on loopback) to verify that
+     * frames of a given size really cross the path.
+     *
+     * @param host Echo responder address
+     * @param port Echo responder port
+     * @param timeoutMs Time to wait for each echo
+     * @return Probe function, or empty function if the socket cannot be set up
+     */
+    static ProbeFunction makeEchoProbe(const std::string& host, uint16_t port, int timeoutMs = 200);
+
+    // Per-target cache
+    static bool getCached(const std::string& host, uint32_t& mtu);
+    static void setCached(const std::string& host, uint32_t mtu);
+    static void invalidate(const std::string& host);
+};
+
+#endif // PATH_MTU_PROBE_H
@@ -0,0 +1,443 @@
+#include "PcmCache.h"
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+
+constexpr char MAGIC[4] = {'D', 'R', 'P', 'C'};
+
+std::mutex s_mutex;
+std::atomic<uint32_t> s_writers{0};   // Temp file names: one URI can be recorded twice at once
+std::string s_directory;
+int64_t s_maxBytes = PcmCache::DEFAULT_SIZE;
+
+uint64_t fnv1a(const std::string& s) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool makeDirectories(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (::mkdir(prefix.c_str(), 0755) < 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Fixed-size header block: fields in order, strings length-prefixed
+class HeaderWriter {
+public:
+    explicit HeaderWriter(uint8_t* block) : m_block(block) {}
+
+    template <typename T>
+    void put(const T& value) {
+        if (m_pos + sizeof(T) > PcmCache::HEADER_SIZE) {
+            m_ok = false;
+            return;
+        }
+        std::memcpy(m_block + m_pos, &value, sizeof(T));
+        m_pos += sizeof(T);
+    }
+
+    void putString(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        if (!m_ok || m_pos + value.size() > PcmCache::HEADER_SIZE) {
+            m_ok = false;
+            return;
+        }
+        std::memcpy(m_block + m_pos, value.data(), value.size());
+        m_pos += value.size();
+    }
+
+    bool ok() const { return m_ok; }
+
+private:
+    uint8_t* m_block;
+    size_t m_pos = 0;
+    bool m_ok = true;
+};
+
+class HeaderReader {
+public:
+    explicit HeaderReader(const uint8_t* block) : m_block(block) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (m_pos + sizeof(T) > PcmCache::HEADER_SIZE) {
+            return false;
+        }
+        std::memcpy(&value, m_block + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value) {
+        uint32_t size;
+        if (!get(size) || m_pos + size > PcmCache::HEADER_SIZE) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(m_block + m_pos), size);
+        m_pos += size;
+        return true;
+    }
+
+private:
+    const uint8_t* m_block;
+    size_t m_pos = 0;
+};
+
+bool encodeHeader(uint8_t* block, const std::string& uri, const PcmCache::Header& h) {
+    std::memset(block, 0, PcmCache::HEADER_SIZE);
+    HeaderWriter out(block);
+    out.put(MAGIC);
+    out.put(PcmCache::FORMAT_VERSION);
+    out.putString(uri);
+    out.put(h.sourceLength);
+    out.putString(h.etag);
+    out.putString(h.codec);
+    out.put(h.sampleRate);
+    out.put(h.bitDepth);
+    out.put(h.channels);
+    out.put(h.duration);
+    out.put(static_cast<uint8_t>(h.isDSD));
+    out.put(h.dsdRate);
+    out.put(h.dsdSourceFormat);
+    out.put(static_cast<uint8_t>(h.isCompressed));
+    out.put(h.outputRate);
+    out.put(h.outputBits);
+    out.put(h.frameBytes);
+    out.put(h.frameSamples);
+    out.put(h.samples);
+    return out.ok();
+}
+
+bool decodeHeader(const uint8_t* block, std::string& uri, PcmCache::Header& h) {
+    HeaderReader in(block);
+    char magic[4];
+    uint32_t version = 0;
+    uint8_t isDSD = 0;
+    uint8_t isCompressed = 0;
+    bool ok = in.get(magic) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              in.get(version) && version == PcmCache::FORMAT_VERSION &&
+              in.getString(uri) && in.get(h.sourceLength) && in.getString(h.etag) &&
+              in.getString(h.codec) && in.get(h.sampleRate) && in.get(h.bitDepth) &&
+              in.get(h.channels) && in.get(h.duration) && in.get(isDSD) && in.get(h.dsdRate) &&
+              in.get(h.dsdSourceFormat) && in.get(isCompressed) && in.get(h.outputRate) &&
+              in.get(h.outputBits) && in.get(h.frameBytes) && in.get(h.frameSamples) &&
+              in.get(h.samples);
+    h.isDSD = (isDSD != 0);
+    h.isCompressed = (isCompressed != 0);
+    return ok && h.frameBytes > 0 && h.frameSamples > 0;
+}
+
+} // namespace
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+PcmCache::Reader::Reader(const Header& header, const uint8_t* map, size_t mapSize)
+    : m_header(header)
+    , m_map(map)
+    , m_mapSize(mapSize)
+{
+}
+
+PcmCache::Reader::~Reader() {
+    ::munmap(const_cast<uint8_t*>(m_map), m_mapSize);
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+PcmCache::Writer::Writer(const std::string& uri, const std::string& path, const Header& header)
+    : m_uri(uri)
+    , m_path(path)
+    , m_temp(path + ".tmp" + std::to_string(::getpid()) + "-" + std::to_string(s_writers++))
+    , m_header(header)
+{
+    m_header.samples = 0;
+    m_fd = ::open(m_temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        return;
+    }
+
+    // Header is written last: until then the file is not a valid entry
+    if (::lseek(m_fd, static_cast<off_t>(HEADER_SIZE), SEEK_SET) < 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        std::remove(m_temp.c_str());
+    }
+}
+
+PcmCache::Writer::~Writer() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        std::remove(m_temp.c_str());
+    }
+}
+
+bool PcmCache::Writer::append(const uint8_t* data, uint64_t samples) {
+    if (m_fd < 0) {
+        return false;
+    }
+
+    int64_t maxBytes;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        maxBytes = s_maxBytes;
+    }
+    size_t bytes = m_header.bytesFor(samples);
+    if (static_cast<int64_t>(HEADER_SIZE + m_header.bytesFor(m_header.samples) + bytes) > maxBytes) {
+        DEBUG_LOG("[PcmCache] Track larger than the cache, not recorded");
+        return false;
+    }
+
+    while (bytes > 0) {
+        ssize_t n = ::write(m_fd, data, bytes);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            std::cerr << "[PcmCache] ⚠️  Cannot write " << m_temp << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    m_header.samples += samples;
+    return true;
+}
+
+void PcmCache::Writer::commit() {
+    if (m_fd < 0) {
+        return;
+    }
+
+    std::vector<uint8_t> block(HEADER_SIZE);
+    bool ok = m_header.samples > 0 && encodeHeader(block.data(), m_uri, m_header) &&
+              ::pwrite(m_fd, block.data(), HEADER_SIZE, 0) == static_cast<ssize_t>(HEADER_SIZE);
+    ok = (::close(m_fd) == 0) && ok;
+    m_fd = -1;
+
+    if (!ok || std::rename(m_temp.c_str(), m_path.c_str()) != 0) {
+        std::remove(m_temp.c_str());
+        std::cerr << "[PcmCache] ⚠️  Cannot store " << m_path << std::endl;
+        return;
+    }
+
+    DEBUG_LOG("[PcmCache] 💾 Stored " << (m_header.bytesFor(m_header.samples) / 1024) << " KB ("
+              << static_cast<double>(m_header.samples) / m_header.sampleRate << "s)");
+    prune();
+}
+
+// ============================================================================
+// Cache
+// ============================================================================
+
+void PcmCache::configure(const std::string& directory, int64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_directory.clear();
+    s_maxBytes = (maxBytes > 0) ? maxBytes : DEFAULT_SIZE;
+
+    if (directory.empty()) {
+        return;
+    }
+
+    if (!makeDirectories(directory) || ::access(directory.c_str(), W_OK) != 0) {
+        std::cerr << "[PcmCache] ⚠️  Cannot use " << directory << ": " << std::strerror(errno)
+                  << ", decoded-PCM cache disabled" << std::endl;
+        return;
+    }
+
+    s_directory = directory;
+    DEBUG_LOG("[PcmCache] Using " << s_directory << " (" << (s_maxBytes / (1024 * 1024)) << " MB)");
+}
+
+bool PcmCache::enabled() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return !s_directory.empty();
+}
+
+std::string PcmCache::pathFor(const std::string& uri, uint32_t outputRate, uint32_t outputBits) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx-%u-%u.pcm", static_cast<unsigned long long>(fnv1a(uri)),
+                  outputRate, outputBits);
+    return s_directory + "/" + name;
+}
+
+std::unique_ptr<PcmCache::Reader> PcmCache::find(const std::string& uri, uint32_t outputRate,
+                                                  uint32_t outputBits) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_directory.empty()) {
+            return nullptr;
+        }
+        path = pathFor(uri, outputRate, outputBits);
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    void* map = MAP_FAILED;
+    size_t mapSize = 0;
+    if (::fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(HEADER_SIZE)) {
+        mapSize = static_cast<size_t>(st.st_size);
+        map = ::mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::string storedUri;
+    Header header;
+    const uint8_t* bytes = static_cast<const uint8_t*>(map);
+
+    // Hash collision, corrupt or truncated file
+    if (!decodeHeader(bytes, storedUri, header) || storedUri != uri ||
+        HEADER_SIZE + header.bytesFor(header.samples) > mapSize) {
+        ::munmap(map, mapSize);
+        return nullptr;
+    }
+
+    // Played front to back: let the kernel read ahead
+    ::madvise(map, mapSize, MADV_SEQUENTIAL);
+
+    // LRU order is the modification time
+    ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+
+    DEBUG_LOG("[PcmCache] ⚡ Hit: " << header.codec << " " << header.sampleRate << "Hz, "
+              << (header.bytesFor(header.samples) / 1024) << " KB");
+    return std::make_unique<Reader>(header, bytes, mapSize);
+}
+
+std::unique_ptr<PcmCache::Writer> PcmCache::create(const std::string& uri, Header header) {
+    if (header.channels == 0 || header.sampleRate == 0) {
+        return nullptr;
+    }
+
+    // readSamples() layout: DSD one byte per channel per 8 samples,
+    // PCM 16-bit = 2 bytes, 24/32-bit = 4 bytes (S32 container)
+    if (header.isDSD) {
+        header.frameBytes = header.channels;
+        header.frameSamples = 8;
+    } else {
+        header.frameBytes = header.channels * (header.outputBits == 16 ? 2 : 4);
+        header.frameSamples = 1;
+    }
+
+    // The track's own format is keyed as 0/0, so an open finds it without knowing it
+    bool native = header.outputRate == header.sampleRate && header.outputBits == header.bitDepth;
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_directory.empty()) {
+            return nullptr;
+        }
+        path = native ? pathFor(uri, 0, 0) : pathFor(uri, header.outputRate, header.outputBits);
+    }
+
+    // The URI has to fit the header block
+    std::vector<uint8_t> block(HEADER_SIZE);
+    if (!encodeHeader(block.data(), uri, header)) {
+        return nullptr;
+    }
+
+    auto writer = std::make_unique<Writer>(uri, path, header);
+    if (!writer->valid()) {
+        std::cerr << "[PcmCache] ⚠️  Cannot create " << path << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    return writer;
+}
+
+void PcmCache::invalidate(const std::string& uri, uint32_t outputRate, uint32_t outputBits) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_directory.empty()) {
+        std::remove(pathFor(uri, outputRate, outputBits).c_str());
+    }
+}
+
+void PcmCache::prune() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    DIR* dir = ::opendir(s_directory.c_str());
+    if (!dir) {
+        return;
+    }
+
+    struct File {
+        time_t mtime;
+        int64_t size;
+        std::string path;
+    };
+    std::vector<File> files;
+    int64_t total = 0;
+    while (struct dirent* e = ::readdir(dir)) {
+        std::string name = e->d_name;
+        if (!endsWith(name, ".pcm")) {
+            continue;
+        }
+        std::string path = s_directory + "/" + name;
+        struct stat st;
+        if (::stat(path.c_str(), &st) == 0) {
+            files.push_back({st.st_mtime, static_cast<int64_t>(st.st_size), path});
+            total += st.st_size;
+        }
+    }
+    ::closedir(dir);
+
+    if (total <= s_maxBytes) {
+        return;
+    }
+
+    // Least recently used first; mapped entries stay readable after the unlink
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.mtime < b.mtime; });
+    size_t removed = 0;
+    for (const auto& file : files) {
+        if (total <= s_maxBytes) {
+            break;
+        }
+        std::remove(file.path.c_str());
+        total -= file.size;
+        removed++;
+    }
+    DEBUG_LOG("[PcmCache] Pruned " << removed << " tracks");
+}
@@ -0,0 +1,137 @@
+#ifndef PCM_CACHE_H
+#define PCM_CACHE_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+/**
+ * @brief Persistent cache of decoded tracks, in the format sent to the sink
+ *
+ * A track decoded from its start to its end is stored as it came out of
+ * AudioDecoder::readSamples() (S16/S32 PCM, or interleaved DSD groups),
+ * keyed by URI and output format. The next open of the URI maps the file
+ * and copies from it: no demuxing, decoding or conversion.
+ *
+ * File layout: a HEADER_SIZE header (source validators, track format,
+ * sample count), then the payload. Frames have a fixed size, so the frame
+ * index is arithmetic: sample n starts at frameBytes * n / frameSamples.
+ * Least recently used files go once the directory exceeds its size cap.
+ */
+class PcmCache {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 4096;                     // Payload stays page-aligned
+    static constexpr int64_t DEFAULT_SIZE = 16384LL * 1024 * 1024;   // 16 GB
+    static constexpr const char* DEFAULT_DIRECTORY = "/var/cache/diretta-renderer/pcm";
+
+    struct Header {
+        // Source validators
+        int64_t sourceLength = -1;
+        std::string etag;
+
+        // Track (TrackInfo fields)
+        std::string codec;
+        uint32_t sampleRate = 0;
+        uint32_t bitDepth = 0;
+        uint32_t channels = 0;
+        uint64_t duration = 0;
+        bool isDSD = false;
+        int32_t dsdRate = 0;
+        int32_t dsdSourceFormat = 0;
+        bool isCompressed = false;
+
+        // Payload: readSamples(outputRate, outputBits) output
+        uint32_t outputRate = 0;
+        uint32_t outputBits = 0;
+        uint32_t frameBytes = 0;      // Bytes per frame
+        uint32_t frameSamples = 1;    // Samples per frame (8 for DSD: one byte per channel)
+        uint64_t samples = 0;
+
+        size_t bytesFor(uint64_t count) const {
+            return static_cast<size_t>(count / frameSamples * frameBytes);
+        }
+    };
+
+    /**
+     * @brief A cached track, mapped read-only
+     */
+    class Reader {
+    public:
+        Reader(const Header& header, const uint8_t* map, size_t mapSize);
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const Header& header() const { return m_header; }
+        const uint8_t* data() const { return m_map + HEADER_SIZE; }
+
+    private:
+        Header m_header;
+        const uint8_t* m_map;
+        size_t m_mapSize;
+    };
+
+    /**
+     * @brief A track being recorded; dropped unless committed
+     */
+    class Writer {
+    public:
+        Writer(const std::string& uri, const std::string& path, const Header& header);
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        bool valid() const { return m_fd >= 0; }
+        const Header& header() const { return m_header; }
+
+        /**
+         * @brief Append samples (frame multiples)
+         * @return false on write error or once the entry outgrows the cache
+         */
+        bool append(const uint8_t* data, uint64_t samples);
+
+        /**
+         * @brief Write the header and publish the entry
+         */
+        void commit();
+
+    private:
+        std::string m_uri;
+        std::string m_path;
+        std::string m_temp;
+        Header m_header;
+        int m_fd = -1;
+    };
+
+    /**
+     * @brief Set the cache directory (created if missing) and size cap; empty disables the cache
+     */
+    static void configure(const std::string& directory, int64_t maxBytes);
+    static bool enabled();
+
+    /**
+     * @brief Mapped entry for uri in the given output format (0 = the track's own), nullptr on miss
+     */
+    static std::unique_ptr<Reader> find(const std::string& uri, uint32_t outputRate = 0,
+                                        uint32_t outputBits = 0);
+
+    /**
+     * @brief Start recording uri; frameBytes/frameSamples are derived from the header format
+     * @return nullptr if the cache is off or the file cannot be created
+     */
+    static std::unique_ptr<Writer> create(const std::string& uri, Header header);
+
+    /**
+     * @brief Forget uri (source changed)
+     */
+    static void invalidate(const std::string& uri, uint32_t outputRate = 0, uint32_t outputBits = 0);
+
+private:
+    static std::string pathFor(const std::string& uri, uint32_t outputRate, uint32_t outputBits);
+    static void prune();
+};
+
+#endif // PCM_CACHE_H
@@ -0,0 +1,398 @@
+#ifndef PCM_KERNELS_H
+#define PCM_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+extern "C" {
+#include <libavutil/samplefmt.h>
+}
+
+/**
+ * @brief Raw PCM → ring format conversions for the WAV/AIFF passthrough
+ *
+ * Output matches what the FFmpeg PCM decoders + swresample produce for
+ * the same format: 16-bit stays S16, 24-bit becomes S32 left-justified
+ * (sample << 8), 32-bit stays S32, all little-endian. Sources are
+ * little-endian (WAV) or big-endian (AIFF), templated so a kernel can
+ * be picked once per track as a plain function pointer.
+ *
+ * count is the number of individual samples (frames × channels).
+ * SSE2 / NEON where the build has them, scalar tail and fallback.
+ *
+ * The FrameKernel section below does the same for decoded frames when
+ * the output rate equals the source rate, replacing swresample: packed
+ * or planar S16 / S32 / FLT in, interleaved S16 or S32 out, with the
+ * same rounding and clipping as swresample's converters, picked by
+ * selectFrameKernel(). tests/PcmKernelsTest.cpp checks every entry
+ * byte for byte against swr_convert (make check).
+ */
+namespace PcmKernels {
+
+using Kernel = void (*)(const uint8_t* src, uint8_t* dst, size_t count);
+
+// ============================================================================
+// 16-bit → S16
+// ============================================================================
+
+template <bool BigEndian>
+inline void s16ToS16(const uint8_t* src, uint8_t* dst, size_t count) {
+    if (!BigEndian) {
+        std::memcpy(dst, src, count * 2);
+        return;
+    }
+
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), v);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u8(dst + i * 2, vrev16q_u8(vld1q_u8(src + i * 2)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i * 2]     = src[i * 2 + 1];
+        dst[i * 2 + 1] = src[i * 2];
+    }
+}
+
+// ============================================================================
+// 16-bit → S32 (sample << 16)
+// ============================================================================
+
+template <bool BigEndian>
+inline void s16ToS32(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        if (BigEndian) {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        // Zero low half, sample in the high half of each 32-bit lane
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_unpacklo_epi16(zero, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 16), _mm_unpackhi_epi16(zero, v));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t bytes = vld1q_u8(src + i * 2);
+        if (BigEndian) {
+            bytes = vrev16q_u8(bytes);
+        }
+        int16x8_t v = vreinterpretq_s16_u8(bytes);
+        vst1q_s32(reinterpret_cast<int32_t*>(dst + i * 4), vshll_n_s16(vget_low_s16(v), 16));
+        vst1q_s32(reinterpret_cast<int32_t*>(dst + i * 4 + 16), vshll_n_s16(vget_high_s16(v), 16));
+    }
+#endif
+    for (; i < count; i++) {
+        const uint8_t* s = src + i * 2;
+        uint8_t* d = dst + i * 4;
+        d[0] = 0;
+        d[1] = 0;
+        d[2] = BigEndian ? s[1] : s[0];
+        d[3] = BigEndian ? s[0] : s[1];
+    }
+}
+
+// ============================================================================
+// Packed 24-bit → S32 (sample << 8)
+// ============================================================================
+
+template <bool BigEndian>
+inline void s24ToS32(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(__SSSE3__)
+    // 4 samples (12 bytes) per shuffle; the 16-byte load needs 4 spare bytes
+    const __m128i mask = BigEndian
+        ? _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9)
+        : _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    for (; i + 6 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(v, mask));
+    }
+#elif defined(__ARM_NEON)
+    // De-interleave 16 samples into byte planes, re-interleave with a zero low byte
+    const uint8x16_t zero = vdupq_n_u8(0);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t in = vld3q_u8(src + i * 3);
+        uint8x16x4_t out;
+        out.val[0] = zero;
+        out.val[1] = BigEndian ? in.val[2] : in.val[0];
+        out.val[2] = in.val[1];
+        out.val[3] = BigEndian ? in.val[0] : in.val[2];
+        vst4q_u8(dst + i * 4, out);
+    }
+#endif
+    for (; i < count; i++) {
+        const uint8_t* s = src + i * 3;
+        uint8_t* d = dst + i * 4;
+        d[0] = 0;
+        d[1] = BigEndian ? s[2] : s[0];
+        d[2] = s[1];
+        d[3] = BigEndian ? s[0] : s[2];
+    }
+}
+
+// ============================================================================
+// 32-bit → S32
+// ============================================================================
+
+template <bool BigEndian>
+inline void s32ToS32(const uint8_t* src, uint8_t* dst, size_t count) {
+    if (!BigEndian) {
+        std::memcpy(dst, src, count * 4);
+        return;
+    }
+
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        // Swap bytes within 16-bit halves, then swap the halves
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), v);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u8(dst + i * 4, vrev32q_u8(vld1q_u8(src + i * 4)));
+    }
+#endif
+    for (; i < count; i++) {
+        const uint8_t* s = src + i * 4;
+        uint8_t* d = dst + i * 4;
+        d[0] = s[3];
+        d[1] = s[2];
+        d[2] = s[1];
+        d[3] = s[0];
+    }
+}
+
+// ============================================================================
+// Decoded frames (identity rate) → interleaved S16 / S32
+// ============================================================================
+
+/**
+ * @param planes Frame data (extended_data): one plane per channel if planar
+ * @param first First frame to convert
+ * @param frames Number of frames
+ * @param channels Channel count
+ * @param dst Interleaved output
+ */
+using FrameKernel = void (*)(const uint8_t* const* planes, size_t first, size_t frames,
+                             int channels, uint8_t* dst);
+
+// Scalar sample conversions (swresample's audioconvert.c formulas)
+inline int16_t s16FromS16(int16_t v) { return v; }
+inline int32_t s32FromS16(int16_t v) { return static_cast<int32_t>(static_cast<uint32_t>(v) << 16); }
+inline int32_t s32FromS32(int32_t v) { return v; }
+
+inline int32_t s32FromFlt(float v) {
+    long long r = std::llrint(v * 2147483648.0f);
+    return static_cast<int32_t>(r > INT32_MAX ? INT32_MAX : (r < INT32_MIN ? INT32_MIN : r));
+}
+
+template <typename In, typename Out, Out (*Convert)(In)>
+inline void packedFrames(const uint8_t* const* planes, size_t first, size_t frames,
+                         int channels, uint8_t* dst) {
+    const In* src = reinterpret_cast<const In*>(planes[0]) + first * channels;
+    Out* out = reinterpret_cast<Out*>(dst);
+    size_t count = frames * channels;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = Convert(src[i]);
+    }
+}
+
+template <typename In, typename Out, Out (*Convert)(In)>
+inline void planarFrames(const uint8_t* const* planes, size_t first, size_t frames,
+                         int channels, uint8_t* dst) {
+    Out* out = reinterpret_cast<Out*>(dst);
+    for (int ch = 0; ch < channels; ch++) {
+        const In* src = reinterpret_cast<const In*>(planes[ch]) + first;
+        for (size_t i = 0; i < frames; i++) {
+            out[i * channels + ch] = Convert(src[i]);
+        }
+    }
+}
+
+// Same layout and size in and out: a straight copy
+template <size_t SampleBytes>
+inline void copyFrames(const uint8_t* const* planes, size_t first, size_t frames,
+                       int channels, uint8_t* dst) {
+    std::memcpy(dst, planes[0] + first * channels * SampleBytes, frames * channels * SampleBytes);
+}
+
+inline void packedS16ToS32(const uint8_t* const* planes, size_t first, size_t frames,
+                           int channels, uint8_t* dst) {
+    s16ToS32<false>(planes[0] + first * channels * 2, dst, frames * channels);
+}
+
+inline void packedFltToS32(const uint8_t* const* planes, size_t first, size_t frames,
+                           int channels, uint8_t* dst) {
+    const float* src = reinterpret_cast<const float*>(planes[0]) + first * channels;
+    int32_t* out = reinterpret_cast<int32_t*>(dst);
+    size_t count = frames * channels;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        // cvtps2dq gives INT32_MIN on positive overflow: flip it to INT32_MAX
+        __m128i over = _mm_castps_si128(_mm_cmpge_ps(v, scale));
+        __m128i r = _mm_xor_si128(_mm_cvtps_epi32(v), over);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), r);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 4 <= count; i += 4) {
+        // Round to nearest, saturating
+        vst1q_s32(out + i, vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 2147483648.0f)));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = s32FromFlt(src[i]);
+    }
+}
+
+inline void planarStereoS16(const uint8_t* const* planes, size_t first, size_t frames,
+                            int, uint8_t* dst) {
+    const int16_t* l = reinterpret_cast<const int16_t*>(planes[0]) + first;
+    const int16_t* r = reinterpret_cast<const int16_t*>(planes[1]) + first;
+    int16_t* out = reinterpret_cast<int16_t*>(dst);
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= frames; i += 8) {
+        __m128i vl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l + i));
+        __m128i vr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi16(vl, vr));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 8), _mm_unpackhi_epi16(vl, vr));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        int16x8x2_t v = { { vld1q_s16(l + i), vld1q_s16(r + i) } };
+        vst2q_s16(out + i * 2, v);
+    }
+#endif
+    for (; i < frames; i++) {
+        out[i * 2]     = l[i];
+        out[i * 2 + 1] = r[i];
+    }
+}
+
+inline void planarStereoS32(const uint8_t* const* planes, size_t first, size_t frames,
+                            int, uint8_t* dst) {
+    const int32_t* l = reinterpret_cast<const int32_t*>(planes[0]) + first;
+    const int32_t* r = reinterpret_cast<const int32_t*>(planes[1]) + first;
+    int32_t* out = reinterpret_cast<int32_t*>(dst);
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= frames; i += 4) {
+        __m128i vl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l + i));
+        __m128i vr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi32(vl, vr));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 4), _mm_unpackhi_epi32(vl, vr));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= frames; i += 4) {
+        int32x4x2_t v = { { vld1q_s32(l + i), vld1q_s32(r + i) } };
+        vst2q_s32(out + i * 2, v);
+    }
+#endif
+    for (; i < frames; i++) {
+        out[i * 2]     = l[i];
+        out[i * 2 + 1] = r[i];
+    }
+}
+
+inline void planarStereoFltToS32(const uint8_t* const* planes, size_t first, size_t frames,
+                                 int, uint8_t* dst) {
+    const float* l = reinterpret_cast<const float*>(planes[0]) + first;
+    const float* r = reinterpret_cast<const float*>(planes[1]) + first;
+    int32_t* out = reinterpret_cast<int32_t*>(dst);
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    for (; i + 4 <= frames; i += 4) {
+        __m128 vl = _mm_mul_ps(_mm_loadu_ps(l + i), scale);
+        __m128 vr = _mm_mul_ps(_mm_loadu_ps(r + i), scale);
+        __m128i il = _mm_xor_si128(_mm_cvtps_epi32(vl), _mm_castps_si128(_mm_cmpge_ps(vl, scale)));
+        __m128i ir = _mm_xor_si128(_mm_cvtps_epi32(vr), _mm_castps_si128(_mm_cmpge_ps(vr, scale)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi32(il, ir));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 4), _mm_unpackhi_epi32(il, ir));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 4 <= frames; i += 4) {
+        int32x4x2_t v = { { vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(l + i), 2147483648.0f)),
+                            vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(r + i), 2147483648.0f)) } };
+        vst2q_s32(out + i * 2, v);
+    }
+#endif
+    for (; i < frames; i++) {
+        out[i * 2]     = s32FromFlt(l[i]);
+        out[i * 2 + 1] = s32FromFlt(r[i]);
+    }
+}
+
+// ============================================================================
+// Frame kernel selection
+// ============================================================================
+
+/**
+ * @brief Identity-rate conversion kernel for a decoded sample format
+ * @param channels Channel count
+ * @param outputSampleBytes Output container (2 = S16, 4 = S32)
+ * @param name Set to a readable name of the kernel
+ * @return nullptr = use swresample (which also dithers S32/FLT → S16)
+ */
+inline FrameKernel selectFrameKernel(AVSampleFormat format, int channels, size_t outputSampleBytes,
+                                     const char*& name) {
+    // First match wins: stereo specializations before the generic entries (channels 0 = any)
+    static const struct {
+        AVSampleFormat format;
+        int channels;
+        size_t outputSampleBytes;
+        FrameKernel kernel;
+        const char* name;
+    } table[] = {
+        {AV_SAMPLE_FMT_S16,  0, 2, &copyFrames<2>,                                   "S16 → S16 (copy)"},
+        {AV_SAMPLE_FMT_S16,  0, 4, &packedS16ToS32,                                  "S16 → S32"},
+        {AV_SAMPLE_FMT_S32,  0, 4, &copyFrames<4>,                                   "S32 → S32 (copy)"},
+        {AV_SAMPLE_FMT_FLT,  0, 4, &packedFltToS32,                                  "FLT → S32"},
+        {AV_SAMPLE_FMT_S16P, 2, 2, &planarStereoS16,                                 "S16P → S16 (stereo)"},
+        {AV_SAMPLE_FMT_S16P, 0, 2, &planarFrames<int16_t, int16_t, s16FromS16>,      "S16P → S16"},
+        {AV_SAMPLE_FMT_S16P, 0, 4, &planarFrames<int16_t, int32_t, s32FromS16>,      "S16P → S32"},
+        {AV_SAMPLE_FMT_S32P, 2, 4, &planarStereoS32,                                 "S32P → S32 (stereo)"},
+        {AV_SAMPLE_FMT_S32P, 0, 4, &planarFrames<int32_t, int32_t, s32FromS32>,      "S32P → S32"},
+        {AV_SAMPLE_FMT_FLTP, 2, 4, &planarStereoFltToS32,                            "FLTP → S32 (stereo)"},
+        {AV_SAMPLE_FMT_FLTP, 0, 4, &planarFrames<float, int32_t, s32FromFlt>,        "FLTP → S32"},
+    };
+    
+    for (const auto& entry : table) {
+        if (entry.format == format && entry.outputSampleBytes == outputSampleBytes &&
+            (entry.channels == 0 || entry.channels == channels)) {
+            name = entry.name;
+            return entry.kernel;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace PcmKernels
+
+#endif // PCM_KERNELS_H
@@ -0,0 +1,989 @@
+#include "PrefetchIO.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+const int AVIO_BUFFER_SIZE = 64 * 1024;   // FFmpeg-side buffer
+const int FETCH_CHUNK = 256 * 1024;       // Upstream read size
+const int ADAPT_SEGMENTS = 4;             // Segments per connection in a throughput measurement
+const int CEILING_PROBE_WINDOWS = 8;      // Steady measurements before a lowered ceiling is raised
+const int RETRY_DELAY_MS = 250;            // First reconnect delay after a drop
+const int MAX_RETRY_DELAY_MS = 4000;      // Longest reconnect delay
+
+std::atomic<int> s_maxConnections{PrefetchIO::DEFAULT_CONNECTIONS};
+}
+
+PrefetchIO::PrefetchIO() {
+}
+
+PrefetchIO::~PrefetchIO() {
+    close();
+}
+
+void PrefetchIO::setMaxConnections(int connections) {
+    s_maxConnections.store(std::max(1, std::min(connections, MAX_CONNECTIONS)));
+}
+
+bool PrefetchIO::isNetworkURL(const std::string& url) {
+    return url.compare(0, 7, "http://") == 0 || url.compare(0, 8, "https://") == 0;
+}
+
+bool PrefetchIO::open(const std::string& url, int64_t ringSize, AVDictionary** options) {
+    close();
+    m_stop = false;
+    m_url = url;
+    m_stats = Stats();
+    m_fetchSeconds = 0.0;
+    m_recovering = false;
+
+    // ⭐ Media cache hit (or a download still in progress): nothing to request before playback
+    if (MediaCache::enabled()) {
+        m_entry = MediaCache::find(url);
+        m_cacheHit = (m_entry != nullptr);
+    }
+
+    if (m_entry) {
+        m_totalSize = m_entry->size();
+        av_dict_copy(&m_options, *options, 0);
+    } else {
+        if (!openUpstream(0, options)) {
+            return false;
+        }
+        m_totalSize = m_http ? m_http->size() : avio_size(m_upstream);
+        m_validator = upstreamValidator();
+
+        // ⭐ Media cache miss: download the whole track into a new entry
+        if (MediaCache::enabled()) {
+            m_entry = MediaCache::create(url, upstreamValidator());
+            m_writer = (m_entry != nullptr);
+            m_upstreamPos = 0;
+        }
+    }
+
+    if (m_entry) {
+        m_readPos = 0;
+        m_stats.capacity = m_totalSize;
+    } else {
+        openRing(ringSize);
+    }
+
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(AVIO_BUFFER_SIZE));
+    m_avio = buffer ? avio_alloc_context(buffer, AVIO_BUFFER_SIZE, 0, this,
+                                         &PrefetchIO::readPacket, nullptr,
+                                         &PrefetchIO::seekCallback)
+                    : nullptr;
+    if (!m_avio) {
+        std::cerr << "[PrefetchIO] Failed to allocate AVIOContext" << std::endl;
+        av_free(buffer);
+        close();
+        return false;
+    }
+
+    if (m_entry) {
+        m_fillThread = std::thread(&PrefetchIO::cacheThreadFunc, this);
+        DEBUG_LOG("[PrefetchIO] ✓ " << (m_cacheHit ? "Cached track, " : "Caching whole track, ")
+                  << (m_totalSize / 1024) << " KB"
+                  << (m_cacheHit && !m_entry->complete() ? " (download in progress)" : "")
+                  << (connectionReused() ? ", reused connection" : ""));
+        return true;
+    }
+
+    // ⭐ Ranged download: the server has shown Range support, spread the
+    // stream over parallel connections as throughput requires
+    int maxConnections = s_maxConnections.load();
+    if (maxConnections > 1 && m_http && m_totalSize > 0 && m_http->acceptsRanges()) {
+        m_http->close();   // Open-ended response: the workers issue bounded ones
+        m_ranged = true;
+        m_connections = 1;
+        m_connectionLimit = maxConnections;
+        m_connectionCeiling = maxConnections;
+        m_steadyWindows = 0;
+        m_stats.connections = 1;
+        m_segmentSize = std::max<int64_t>(FETCH_CHUNK, std::min<int64_t>(
+            SEGMENT_SIZE, (m_capacity - m_keepBehind) / (2 * maxConnections)));
+        m_scheduleEnd = 0;
+        for (int i = 0; i < maxConnections; i++) {
+            m_workers.emplace_back(&PrefetchIO::rangeWorkerFunc, this, i);
+        }
+
+        DEBUG_LOG("[PrefetchIO] ✓ Prefetching " << (m_capacity / 1024) << " KB ring, stream "
+                  << (m_totalSize / 1024) << " KB in " << (m_segmentSize / 1024)
+                  << " KB ranges, up to " << maxConnections << " connections");
+        return true;
+    }
+
+    m_fillThread = std::thread(&PrefetchIO::fillThreadFunc, this);
+
+    DEBUG_LOG("[PrefetchIO] ✓ Prefetching " << (m_capacity / 1024) << " KB ring"
+              << (m_totalSize > 0 ? ", stream " + std::to_string(m_totalSize / 1024) + " KB"
+                                  : std::string(", stream size unknown"))
+              << (connectionReused() ? ", reused connection" : ""));
+    return true;
+}
+
+void PrefetchIO::openRing(int64_t ringSize) {
+    if (ringSize == WHOLE_TRACK) {
+        ringSize = (m_totalSize > 0) ? std::min(m_totalSize + 1, MAX_WHOLE_TRACK) : DEFAULT_SIZE;
+    } else if (ringSize <= 0) {
+        ringSize = DEFAULT_SIZE;
+    }
+
+    // No point in a ring larger than the whole stream
+    if (m_totalSize > 0 && ringSize > m_totalSize + 1) {
+        ringSize = m_totalSize + 1;
+    }
+
+    m_capacity = std::max<int64_t>(ringSize, 2 * FETCH_CHUNK);
+    m_keepBehind = m_capacity / 8;
+    m_ring.assign(static_cast<size_t>(m_capacity), 0);
+    m_ringStart = m_ringEnd = m_readPos = 0;
+    m_eof = false;
+    m_error = 0;
+    m_seekPending = false;
+    m_stats.capacity = m_capacity;
+}
+
+void PrefetchIO::close() {
+    m_stop = true;
+    m_cv.notify_all();
+    if (m_entry) {
+        m_entry->wake();
+    }
+
+    // Workers first: one may start the fill thread (fallBackToStreamLocked)
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    if (m_fillThread.joinable()) {
+        m_fillThread.join();
+    }
+
+    if (m_avio) {
+        Stats stats = getStats();
+        DEBUG_LOG("[PrefetchIO] Closed: " << (stats.bytesFetched / 1024) << " KB fetched at "
+                  << static_cast<int64_t>(stats.throughput / 1024) << " KB/s, "
+                  << stats.stalls << " stalls (" << static_cast<int>(stats.stallSeconds * 1000) << " ms), "
+                  << stats.windowSeeks << " in-window / " << stats.remoteSeeks << " remote seeks"
+                  << (m_ranged ? ", " + std::to_string(stats.connections) + " connections" : std::string())
+                  << ", " << stats.recoveries << " recoveries ("
+                  << static_cast<int>(stats.recoverySeconds * 1000) << " ms)");
+
+        av_freep(&m_avio->buffer);
+        avio_context_free(&m_avio);
+    }
+
+    // Hands the connection back to the pool if the body was read to the end
+    m_http.reset();
+    if (m_upstream) {
+        avio_closep(&m_upstream);
+    }
+
+    m_ring.clear();
+    m_ring.shrink_to_fit();
+    m_segments.clear();
+    m_ranged = false;
+
+    // The RAM tier keeps the entry for the next open
+    if (m_entry && m_writer) {
+        m_entry->releaseWriter();
+    }
+    m_entry.reset();
+    m_cacheHit = false;
+    m_writer = false;
+    av_dict_free(&m_options);
+}
+
+PrefetchIO::Stats PrefetchIO::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.buffered = m_entry ? m_entry->availableFrom(m_readPos) : m_ringEnd - m_readPos;
+    stats.fillLevel = (stats.capacity > 0) ? static_cast<float>(stats.buffered) / stats.capacity : 0.0f;
+    stats.throughput = (m_fetchSeconds > 0.0) ? stats.bytesFetched / m_fetchSeconds : 0.0;
+    return stats;
+}
+
+// ============================================================================
+// FFmpeg callbacks
+// ============================================================================
+
+int PrefetchIO::readPacket(void* opaque, uint8_t* buf, int size) {
+    return static_cast<PrefetchIO*>(opaque)->read(buf, size);
+}
+
+int64_t PrefetchIO::seekCallback(void* opaque, int64_t offset, int whence) {
+    return static_cast<PrefetchIO*>(opaque)->seek(offset, whence);
+}
+
+int PrefetchIO::interruptCallback(void* opaque) {
+    return static_cast<PrefetchIO*>(opaque)->m_stop.load() ? 1 : 0;
+}
+
+int PrefetchIO::read(uint8_t* buf, int size) {
+    if (m_entry) {
+        return readCached(buf, size);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto ready = [this]() {
+        return m_stop || (!m_seekPending && (m_readPos < m_ringEnd || m_eof || m_error != 0));
+    };
+
+    if (!ready()) {
+        auto waitStart = std::chrono::steady_clock::now();
+        m_cv.wait(lock, ready);
+        m_stats.stalls++;
+        m_stats.stallSeconds += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - waitStart).count();
+    }
+
+    if (m_stop) {
+        return AVERROR_EXIT;
+    }
+
+    if (m_readPos >= m_ringEnd) {
+        return (m_error != 0) ? m_error : AVERROR_EOF;
+    }
+
+    int64_t available = m_ringEnd - m_readPos;
+    int n = static_cast<int>(std::min<int64_t>(size, available));
+
+    size_t offset = static_cast<size_t>(m_readPos % m_capacity);
+    size_t first = std::min(static_cast<size_t>(n), m_ring.size() - offset);
+    std::memcpy(buf, m_ring.data() + offset, first);
+    if (first < static_cast<size_t>(n)) {
+        std::memcpy(buf + first, m_ring.data(), n - first);
+    }
+
+    m_readPos += n;
+    lock.unlock();
+    m_cv.notify_all();   // Room for the fill thread
+
+    return n;
+}
+
+int PrefetchIO::readCached(uint8_t* buf, int size) {
+    int64_t pos;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pos = m_readPos;
+    }
+
+    bool waited = false;
+    auto waitStart = std::chrono::steady_clock::now();
+    int n = m_entry->read(pos, buf, size, m_stop, waited);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (waited) {
+        m_stats.stalls++;
+        m_stats.stallSeconds += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - waitStart).count();
+    }
+
+    if (n == 0) {
+        return AVERROR_EOF;
+    }
+    if (n > 0) {
+        m_readPos = pos + n;
+    }
+    return n;
+}
+
+int64_t PrefetchIO::seek(int64_t offset, int whence) {
+    if (whence & AVSEEK_SIZE) {
+        return (m_totalSize >= 0) ? m_totalSize : AVERROR(ENOSYS);
+    }
+    whence &= ~AVSEEK_FORCE;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    int64_t target;
+    if (whence == SEEK_SET) {
+        target = offset;
+    } else if (whence == SEEK_CUR) {
+        target = m_readPos + offset;
+    } else if (whence == SEEK_END && m_totalSize >= 0) {
+        target = m_totalSize + offset;
+    } else {
+        return AVERROR(EINVAL);
+    }
+
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+
+    // ⭐ Cached track: local unless the bytes are still missing (the writer fetches them first)
+    if (m_entry) {
+        m_readPos = target;
+        bool local = target >= m_totalSize || m_entry->availableFrom(target) > 0;
+        if (local) {
+            m_stats.windowSeeks++;
+        } else {
+            m_stats.remoteSeeks++;
+        }
+        lock.unlock();
+
+        if (!local) {
+            m_entry->want(target);
+        }
+        return target;
+    }
+
+    // Inside the window (or just ahead of it): no new request. Ranged:
+    // segments in flight still commit up to m_scheduleEnd and overwrite
+    // the ring behind it, so a seek further back needs new requests
+    bool inWindow = target >= m_ringStart && target <= m_ringEnd + FETCH_CHUNK;
+    if (m_ranged && target < m_scheduleEnd - (m_capacity - m_keepBehind)) {
+        inWindow = false;
+    }
+    if (!m_seekPending && inWindow) {
+        m_readPos = target;
+        m_stats.windowSeeks++;
+        lock.unlock();
+        m_cv.notify_all();
+        return target;
+    }
+
+    // Ranged: drop the segments in flight, the workers restart from the target
+    if (m_ranged) {
+        m_generation++;
+        m_segments.clear();
+        m_scheduleEnd = target;
+        m_readPos = target;
+        m_ringStart = m_ringEnd = target;
+        m_eof = target >= m_totalSize;
+        m_error = 0;
+        m_recovering = false;
+        m_stats.remoteSeeks++;
+        lock.unlock();
+        m_cv.notify_all();
+        return target;
+    }
+
+    // Outside: the fill thread repositions upstream and restarts the ring there
+    m_seekPending = true;
+    m_seekTarget = target;
+    m_readPos = target;
+    m_ringStart = m_ringEnd = target;
+    m_eof = false;
+    m_error = 0;
+    m_recovering = false;
+    m_stats.remoteSeeks++;
+    lock.unlock();
+    m_cv.notify_all();
+
+    return target;
+}
+
+// ============================================================================
+// Upstream
+// ============================================================================
+
+bool PrefetchIO::openUpstream(int64_t offset, AVDictionary** options) {
+    // Plain HTTP: native client with pooled keep-alive connections
+    std::string host, path;
+    uint16_t port;
+    if (HttpStream::parseURL(m_url, host, port, path)) {
+        m_http = std::make_unique<HttpStream>();
+        m_http->setInterrupt([this]() { return m_stop.load(); });
+        if (!m_http->open(m_url, offset)) {
+            DEBUG_LOG("[PrefetchIO] Native HTTP open failed, using FFmpeg I/O");
+            m_http.reset();
+        }
+    }
+
+    if (!m_http) {
+        AVIOInterruptCB interrupt;
+        interrupt.callback = &PrefetchIO::interruptCallback;
+        interrupt.opaque = this;
+
+        int ret = avio_open2(&m_upstream, m_url.c_str(), AVIO_FLAG_READ, &interrupt, options);
+        if (ret < 0) {
+            std::cerr << "[PrefetchIO] Failed to open upstream: " << m_url.substr(0, 80) << std::endl;
+            m_upstream = nullptr;
+            return false;
+        }
+
+        if (offset > 0 && avio_seek(m_upstream, offset, SEEK_SET) < 0) {
+            std::cerr << "[PrefetchIO] ⚠️  Upstream seek to " << offset << " failed" << std::endl;
+            avio_closep(&m_upstream);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PrefetchIO::reopenUpstream(int64_t offset, bool* changed) {
+    AVDictionary* options = nullptr;
+    av_dict_copy(&options, m_options, 0);
+    bool ok = openUpstream(offset, &options);
+    av_dict_free(&options);
+
+    // The bytes already fetched are only good for the content they came from
+    if (ok && !upstreamValidator().matches(m_entry ? m_entry->validator() : m_validator)) {
+        std::cerr << "[PrefetchIO] ⚠️  Source changed during the download" << std::endl;
+        if (changed) {
+            *changed = true;
+        }
+        m_http.reset();
+        if (m_upstream) {
+            avio_closep(&m_upstream);
+        }
+        return false;
+    }
+    return ok;
+}
+
+MediaCache::Validator PrefetchIO::upstreamValidator() const {
+    MediaCache::Validator validator;
+    validator.length = m_http ? m_http->size() : (m_upstream ? avio_size(m_upstream) : -1);
+    if (m_http) {
+        validator.etag = m_http->etag();
+        validator.lastModified = m_http->lastModified();
+    }
+    return validator;
+}
+
+int PrefetchIO::upstreamRead(uint8_t* buf, int size) {
+    if (m_http) {
+        int n = m_http->read(buf, size);
+        return (n == 0) ? AVERROR_EOF : (n < 0 ? AVERROR(EIO) : n);
+    }
+    if (!m_upstream) {
+        return AVERROR(EIO);
+    }
+    return avio_read(m_upstream, buf, size);
+}
+
+int64_t PrefetchIO::upstreamSeek(int64_t offset) {
+    if (m_http) {
+        return m_http->seek(offset) ? offset : AVERROR(EIO);
+    }
+    if (!m_upstream) {
+        // Lost after a failed recovery: a seek gets a fresh connection
+        return reopenUpstream(offset) ? offset : AVERROR(EIO);
+    }
+    return avio_seek(m_upstream, offset, SEEK_SET);
+}
+
+// ============================================================================
+// Drop recovery
+// ============================================================================
+
+bool PrefetchIO::resumeUpstream(int64_t offset) {
+    while (!m_stop) {
+        int delayMs;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!beginRecoveryLocked()) {
+                return false;
+            }
+            delayMs = retryDelayLocked();
+        }
+
+        // Let go of the broken connection; a changed source is not worth retrying
+        m_http.reset();
+        if (m_upstream) {
+            avio_closep(&m_upstream);
+        }
+        bool changed = false;
+        if (reopenUpstream(offset, &changed)) {
+            DEBUG_LOG("[PrefetchIO] Reconnected at byte " << offset);
+            return true;
+        }
+        if (changed) {
+            return false;
+        }
+
+        // A seek makes this offset moot: the fill thread reopens at the target
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_cv.wait_for(lock, std::chrono::milliseconds(delayMs),
+                          [this]() { return m_stop.load() || m_seekPending; })) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool PrefetchIO::beginRecoveryLocked() {
+    auto now = std::chrono::steady_clock::now();
+    if (!m_recovering) {
+        m_recovering = true;
+        m_dropTime = now;
+        return true;
+    }
+    return std::chrono::duration<double>(now - m_dropTime).count() < RECOVERY_TIMEOUT_S;
+}
+
+void PrefetchIO::endRecoveryLocked(int64_t offset) {
+    if (!m_recovering) {
+        return;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_dropTime).count();
+    m_recovering = false;
+    m_stats.recoveries++;
+    m_stats.recoverySeconds += seconds;
+    std::cout << "[PrefetchIO] ✓ Stream resumed at byte " << offset << " after "
+              << static_cast<int>(seconds * 1000) << " ms, "
+              << ((m_ringEnd - m_readPos) / 1024) << " KB still buffered" << std::endl;
+}
+
+int PrefetchIO::retryDelayLocked() const {
+    // Quick retries for a blip, fewer requests into a server restart
+    int elapsedMs = static_cast<int>(std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - m_dropTime).count());
+    return std::min(MAX_RETRY_DELAY_MS, std::max(RETRY_DELAY_MS, elapsedMs / 2));
+}
+
+// ============================================================================
+// Fill thread
+// ============================================================================
+
+void PrefetchIO::fillThreadFunc() {
+    std::vector<uint8_t> chunk(FETCH_CHUNK);
+
+    while (!m_stop) {
+        int64_t writePos;
+        int toRead;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() {
+                return m_stop || m_seekPending ||
+                       (!m_eof && m_error == 0 && (m_ringEnd - m_readPos) < m_capacity - m_keepBehind);
+            });
+
+            if (m_stop) {
+                break;
+            }
+
+            if (m_seekPending) {
+                int64_t target = m_seekTarget;
+                m_seekPending = false;
+                lock.unlock();
+
+                int64_t ret = upstreamSeek(target);
+
+                lock.lock();
+                if (ret < 0 && !m_seekPending) {
+                    std::cerr << "[PrefetchIO] ⚠️  Upstream seek to " << target << " failed" << std::endl;
+                    m_error = static_cast<int>(ret);
+                }
+                lock.unlock();
+                m_cv.notify_all();
+                continue;
+            }
+
+            writePos = m_ringEnd;
+            int64_t room = m_capacity - m_keepBehind - (m_ringEnd - m_readPos);
+            toRead = static_cast<int>(std::min<int64_t>(FETCH_CHUNK, room));
+        }
+
+        auto fetchStart = std::chrono::steady_clock::now();
+        int n = upstreamRead(chunk.data(), toRead);
+        double fetchTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - fetchStart).count();
+
+        // A body that ends short of the known length is a drop as well
+        bool dropped = (n < 0 && n != AVERROR_EOF) ||
+                       (n <= 0 && m_totalSize > 0 && writePos < m_totalSize);
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            // A seek happened while reading: this data belongs to the old position
+            if (m_seekPending || writePos != m_ringEnd) {
+                continue;
+            }
+
+            if (n <= 0 && !dropped) {
+                m_eof = true;
+            } else if (n <= 0) {
+                if (m_stop) {
+                    continue;
+                }
+
+                // ⭐ Resume at the first missing byte while the decoder plays from the ring
+                if (!m_recovering) {
+                    std::cerr << "[PrefetchIO] ⚠️  Upstream dropped at byte " << writePos << " (" << n << "), "
+                              << ((m_ringEnd - m_readPos) / 1024) << " KB buffered, reconnecting" << std::endl;
+                }
+                lock.unlock();
+                bool resumed = resumeUpstream(writePos);
+                lock.lock();
+
+                if (!resumed && !m_seekPending && !m_stop) {
+                    std::cerr << "[PrefetchIO] ❌ Upstream lost at byte " << writePos << std::endl;
+                    m_error = (n < 0) ? n : AVERROR(EIO);
+                    m_recovering = false;
+                }
+            } else {
+                size_t offset = static_cast<size_t>(writePos % m_capacity);
+                size_t first = std::min(static_cast<size_t>(n), m_ring.size() - offset);
+                std::memcpy(m_ring.data() + offset, chunk.data(), first);
+                if (first < static_cast<size_t>(n)) {
+                    std::memcpy(m_ring.data(), chunk.data() + first, n - first);
+                }
+
+                m_ringEnd += n;
+                m_ringStart = std::max(m_ringStart, m_ringEnd - m_capacity);
+                m_stats.bytesFetched += n;
+                m_fetchSeconds += fetchTime;
+                endRecoveryLocked(writePos);
+            }
+        }
+        m_cv.notify_all();
+    }
+}
+
+// ============================================================================
+// Ranged download
+// ============================================================================
+
+void PrefetchIO::rangeWorkerFunc(int index) {
+    HttpStream http;
+    uint64_t generation = 0;
+    http.setInterrupt([this, &generation]() {
+        return m_stop.load() || m_generation.load() != generation;
+    });
+
+    while (!m_stop) {
+        std::shared_ptr<Segment> segment;
+        int64_t from;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&]() {
+                if (m_stop || !m_ranged) {
+                    return true;
+                }
+                // Workers past the current connection count stay parked
+                if (index >= m_connections || m_error != 0) {
+                    return false;
+                }
+                segment = claimSegmentLocked();
+                return segment != nullptr;
+            });
+
+            if (m_stop || !m_ranged) {
+                break;
+            }
+            generation = m_generation.load();
+            from = segment->start + segment->filled;   // Resumes after a failed attempt
+        }
+
+        auto fetchStart = std::chrono::steady_clock::now();
+        int64_t received = 0;
+        int retryDelayMs = 0;
+        bool ok = http.open(m_url, from, segment->end) && http.status() == 206;
+
+        // ⭐ Range ignored (200 despite Accept-Ranges): retrying cannot help
+        if (!ok && http.status() == 200) {
+            http.close();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (generation == m_generation.load() && m_ranged && !m_stop) {
+                fallBackToStreamLocked();
+            }
+            m_cv.notify_all();
+            break;
+        }
+
+        while (ok && from + received < segment->end) {
+            int64_t want = std::min<int64_t>(FETCH_CHUNK, segment->end - from - received);
+            int n = http.read(segment->data.data() + (from - segment->start) + received,
+                              static_cast<int>(want));
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            received += n;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (generation != m_generation.load()) {
+                    break;
+                }
+                segment->filled += n;
+                endRecoveryLocked(from + received - n);
+                commitSegmentsLocked();
+            }
+            m_cv.notify_all();
+        }
+        double fetchTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - fetchStart).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // A seek dropped this segment while it was being read
+            if (generation != m_generation.load() || m_stop) {
+                continue;
+            }
+
+            segment->assigned = false;
+            if (ok) {
+                m_fetchSeconds += fetchTime / m_connections;
+                adaptConnectionsLocked(received, fetchTime);
+            } else if (!beginRecoveryLocked()) {
+                std::cerr << "[PrefetchIO] ❌ Range " << (from + received) << "-" << segment->end
+                          << " unavailable for " << RECOVERY_TIMEOUT_S << " s" << std::endl;
+                m_error = AVERROR(EIO);
+                m_recovering = false;
+            } else {
+                // The segment is taken again from its first missing byte
+                retryDelayMs = retryDelayLocked();
+                std::cerr << "[PrefetchIO] ⚠️  Range " << (from + received) << "-" << segment->end
+                          << " dropped (status " << http.status() << "), retrying in " << retryDelayMs
+                          << " ms" << std::endl;
+            }
+        }
+        m_cv.notify_all();
+
+        if (retryDelayMs > 0) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, std::chrono::milliseconds(retryDelayMs), [&]() {
+                return m_stop.load() || m_generation.load() != generation;
+            });
+        }
+    }
+
+    http.close();
+}
+
+void PrefetchIO::fallBackToStreamLocked() {
+    std::cerr << "[PrefetchIO] ⚠️  Server ignores Range requests, single stream from byte "
+              << m_ringEnd << std::endl;
+
+    // Segments in flight are dropped; the ring keeps what was committed
+    m_ranged = false;
+    m_generation++;
+    m_segments.clear();
+    m_connections = 1;
+    m_stats.connections = 1;
+    m_recovering = false;
+
+    // The fill thread reopens upstream at the first byte not in the ring
+    m_seekPending = true;
+    m_seekTarget = m_ringEnd;
+    m_fillThread = std::thread(&PrefetchIO::fillThreadFunc, this);
+}
+
+std::shared_ptr<PrefetchIO::Segment> PrefetchIO::claimSegmentLocked() {
+    // A segment given back by a failed worker comes first
+    for (auto& segment : m_segments) {
+        if (!segment->assigned && segment->filled < segment->end - segment->start) {
+            segment->assigned = true;
+            return segment;
+        }
+    }
+
+    // A new one only if it fits in the ring in front of the reader
+    if (m_scheduleEnd >= m_totalSize ||
+        m_scheduleEnd + m_segmentSize - m_readPos > m_capacity - m_keepBehind) {
+        return nullptr;
+    }
+
+    auto segment = std::make_shared<Segment>();
+    segment->start = m_scheduleEnd;
+    segment->end = std::min(m_scheduleEnd + m_segmentSize, m_totalSize);
+    segment->data.resize(static_cast<size_t>(segment->end - segment->start));
+    segment->assigned = true;
+    m_scheduleEnd = segment->end;
+    m_segments.push_back(segment);
+    return segment;
+}
+
+void PrefetchIO::commitSegmentsLocked() {
+    // Segments complete out of order: only the head goes into the ring
+    while (!m_segments.empty()) {
+        Segment& head = *m_segments.front();
+        int64_t n = head.filled - head.committed;
+        if (n > 0) {
+            const uint8_t* src = head.data.data() + head.committed;
+            size_t offset = static_cast<size_t>(m_ringEnd % m_capacity);
+            size_t first = std::min(static_cast<size_t>(n), m_ring.size() - offset);
+            std::memcpy(m_ring.data() + offset, src, first);
+            if (first < static_cast<size_t>(n)) {
+                std::memcpy(m_ring.data(), src + first, n - first);
+            }
+
+            m_ringEnd += n;
+            m_ringStart = std::max(m_ringStart, m_ringEnd - m_capacity);
+            m_stats.bytesFetched += n;
+            head.committed = head.filled;
+        }
+
+        if (head.committed < head.end - head.start) {
+            break;
+        }
+        m_segments.pop_front();
+    }
+
+    if (m_ringEnd >= m_totalSize) {
+        m_eof = true;
+    }
+}
+
+void PrefetchIO::adaptConnectionsLocked(int64_t bytes, double seconds) {
+    m_periodBytes += bytes;
+    m_periodSeconds += seconds;
+    m_periodSegments++;
+    if (m_periodSegments < ADAPT_SEGMENTS * m_connections || m_periodSeconds <= 0.0) {
+        return;
+    }
+
+    // Per-connection rate times the connections running in parallel
+    double throughput = m_periodBytes / m_periodSeconds * m_connections;
+    m_periodBytes = 0;
+    m_periodSeconds = 0.0;
+    m_periodSegments = 0;
+
+    // The last connection added did not pay off: the bottleneck is not per connection
+    if (m_lastThroughput > 0.0 && throughput < m_lastThroughput * 1.1) {
+        m_connections--;
+        m_connectionCeiling = m_connections;
+        m_steadyWindows = 0;
+        DEBUG_LOG("[PrefetchIO] " << static_cast<int64_t>(throughput / 1024) << " KB/s, back to "
+                  << m_connections << " connection(s)");
+    } else if (m_connections < m_connectionCeiling &&
+               (m_ringEnd - m_readPos) < (m_capacity - m_keepBehind) / 2) {
+        // Ring draining: try one more connection, kept only if the total rate rises
+        m_lastThroughput = throughput;
+        m_connections++;
+        m_stats.connections = m_connections;
+        DEBUG_LOG("[PrefetchIO] " << static_cast<int64_t>(throughput / 1024) << " KB/s, adding connection "
+                  << m_connections);
+        return;
+    } else if (m_connectionCeiling < m_connectionLimit && ++m_steadyWindows >= CEILING_PROBE_WINDOWS) {
+        // The dip that lowered the ceiling may have passed (server load, cross traffic)
+        m_connectionCeiling++;
+        m_steadyWindows = 0;
+        DEBUG_LOG("[PrefetchIO] Ceiling back to " << m_connectionCeiling << " connection(s)");
+    }
+
+    m_lastThroughput = 0.0;
+    m_stats.connections = m_connections;
+}
+
+void PrefetchIO::cacheThreadFunc() {
+    std::vector<uint8_t> chunk(FETCH_CHUNK);
+
+    if (m_cacheHit) {
+        revalidate();
+    }
+
+    while (!m_stop) {
+        if (!m_writer) {
+            // Another open of this track is downloading it: take over only if it stops
+            if (!m_entry->claimWriter(m_stop)) {
+                break;
+            }
+            m_writer = true;
+            DEBUG_LOG("[PrefetchIO] Resuming the download of a partially cached track");
+        }
+
+        int64_t end = 0;
+        int64_t next = m_entry->nextMissing(m_upstreamPos, end);
+        if (next < 0) {
+            DEBUG_LOG("[PrefetchIO] ✓ Track fully cached");
+            MediaCache::completed(m_entry);
+            break;
+        }
+
+        bool positioned;
+        if (!m_http && !m_upstream) {
+            positioned = reopenUpstream(next);
+        } else {
+            positioned = (next == m_upstreamPos) || upstreamSeek(next) >= 0;
+        }
+
+        int n = AVERROR(EIO);
+        double fetchTime = 0.0;
+        if (positioned) {
+            m_upstreamPos = next;
+            auto fetchStart = std::chrono::steady_clock::now();
+            n = upstreamRead(chunk.data(), static_cast<int>(std::min<int64_t>(FETCH_CHUNK, end - next)));
+            fetchTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - fetchStart).count();
+        }
+
+        if (m_stop) {
+            break;
+        }
+
+        if (n <= 0) {
+            bool recovering;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                recovering = m_recovering;
+            }
+            if (!recovering) {
+                std::cerr << "[PrefetchIO] ⚠️  Cached download dropped at byte " << next << " (" << n
+                          << "), reconnecting" << std::endl;
+            }
+            if (resumeUpstream(next)) {
+                m_upstreamPos = next;
+                continue;
+            }
+        }
+
+        // Readers waiting on the missing bytes get the error; the next open starts afresh
+        if (n <= 0) {
+            std::cerr << "[PrefetchIO] ⚠️  Cached download failed at byte " << next << " (" << n << ")" << std::endl;
+            m_entry->fail(n == 0 ? AVERROR_EOF : n);
+            MediaCache::invalidate(m_url);
+            break;
+        }
+
+        m_entry->write(next, chunk.data(), n);
+        m_upstreamPos = next + n;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.bytesFetched += n;
+        m_fetchSeconds += fetchTime;
+        endRecoveryLocked(next);
+    }
+
+    if (m_writer) {
+        m_entry->releaseWriter();
+        m_writer = false;
+    }
+}
+
+void PrefetchIO::revalidate() {
+    // Only the built-in client exposes the validators
+    std::string host, path;
+    uint16_t port;
+    if (!HttpStream::parseURL(m_url, host, port, path)) {
+        return;
+    }
+
+    // Headers only: dropping the body costs a connection, not a download
+    HttpStream probe;
+    probe.setInterrupt([this]() { return m_stop.load(); });
+    if (!probe.open(m_url)) {
+        DEBUG_LOG("[PrefetchIO] Revalidation request failed, keeping the cached copy");
+        return;
+    }
+
+    MediaCache::Validator current;
+    current.length = probe.size();
+    current.etag = probe.etag();
+    current.lastModified = probe.lastModified();
+    probe.close();
+
+    if (current.matches(m_entry->validator())) {
+        DEBUG_LOG("[PrefetchIO] Cached copy still valid");
+        return;
+    }
+
+    // This playback keeps the copy it started with; the next open downloads again
+    std::cerr << "[PrefetchIO] ⚠️  Source changed since it was cached, dropping the cached copy" << std::endl;
+    MediaCache::invalidate(m_url);
+}
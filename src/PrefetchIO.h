@@ -0,0 +1,233 @@
+#ifndef PREFETCH_IO_H
+#define PREFETCH_IO_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <deque>
+#include <chrono>
+
+#include "HttpClient.h"
+#include "MediaCache.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief Read-ahead AVIOContext for network sources
+ *
+ * A background thread pulls the stream from the network into a large
+ * ring buffer; FFmpeg reads from the ring through a custom AVIOContext,
+ * so the audio thread never waits on the socket as long as the ring
+ * is ahead. Seeks inside the buffered window are served without a new
+ * request; seeks outside it reposition the upstream connection.
+ *
+ * Plain http:// is fetched with HttpStream, whose keep-alive connections
+ * are pooled across tracks; other protocols (https) go through avio.
+ *
+ * The ring is addressed with absolute stream offsets: it holds bytes
+ * [ringStart, ringEnd), and keeps a slice behind the read position for
+ * the short backward seeks decoders do while probing.
+ *
+ * Ranged download: for plain http:// with a known length and Range
+ * support, the ring is filled by up to MAX_CONNECTIONS workers, each
+ * fetching the next SEGMENT_SIZE byte range on its own keep-alive
+ * connection; segments are committed to the ring in order as their bytes
+ * arrive. Playback starts on one connection; another is added while the
+ * ring is draining, as long as the previous addition raised the aggregate
+ * throughput. One that did not lowers the ceiling, which is raised again
+ * after CEILING_PROBE_WINDOWS steady measurements, so a passing dip does
+ * not cap the rest of the track. Servers without Range keep the single
+ * stream.
+ *
+ * A dropped or stalled connection (read error, timeout, or a body that
+ * ends short of the content length) is not the end of the track: the
+ * upstream is reopened with a Range request at the first byte not yet
+ * received, with growing delays, for up to RECOVERY_TIMEOUT_S, while the
+ * decoder keeps reading from what the ring holds. The byte stream seen by
+ * the demuxer stays continuous, so it needs no resynchronization.
+ *
+ * With the media cache enabled and a known content length, the ring is
+ * replaced by a MediaCache entry holding the whole track: a hit opens
+ * without a request and every seek is local; a miss downloads the track
+ * into a new entry, fetching the range a seek asked for first.
+ */
+class PrefetchIO {
+public:
+    static constexpr int64_t DEFAULT_SIZE = 16 * 1024 * 1024;     // 16 MB
+    static constexpr int64_t WHOLE_TRACK = -1;                     // Size = content length
+    static constexpr int64_t MAX_WHOLE_TRACK = 1024LL * 1024 * 1024;  // 1 GB cap for WHOLE_TRACK
+    static constexpr int MAX_CONNECTIONS = 4;                      // Ranged download ceiling
+    static constexpr int DEFAULT_CONNECTIONS = 1;                  // Single stream unless configured
+    static constexpr int64_t SEGMENT_SIZE = 1024 * 1024;           // Bytes per ranged request
+    static constexpr double RECOVERY_TIMEOUT_S = 30.0;             // Reconnect attempts before a drop is an error
+
+    struct Stats {
+        int64_t capacity = 0;        // Ring size (bytes)
+        int64_t buffered = 0;        // Bytes ahead of the read position
+        float fillLevel = 0.0f;      // buffered / capacity
+        int64_t bytesFetched = 0;    // Total bytes received from upstream
+        double throughput = 0.0;     // Upstream bytes/s while reading
+        int stalls = 0;              // Reads that had to wait for the network
+        double stallSeconds = 0.0;   // Total time spent waiting
+        int windowSeeks = 0;         // Seeks served from the ring or cache
+        int remoteSeeks = 0;         // Seeks that needed a new request
+        int connections = 1;         // Ranged download connections in use
+        int recoveries = 0;          // Dropped connections resumed at their offset
+        double recoverySeconds = 0.0; // Total time from drop to resumed data
+    };
+
+    PrefetchIO();
+    ~PrefetchIO();
+
+    PrefetchIO(const PrefetchIO&) = delete;
+    PrefetchIO& operator=(const PrefetchIO&) = delete;
+
+    /**
+     * @brief Open the upstream URL and start prefetching
+     * @param url Network URL (anything avio_open2 accepts)
+     * @param ringSize Ring size in bytes, or WHOLE_TRACK
+     * @param options Protocol options (reconnect, timeout, user_agent...), consumed
+     * @return true if successful, false otherwise
+     */
+    bool open(const std::string& url, int64_t ringSize, AVDictionary** options);
+
+    /**
+     * @brief Stop the fill thread and close upstream
+     */
+    void close();
+
+    /**
+     * @brief AVIOContext to install as AVFormatContext::pb (AVFMT_FLAG_CUSTOM_IO)
+     */
+    AVIOContext* context() const { return m_avio; }
+
+    Stats getStats() const;
+
+    /**
+     * @brief True for URLs worth prefetching (network protocols)
+     */
+    static bool isNetworkURL(const std::string& url);
+
+    /**
+     * @brief True if the upstream request went out on a pooled connection
+     */
+    bool connectionReused() const { return m_http && m_http->connectionReused(); }
+
+    /**
+     * @brief Upstream ETag (built-in HTTP client only), empty if none
+     */
+    std::string etag() const {
+        return m_entry ? m_entry->validator().etag : (m_http ? m_http->etag() : std::string());
+    }
+
+    /**
+     * @brief True if the track is read from the media cache
+     */
+    bool cached() const { return m_entry != nullptr; }
+
+    /**
+     * @brief Ranged download connection ceiling for streams opened from now on (1 = single stream)
+     */
+    static void setMaxConnections(int connections);
+
+private:
+    static int readPacket(void* opaque, uint8_t* buf, int size);
+    static int64_t seekCallback(void* opaque, int64_t offset, int whence);
+    static int interruptCallback(void* opaque);
+
+    int read(uint8_t* buf, int size);
+    int readCached(uint8_t* buf, int size);
+    int64_t seek(int64_t offset, int whence);
+    void openRing(int64_t ringSize);
+    void fillThreadFunc();
+    void rangeWorkerFunc(int index);
+    void commitSegmentsLocked();
+    void adaptConnectionsLocked(int64_t bytes, double seconds);
+    void fallBackToStreamLocked();
+    void cacheThreadFunc();
+    void revalidate();
+    bool openUpstream(int64_t offset, AVDictionary** options);
+    bool reopenUpstream(int64_t offset, bool* changed = nullptr);
+    bool resumeUpstream(int64_t offset);
+    bool beginRecoveryLocked();
+    void endRecoveryLocked(int64_t offset);
+    int retryDelayLocked() const;
+    int upstreamRead(uint8_t* buf, int size);
+    int64_t upstreamSeek(int64_t offset);
+    MediaCache::Validator upstreamValidator() const;
+
+    // Upstream (one of the two)
+    std::string m_url;
+    std::unique_ptr<HttpStream> m_http;
+    AVIOContext* m_upstream = nullptr;
+    AVIOContext* m_avio = nullptr;
+    int64_t m_totalSize = -1;
+    MediaCache::Validator m_validator;   // Upstream at open, checked on reconnect
+
+    // Media cache (replaces the ring when set)
+    std::shared_ptr<MediaCache::Entry> m_entry;
+    AVDictionary* m_options = nullptr;   // For an upstream opened later
+    bool m_cacheHit = false;
+    bool m_writer = false;               // This instance downloads the entry
+    int64_t m_upstreamPos = 0;
+
+    // Ring (absolute offsets, protected by m_mutex)
+    std::vector<uint8_t> m_ring;
+    int64_t m_capacity = 0;
+    int64_t m_keepBehind = 0;
+    int64_t m_ringStart = 0;
+    int64_t m_ringEnd = 0;
+    int64_t m_readPos = 0;
+    bool m_eof = false;
+    int m_error = 0;
+    bool m_seekPending = false;
+    int64_t m_seekTarget = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_fillThread;
+    std::atomic<bool> m_stop{false};
+
+    // Ranged download (protected by m_mutex)
+    struct Segment {
+        int64_t start = 0;
+        int64_t end = 0;
+        std::vector<uint8_t> data;
+        int64_t filled = 0;          // Bytes received
+        int64_t committed = 0;       // Bytes copied to the ring
+        bool assigned = false;       // A worker is fetching it
+    };
+    bool m_ranged = false;
+    std::deque<std::shared_ptr<Segment>> m_segments;   // In order, the first one at m_ringEnd
+    int64_t m_segmentSize = SEGMENT_SIZE;
+    int64_t m_scheduleEnd = 0;                         // End of the last segment
+    std::atomic<uint64_t> m_generation{0};             // Bumped by seeks: older segments are dropped
+    int m_connections = 1;
+    int m_connectionLimit = MAX_CONNECTIONS;           // Workers started (--http-connections)
+    int m_connectionCeiling = MAX_CONNECTIONS;
+    int64_t m_periodBytes = 0;                         // Current measurement period
+    double m_periodSeconds = 0.0;
+    int m_periodSegments = 0;
+    double m_lastThroughput = 0.0;                     // Aggregate before the last addition
+    int m_steadyWindows = 0;                           // Measurements since the ceiling was lowered
+    std::vector<std::thread> m_workers;
+
+    std::shared_ptr<Segment> claimSegmentLocked();
+
+    // Drop recovery (protected by m_mutex)
+    bool m_recovering = false;
+    std::chrono::steady_clock::time_point m_dropTime;   // First failure of the current drop
+
+    // Statistics (protected by m_mutex)
+    Stats m_stats;
+    double m_fetchSeconds = 0.0;
+};
+
+#endif // PREFETCH_IO_H
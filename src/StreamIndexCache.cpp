@@ -0,0 +1,372 @@
+#include "StreamIndexCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+
+// Logging system
+extern bool g_verbose;
+#define DEBUG_LOG(x) if (g_verbose) { std::cout << x << std::endl; }
+
+namespace {
+
+constexpr char MAGIC[4] = {'D', 'R', 'I', 'X'};
+constexpr int PRUNE_INTERVAL = 64;            // Stores between directory scans
+constexpr uint32_t MAX_BLOB = 16 * 1024 * 1024;
+
+std::mutex s_mutex;
+std::string s_directory;
+std::atomic<int> s_storeCount{0};
+
+uint64_t fnv1a(const std::string& s) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int64_t secondOf(int64_t pts, AVRational timeBase) {
+    return av_rescale_rnd(pts, timeBase.num, timeBase.den, AV_ROUND_DOWN);
+}
+
+bool makeDirectories(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (::mkdir(prefix.c_str(), 0755) < 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+// Native-endian binary fields: the cache never leaves the machine
+template <typename T>
+void put(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void putBlob(std::ofstream& out, const void* data, size_t size) {
+    put(out, static_cast<uint32_t>(size));
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+template <typename T>
+bool get(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool getString(std::ifstream& in, std::string& value) {
+    uint32_t size;
+    if (!get(in, size) || size > MAX_BLOB) {
+        return false;
+    }
+    value.resize(size);
+    return size == 0 || static_cast<bool>(in.read(&value[0], size));
+}
+
+bool getBytes(std::ifstream& in, std::vector<uint8_t>& value) {
+    uint32_t size;
+    if (!get(in, size) || size > MAX_BLOB) {
+        return false;
+    }
+    value.resize(size);
+    return size == 0 || static_cast<bool>(in.read(reinterpret_cast<char*>(value.data()), size));
+}
+
+} // namespace
+
+// ============================================================================
+// Entry
+// ============================================================================
+
+bool StreamIndexCache::Entry::addPoint(int64_t pts, int64_t pos) {
+    if (timeBase.den <= 0 || pts < 0 || pos < 0) {
+        return false;
+    }
+
+    int64_t second = secondOf(pts, timeBase);
+    auto next = std::upper_bound(points.begin(), points.end(), pts,
+                                 [](int64_t value, const SeekPoint& p) { return value < p.pts; });
+
+    if (next != points.begin() && secondOf((next - 1)->pts, timeBase) == second) {
+        return false;
+    }
+
+    // Same second reached earlier than before (playback started after a seek): keep the earlier packet
+    if (next != points.end() && secondOf(next->pts, timeBase) == second) {
+        *next = {pts, pos};
+        return true;
+    }
+
+    points.insert(next, {pts, pos});
+    return true;
+}
+
+const StreamIndexCache::SeekPoint* StreamIndexCache::Entry::pointBefore(int64_t pts) const {
+    auto next = std::upper_bound(points.begin(), points.end(), pts,
+                                 [](int64_t value, const SeekPoint& p) { return value < p.pts; });
+    return (next == points.begin()) ? nullptr : &*(next - 1);
+}
+
+// ============================================================================
+// Cache
+// ============================================================================
+
+void StreamIndexCache::setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_directory.clear();
+
+    if (directory.empty()) {
+        return;
+    }
+
+    if (!makeDirectories(directory) || ::access(directory.c_str(), W_OK) != 0) {
+        std::cerr << "[StreamIndexCache] ⚠️  Cannot use " << directory << ": " << std::strerror(errno)
+                  << ", index cache disabled" << std::endl;
+        return;
+    }
+
+    s_directory = directory;
+    DEBUG_LOG("[StreamIndexCache] Using " << s_directory);
+}
+
+bool StreamIndexCache::enabled() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return !s_directory.empty();
+}
+
+std::string StreamIndexCache::pathFor(const std::string& uri) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.idx", static_cast<unsigned long long>(fnv1a(uri)));
+    return s_directory + "/" + name;
+}
+
+bool StreamIndexCache::load(const std::string& uri, Entry& entry) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_directory.empty()) {
+            return false;
+        }
+        path = pathFor(uri);
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    std::string storedUri;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !get(in, version) || version != FORMAT_VERSION || !getString(in, storedUri)) {
+        return false;
+    }
+
+    // Hash collision
+    if (storedUri != uri) {
+        return false;
+    }
+
+    Entry loaded;
+    uint32_t pointCount = 0;
+    bool ok = get(in, loaded.length) && getString(in, loaded.etag) && getString(in, loaded.demuxer) &&
+              get(in, loaded.codecId) && get(in, loaded.sampleFormat) && get(in, loaded.sampleRate) &&
+              get(in, loaded.channels) && get(in, loaded.bitsPerRawSample) &&
+              get(in, loaded.bitsPerCodedSample) && get(in, loaded.blockAlign) && get(in, loaded.frameSize) &&
+              getBytes(in, loaded.extradata) && get(in, loaded.timeBase.num) && get(in, loaded.timeBase.den) &&
+              get(in, loaded.duration) && get(in, pointCount) && pointCount <= MAX_BLOB / sizeof(SeekPoint);
+
+    if (ok) {
+        loaded.points.resize(pointCount);
+        ok = pointCount == 0 ||
+             static_cast<bool>(in.read(reinterpret_cast<char*>(loaded.points.data()),
+                                       pointCount * sizeof(SeekPoint)));
+    }
+
+    if (!ok || !loaded.valid()) {
+        std::cerr << "[StreamIndexCache] ⚠️  Corrupt entry " << path << ", ignored" << std::endl;
+        return false;
+    }
+
+    entry = std::move(loaded);
+    return true;
+}
+
+void StreamIndexCache::store(const std::string& uri, const Entry& entry) {
+    if (!entry.valid()) {
+        return;
+    }
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_directory.empty()) {
+            return;
+        }
+        path = pathFor(uri);
+    }
+    std::string temp = path + ".tmp" + std::to_string(::getpid());
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            DEBUG_LOG("[StreamIndexCache] Cannot write " << temp);
+            return;
+        }
+
+        out.write(MAGIC, sizeof(MAGIC));
+        put(out, FORMAT_VERSION);
+        putBlob(out, uri.data(), uri.size());
+        put(out, entry.length);
+        putBlob(out, entry.etag.data(), entry.etag.size());
+        putBlob(out, entry.demuxer.data(), entry.demuxer.size());
+        put(out, entry.codecId);
+        put(out, entry.sampleFormat);
+        put(out, entry.sampleRate);
+        put(out, entry.channels);
+        put(out, entry.bitsPerRawSample);
+        put(out, entry.bitsPerCodedSample);
+        put(out, entry.blockAlign);
+        put(out, entry.frameSize);
+        putBlob(out, entry.extradata.data(), entry.extradata.size());
+        put(out, entry.timeBase.num);
+        put(out, entry.timeBase.den);
+        put(out, entry.duration);
+        put(out, static_cast<uint32_t>(entry.points.size()));
+        out.write(reinterpret_cast<const char*>(entry.points.data()),
+                  static_cast<std::streamsize>(entry.points.size() * sizeof(SeekPoint)));
+
+        if (!out) {
+            out.close();
+            std::remove(temp.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return;
+    }
+
+    DEBUG_LOG("[StreamIndexCache] 💾 Stored " << entry.points.size() << " seek points ("
+              << entry.demuxer << ")");
+
+    if (s_storeCount++ % PRUNE_INTERVAL == 0) {
+        prune();
+    }
+}
+
+void StreamIndexCache::prune() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    DIR* dir = ::opendir(s_directory.c_str());
+    if (!dir) {
+        return;
+    }
+
+    std::vector<std::pair<time_t, std::string>> files;
+    while (struct dirent* e = ::readdir(dir)) {
+        std::string name = e->d_name;
+        if (name.size() < 4 || name.compare(name.size() - 4, 4, ".idx") != 0) {
+            continue;
+        }
+        std::string path = s_directory + "/" + name;
+        struct stat st;
+        if (::stat(path.c_str(), &st) == 0) {
+            files.emplace_back(st.st_mtime, path);
+        }
+    }
+    ::closedir(dir);
+
+    if (files.size() <= MAX_ENTRIES) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end());
+    size_t excess = files.size() - MAX_ENTRIES;
+    for (size_t i = 0; i < excess; i++) {
+        std::remove(files[i].second.c_str());
+    }
+    DEBUG_LOG("[StreamIndexCache] Pruned " << excess << " old entries");
+}
+
+void StreamIndexCache::capture(const AVFormatContext* format, const AVStream* stream, Entry& entry) {
+    const AVCodecParameters* par = stream->codecpar;
+
+    // "mov,mp4,m4a,..." is not a name av_find_input_format() accepts
+    std::string name = format->iformat->name;
+    entry.demuxer = name.substr(0, name.find(','));
+
+    entry.codecId = par->codec_id;
+    entry.sampleFormat = par->format;
+    entry.sampleRate = par->sample_rate;
+    entry.channels = par->ch_layout.nb_channels;
+    entry.bitsPerRawSample = par->bits_per_raw_sample;
+    entry.bitsPerCodedSample = par->bits_per_coded_sample;
+    entry.blockAlign = par->block_align;
+    entry.frameSize = par->frame_size;
+    entry.extradata.assign(par->extradata, par->extradata + std::max(par->extradata_size, 0));
+    entry.timeBase = stream->time_base;
+    entry.duration = stream->duration;
+}
+
+bool StreamIndexCache::apply(const Entry& entry, AVStream* stream) {
+    AVCodecParameters* par = stream->codecpar;
+
+    // What the header did give must agree with the entry
+    if (par->codec_id != entry.codecId || av_cmp_q(stream->time_base, entry.timeBase) != 0 ||
+        (par->sample_rate > 0 && par->sample_rate != entry.sampleRate) ||
+        (par->ch_layout.nb_channels > 0 && par->ch_layout.nb_channels != entry.channels)) {
+        return false;
+    }
+
+    if (par->format < 0) {
+        par->format = entry.sampleFormat;
+    }
+    if (par->sample_rate <= 0) {
+        par->sample_rate = entry.sampleRate;
+    }
+    if (par->ch_layout.nb_channels <= 0) {
+        av_channel_layout_default(&par->ch_layout, entry.channels);
+    }
+    if (par->bits_per_raw_sample == 0) {
+        par->bits_per_raw_sample = entry.bitsPerRawSample;
+    }
+    if (par->bits_per_coded_sample == 0) {
+        par->bits_per_coded_sample = entry.bitsPerCodedSample;
+    }
+    if (par->block_align == 0) {
+        par->block_align = entry.blockAlign;
+    }
+    if (par->frame_size == 0) {
+        par->frame_size = entry.frameSize;
+    }
+    if (!par->extradata && !entry.extradata.empty()) {
+        par->extradata = static_cast<uint8_t*>(av_mallocz(entry.extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!par->extradata) {
+            return false;
+        }
+        std::memcpy(par->extradata, entry.extradata.data(), entry.extradata.size());
+        par->extradata_size = static_cast<int>(entry.extradata.size());
+    }
+    if (stream->duration == AV_NOPTS_VALUE) {
+        stream->duration = entry.duration;
+    }
+
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef STREAM_INDEX_CACHE_H
+#define STREAM_INDEX_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief Persistent per-URI stream parameters and seek index
+ *
+ * While a compressed track plays, the byte offset of the first packet of
+ * every second is recorded. With the demuxer name, codec parameters and
+ * duration, this is stored on disk under a hash of the URI and checked
+ * against the content length and ETag on the next open. A hit lets the
+ * decoder skip avformat_find_stream_info, and a seek jumps straight to the
+ * byte offset of the second before the target instead of letting FFmpeg
+ * bisect the stream with range requests.
+ *
+ * Entries are small (16 bytes per second of audio). The oldest files are
+ * dropped once the directory holds more than MAX_ENTRIES.
+ */
+class StreamIndexCache {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t MAX_ENTRIES = 4096;
+    static constexpr const char* DEFAULT_DIRECTORY = "/var/cache/diretta-renderer/index";
+
+    struct SeekPoint {
+        int64_t pts;     // Stream time base
+        int64_t pos;     // Byte offset of the packet
+    };
+
+    struct Entry {
+        // Validators
+        int64_t length = -1;          // Content length, -1 = unknown
+        std::string etag;             // HTTP ETag, empty if none
+
+        // Stream
+        std::string demuxer;          // First name of the AVInputFormat
+        int32_t codecId = 0;
+        int32_t sampleFormat = -1;
+        int32_t sampleRate = 0;
+        int32_t channels = 0;
+        int32_t bitsPerRawSample = 0;
+        int32_t bitsPerCodedSample = 0;
+        int32_t blockAlign = 0;
+        int32_t frameSize = 0;
+        std::vector<uint8_t> extradata;
+        AVRational timeBase = {0, 1};
+        int64_t duration = AV_NOPTS_VALUE;   // Stream time base
+
+        // Seek index, sorted by pts, at most one point per second
+        std::vector<SeekPoint> points;
+
+        bool valid() const { return !demuxer.empty() && codecId != 0 && timeBase.den > 0; }
+
+        /**
+         * @brief Record a packet position if its second has no point yet
+         * @return true if a point was added
+         */
+        bool addPoint(int64_t pts, int64_t pos);
+
+        /**
+         * @brief Last point at or before pts, nullptr if none
+         */
+        const SeekPoint* pointBefore(int64_t pts) const;
+    };
+
+    /**
+     * @brief Set the cache directory (created if missing); empty disables the cache
+     */
+    static void setDirectory(const std::string& directory);
+    static bool enabled();
+
+    /**
+     * @brief Read the entry for uri
+     * @return true if a well-formed entry exists (validators not checked)
+     */
+    static bool load(const std::string& uri, Entry& entry);
+
+    /**
+     * @brief Write the entry for uri (atomic replace)
+     */
+    static void store(const std::string& uri, const Entry& entry);
+
+    /**
+     * @brief Fill the stream fields of entry from an opened, probed input
+     */
+    static void capture(const AVFormatContext* format, const AVStream* stream, Entry& entry);
+
+    /**
+     * @brief Fill what a header-only open left unset in the stream
+     * @return false if the stream is not the cached one
+     */
+    static bool apply(const Entry& entry, AVStream* stream);
+
+private:
+    static std::string pathFor(const std::string& uri);
+    static void prune();
+};
+
+#endif // STREAM_INDEX_CACHE_H
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <cstdlib>
@@ -421,6 +422,7 @@ int UPnPDevice::actionSetAVTransportURI(UpnpActionRequest* request) {
     m_currentTrackURI = uri;
     m_currentTrackMetadata = metadata;
     m_currentPosition = 0;
+    m_clockHorizon = 0.0;
     m_trackDuration = 0;
     
     // Effacer l'ancienne queue gapless (nouveau contexte)
@@ -533,6 +535,7 @@ int UPnPDevice::actionStop(UpnpActionRequest* request) {
               << " → STOPPED");
     m_transportState = "STOPPED";
     m_currentPosition = 0;
+    m_clockHorizon = 0.0;
     
     // Effacer la queue gapless
     if (!m_nextURI.empty()) {
@@ -623,8 +626,9 @@ int UPnPDevice::actionGetPositionInfo(UpnpActionRequest* request) {
     addResponseArg(response, "TrackDuration", formatTime(m_trackDuration));
     addResponseArg(response, "TrackMetaData", m_currentTrackMetadata);
     addResponseArg(response, "TrackURI", m_currentTrackURI);
-    addResponseArg(response, "RelTime", formatTime(m_currentPosition));
-    addResponseArg(response, "AbsTime", formatTime(m_currentPosition));
+    int position = currentPositionLocked();
+    addResponseArg(response, "RelTime", formatTime(position));
+    addResponseArg(response, "AbsTime", formatTime(position));
     addResponseArg(response, "RelCount", "2147483647");
     addResponseArg(response, "AbsCount", "2147483647");
     
@@ -751,8 +755,8 @@ std::string UPnPDevice::createPositionInfoXML() const {
     std::stringstream ss;
     ss << "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
        << "<InstanceID val=\"0\">"
-       << "<RelTime val=\"" << formatTime(m_currentPosition) << "\"/>"
-       << "<AbsTime val=\"" << formatTime(m_currentPosition) << "\"/>"
+       << "<RelTime val=\"" << formatTime(currentPositionLocked()) << "\"/>"
+       << "<AbsTime val=\"" << formatTime(currentPositionLocked()) << "\"/>"
        << "</InstanceID>"
        << "</Event>";
     return ss.str();
@@ -1357,6 +1361,17 @@ std::string UPnPDevice::getDeviceURL() const {
 void UPnPDevice::setCurrentPosition(int seconds) {
     std::lock_guard<std::mutex> lock(m_stateMutex);
     m_currentPosition = seconds;
+    m_clockHorizon = 0.0;
+}
+
+// Position as of now: advances with the playback clock while playing
+int UPnPDevice::currentPositionLocked() const {
+    if (m_clockHorizon <= 0.0 || m_transportState != "PLAYING") {
+        return m_currentPosition;
+    }
+    
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_clockTime).count();
+    return static_cast<int>(m_clockSeconds + std::max(0.0, std::min(elapsed, m_clockHorizon)));
 }
 
 // Set track duration (called when track starts)
@@ -1397,8 +1412,23 @@ void UPnPDevice::notifyPositionChange(int seconds, int duration) {
     {
         std::lock_guard<std::mutex> lock(m_stateMutex);
         m_currentPosition = seconds;
+        m_clockHorizon = 0.0;
         m_trackDuration = duration;
     }
     // Send AVTransport event to notify subscribers (mConnect, BubbleUPnP)
     sendAVTransportEvent();
+}
+
+// Notify position from the output clock (sends event to subscribers)
+void UPnPDevice::notifyPlaybackPosition(double seconds, double horizon,
+                                        std::chrono::steady_clock::time_point at, int duration) {
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_clockSeconds = seconds;
+        m_clockHorizon = horizon;
+        m_clockTime = at;
+        m_currentPosition = static_cast<int>(seconds);
+        m_trackDuration = duration;
+    }
+    sendAVTransportEvent();
 }
\ No newline at end of file
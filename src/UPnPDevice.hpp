@@ -7,6 +7,7 @@
 #include <memory>
 #include <mutex>
 #include <map>
+#include <chrono>
 #include "ProtocolInfoBuilder.h"
 
 /**
@@ -70,6 +71,8 @@ public:
     void notifyStateChange(const std::string& state);
     void notifyTrackChange(const std::string& uri, const std::string& metadata);
     void notifyPositionChange(int seconds, int duration);
+    void notifyPlaybackPosition(double seconds, double horizon,
+                                std::chrono::steady_clock::time_point at, int duration);
     void notifyVolumeChange(int volume);
     
     // Getters
@@ -99,6 +102,9 @@ private:
     // Instance callback
     int upnpCallback(Upnp_EventType eventType, const void* event);
     
+    // Position for GetPositionInfo, interpolated from the playback clock
+    int currentPositionLocked() const;
+    
     // Handlers
     int handleActionRequest(UpnpActionRequest* request);
     int handleSubscriptionRequest(UpnpSubscriptionRequest* request);
@@ -166,6 +172,9 @@ private:
     std::string m_nextURI;
     std::string m_nextMetadata;
     int m_currentPosition;             // seconds
+    double m_clockSeconds = 0.0;       // Audible position at m_clockTime
+    double m_clockHorizon = 0.0;       // Seconds it may advance past it (0 = fixed)
+    std::chrono::steady_clock::time_point m_clockTime;
     int m_trackDuration;               // seconds
     std::string m_currentTrackURI;
     std::string m_currentTrackMetadata;
@@ -5,12 +5,15 @@
 
 #include "DirettaRenderer.h"
 #include "DirettaOutput.h"
+#include "AudioEngine.h"
 #include <iostream>
 #include <csignal>
 #include <memory>
 #include <thread>
 #include <chrono>
 #include <iomanip>    // ⭐ v1.3.0: Pour std::fixed, std::setprecision
+#include <vector>
+#include <algorithm>
 
 // Version information
 #define RENDERER_VERSION "1.3.0"    // ⭐ v1.3.0: Transfer mode option (VarMax/Fix)
@@ -49,6 +52,127 @@ void listTargets() {
     std::cout << std::endl;
 }
 
+// Decode benchmark: realtime factor per decoder worker count
+void benchDecode(const std::string& url) {
+    const double BENCH_SECONDS = 60.0;   // Audio decoded per pass
+    const size_t CHUNK = 8192;           // Samples per readSamples() call
+    
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> workers;
+    for (int n = 1; n <= std::min(cores, 8); n *= 2) {
+        workers.push_back(n);
+    }
+    if (cores <= 8 && workers.back() != cores) {
+        workers.push_back(cores);
+    }
+    
+    std::cout << "════════════════════════════════════════════════════════\n"
+              << "  ⏱️  Decode benchmark (" << cores << " cores)\n"
+              << "════════════════════════════════════════════════════════\n" << std::endl;
+    
+    std::vector<std::pair<int, double>> results;
+    
+    // First pass (1 worker) only warms the file and page caches
+    workers.insert(workers.begin(), 1);
+    for (size_t pass = 0; pass < workers.size(); pass++) {
+        AudioDecoder decoder;
+        decoder.setPrefetchSize(PrefetchIO::WHOLE_TRACK);
+        decoder.setDecodeThreads(workers[pass]);
+        if (!decoder.open(url)) {
+            std::cerr << "❌ Cannot open " << url << std::endl;
+            return;
+        }
+        
+        const TrackInfo& info = decoder.getTrackInfo();
+        if (info.isDSD) {
+            std::cerr << "❌ DSD is not decoded, nothing to measure" << std::endl;
+            return;
+        }
+        uint32_t bits = (info.bitDepth == 16) ? 16 : 32;
+        size_t limit = static_cast<size_t>(BENCH_SECONDS * info.sampleRate);
+        
+        AudioBuffer buffer;
+        size_t samples = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (samples < limit) {
+            size_t n = decoder.readSamples(buffer, CHUNK, info.sampleRate, bits);
+            if (n == 0) {
+                break;
+            }
+            samples += n;
+        }
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double audio = static_cast<double>(samples) / info.sampleRate;
+        
+        if (pass > 0 && wall > 0.0) {
+            results.emplace_back(workers[pass], audio / wall);
+            std::cout << "  " << workers[pass] << " worker(s): " << std::fixed << std::setprecision(1)
+                      << (audio / wall) << "x realtime (" << audio << "s of " << info.sampleRate << "Hz/"
+                      << info.bitDepth << "bit in " << static_cast<int>(wall * 1000) << "ms)" << std::endl;
+        }
+    }
+    
+    std::cout << "\n📊 Realtime factor by worker count:" << std::endl;
+    for (const auto& r : results) {
+        std::cout << "   " << r.first << ": " << std::fixed << std::setprecision(1) << r.second << "x"
+                  << (r.first > 1 ? " (" + std::to_string(static_cast<int>(100.0 * r.second / results[0].second))
+                                    + "% of 1 worker)" : std::string()) << std::endl;
+    }
+    
+    // Fixed output: rate conversion cost (same file decoded at the source
+    // rate, then converted) and latency of the converted stream
+    AudioDecoder probe;
+    if (probe.open(url) && probe.resamples()) {
+        TrackInfo source = probe.getSourceInfo();
+        TrackInfo output = probe.getTrackInfo();
+        probe.close();
+        
+        double wall[2] = {0.0, 0.0};
+        double audio = 0.0, firstMs = 0.0, delayMs = 0.0;
+        for (int convert = 0; convert < 2; convert++) {
+            AudioDecoder decoder;
+            decoder.setPrefetchSize(PrefetchIO::WHOLE_TRACK);
+            if (!decoder.open(url)) {
+                return;
+            }
+            uint32_t rate = convert ? output.sampleRate : source.sampleRate;
+            uint32_t bits = convert ? output.bitDepth : ((source.bitDepth == 16) ? 16 : 32);
+            size_t limit = static_cast<size_t>(BENCH_SECONDS * rate);
+            
+            AudioBuffer buffer;
+            size_t samples = 0;
+            auto start = std::chrono::steady_clock::now();
+            while (samples < limit) {
+                size_t n = decoder.readSamples(buffer, CHUNK, rate, bits);
+                if (n == 0) {
+                    break;
+                }
+                if (convert && samples == 0) {
+                    firstMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    delayMs = decoder.resamplerDelayMs();
+                }
+                samples += n;
+            }
+            wall[convert] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            audio = static_cast<double>(samples) / rate;
+        }
+        
+        if (audio > 0.0 && wall[0] > 0.0 && wall[1] > 0.0) {
+            std::cout << "\n🔒 Fixed output " << source.sampleRate << "Hz/" << source.bitDepth << "bit → "
+                      << output.sampleRate << "Hz/" << output.bitDepth << "bit:" << std::endl;
+            std::cout << "   Decode only:     " << std::fixed << std::setprecision(1)
+                      << (audio / wall[0]) << "x realtime" << std::endl;
+            std::cout << "   With conversion: " << (audio / wall[1]) << "x realtime" << std::endl;
+            std::cout << "   Resampler CPU:   " << std::setprecision(2)
+                      << (100.0 * std::max(0.0, wall[1] - wall[0]) / audio) << "% of one core" << std::endl;
+            std::cout << "   Latency:         " << std::setprecision(1) << firstMs << " ms to the first "
+                      << CHUNK << " samples, " << delayMs << " ms held in the filter" << std::endl;
+        }
+    }
+    
+    std::cout << "\n💡 Use the result with: --decode-threads <n>" << std::endl;
+}
+
 // Parse command line arguments
 DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
     DirettaRenderer::Config config;
@@ -58,6 +182,9 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
     config.port = 0;  // 0 = auto
     config.gaplessEnabled = true;
     config.bufferSeconds = 2.0f;  // Default 2 seconds (v1.0.9)
+    config.lingerSeconds = 0.0f;  // Default: close on Stop
+    config.seekFlush = true;      // Default: drop buffered audio on seek
+    config.prefetchMB = 16;       // Default: 16 MB HTTP read-ahead
     
     // ⭐ v1.3.0: Transfer mode default
     config.transferMode = TransferMode::VarMax;
@@ -68,6 +195,12 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
     config.cycleMinTime = 333;    // Default: 333µs
     config.infoCycle = 100000;      // Default: 100ms
     config.mtuOverride = 0;       // 0 = auto-detect
+    config.mtuCeiling = 16128;    // Path-MTU probe ceiling
+    config.mtuEchoPort = 0;       // No echo responder: SDK measurement only
+    config.cycleAutoTune = false; // Default: calculated cycle time
+    config.targetLatencyMs = 0;   // Default: SDK buffer only
+    config.fixedOutputRate = 0;   // Default: native rate per track
+    config.fixedOutputBits = 24;
     
     // ⭐ NEW: Network interface (empty = auto-detect)
     config.networkInterface = "";
@@ -93,6 +226,78 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
                 std::cerr << "⚠️  Warning: Buffer < 1 second may cause issues with DSD/Hi-Res!" << std::endl;
             }
         }
+        else if (arg == "--linger" && i + 1 < argc) {
+            config.lingerSeconds = std::atof(argv[++i]);
+            if (config.lingerSeconds < 0.0f) {
+                config.lingerSeconds = 0.0f;
+            }
+        }
+        else if (arg == "--no-seek-flush") {
+            config.seekFlush = false;
+        }
+        else if (arg == "--prefetch" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "track") {
+                config.prefetchMB = -1;
+            } else {
+                config.prefetchMB = std::atoi(value.c_str());
+                if (config.prefetchMB < 0) {
+                    config.prefetchMB = 0;
+                }
+            }
+        }
+        else if (arg == "--decode-threads" && i + 1 < argc) {
+            config.decodeThreads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--memory-play" && i + 1 < argc) {
+            config.memoryPlayMB = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--memory-play-next") {
+            config.memoryPlayNext = true;
+        }
+        else if (arg == "--bench-decode" && i + 1 < argc) {
+            benchDecode(argv[++i]);
+            exit(0);
+        }
+        else if (arg == "--index-cache" && i + 1 < argc) {
+            std::string value = argv[++i];
+            config.indexCacheDir = (value == "off") ? "" : value;
+        }
+        else if (arg == "--media-cache" && i + 1 < argc) {
+            std::string value = argv[++i];
+            config.mediaCache = (value == "off") ? "" : value;
+        }
+        else if (arg == "--media-cache-size" && i + 1 < argc) {
+            config.mediaCacheMB = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--http-connections" && i + 1 < argc) {
+            config.httpConnections = std::max(1, std::min(std::atoi(argv[++i]), PrefetchIO::MAX_CONNECTIONS));
+        }
+        else if (arg == "--mmap-input" && i + 1 < argc) {
+            config.mmapInput = (std::string(argv[++i]) != "off");
+        }
+        else if (arg == "--pcm-cache" && i + 1 < argc) {
+            std::string value = argv[++i];
+            config.pcmCacheDir = (value == "off") ? ""
+                               : (value == "on") ? PcmCache::DEFAULT_DIRECTORY : value;
+        }
+        else if (arg == "--pcm-cache-size" && i + 1 < argc) {
+            config.pcmCacheMB = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--fixed-output" && i + 1 < argc) {
+            std::string value = argv[++i];
+            size_t slash = value.find('/');
+            config.fixedOutputRate = (value == "off") ? 0 : std::max(0, std::atoi(value.c_str()));
+            if (slash != std::string::npos) {
+                config.fixedOutputBits = std::atoi(value.c_str() + slash + 1);
+            }
+            if (config.fixedOutputBits != 16 && config.fixedOutputBits != 32) {
+                config.fixedOutputBits = 24;
+            }
+            // Applied now as well, so that --bench-decode measures the conversion
+            AudioDecoder::setFixedOutput(static_cast<uint32_t>(config.fixedOutputRate),
+                                         static_cast<uint32_t>(config.fixedOutputBits));
+        }
         else if ((arg == "--target" || arg == "-t") && i + 1 < argc) {
             config.targetIndex = std::atoi(argv[++i]) - 1;  // Convert to 0-based index
             if (config.targetIndex < 0) {
@@ -112,6 +317,16 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
         else if ((arg == "--cycle-min-time") && i + 1 < argc) {
             config.cycleMinTime = std::atoi(argv[++i]);
         }
+        else if (arg == "--cycle-autotune") {
+            config.cycleAutoTune = true;
+        }
+        else if (arg == "--cycle-tune-cache" && i + 1 < argc) {
+            std::string value = argv[++i];
+            config.cycleTuneDir = (value == "off") ? "" : value;
+        }
+        else if ((arg == "--target-latency") && i + 1 < argc) {
+            config.targetLatencyMs = std::max(0, std::atoi(argv[++i]));
+        }
         else if ((arg == "--info-cycle") && i + 1 < argc) {
             config.infoCycle = std::atoi(argv[++i]);
         }
@@ -121,6 +336,19 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
                 std::cerr << "⚠️  Warning: MTU < 1500 may cause issues" << std::endl;
             }
         }
+        else if ((arg == "--mtu-ceiling") && i + 1 < argc) {
+            config.mtuCeiling = std::atoi(argv[++i]);
+            if (config.mtuCeiling < 1280) {
+                std::cerr << "⚠️  Warning: MTU ceiling < 1280, using 1280" << std::endl;
+                config.mtuCeiling = 1280;
+            }
+        }
+        else if (arg == "--metrics-file" && i + 1 < argc) {
+            config.metricsFile = argv[++i];
+        }
+        else if ((arg == "--mtu-echo") && i + 1 < argc) {
+            config.mtuEchoPort = std::max(0, std::min(std::atoi(argv[++i]), 65535));
+        }
         // ⭐ v1.3.0: Transfer mode option
         else if (arg == "--transfer-mode" && i + 1 < argc) {
             std::string mode = argv[++i];
@@ -171,6 +399,22 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
                       << "  --port, -p <port>     UPnP port (default: auto)\n"
                       << "  --uuid <uuid>         Device UUID (default: auto-generated)\n"
                       << "  --buffer, -b <secs>   Buffer size in seconds (default: 2.0)\n"
+                      << "  --linger <secs>       Keep Diretta session warm after Stop (default: 0)\n"
+                      << "  --no-seek-flush       Let buffered audio play out on seek (latency baseline)\n"
+                      << "  --prefetch <MB|track> HTTP read-ahead buffer, 0 = off (default: 16)\n"
+                      << "  --http-connections <n> Parallel range connections per HTTP track, 1 = single stream (default: 1, max: 4)\n"
+                      << "  --index-cache <dir|off> Seek index cache (default: /var/cache/diretta-renderer/index)\n"
+                      << "  --media-cache <ram|dir|off> Cache whole tracks in RAM (+ disk at dir) (default: off)\n"
+                      << "  --media-cache-size <MB> Disk tier size cap (default: 4096)\n"
+                      << "  --mmap-input <on|off> Map local files instead of FFmpeg file I/O (default: on)\n"
+                      << "  --pcm-cache <dir|on|off> Cache decoded tracks, sink-ready (default: off, on = /var/cache/diretta-renderer/pcm)\n"
+                      << "  --pcm-cache-size <MB>  Decoded-PCM cache size cap (default: 16384)\n"
+                      << "  --fixed-output <Hz>[/<bits>|off] Convert all PCM to one format, sink stays locked (default: off)\n"
+                      << "  --decode-threads <n>  Frame-parallel decoder workers, FLAC/ALAC (default: 1)\n"
+                      << "  --memory-play <MB>    Decode whole tracks into locked RAM, cap per track, 0 = off (default: 0)\n"
+                      << "  --memory-play-next    Memory play also decodes the next track in full\n"
+                      << "  --bench-decode <file> Print decode realtime factor per worker count and exit\n"
+                      << "                        (after --fixed-output: resampler cost and latency too)\n"
                       << "  --target, -t <index>  Select Diretta target by index (1, 2, 3...)\n"
                       << "  --list-targets, -l    List available Diretta targets and exit\n"
                       << "  --verbose, -v         Enable verbose debug output\n"
@@ -208,8 +452,15 @@ DirettaRenderer::Config parseArguments(int argc, char* argv[]) {
                       << "                          Fix mode: Fixed cycle time (REQUIRED)\n"
                       << "                          Examples: 1893 (528 Hz), 2000 (500 Hz)\n"
                       << "  --cycle-min-time <µs>   Transfer packet cycle min time (default: 333)\n"
+                      << "  --cycle-autotune        Tune cycle time from buffer feedback, per target/format\n"
+                      << "  --cycle-tune-cache <dir|off> Tuned cycle times across restarts\n"
+                      << "                          (default: /var/cache/diretta-renderer/cycle)\n"
+                      << "  --target-latency <ms>   Target/DAC latency subtracted from the position (default: 0)\n"
                       << "  --info-cycle <µs>       Information packet cycle time (default: 5000)\n"
                       << "  --mtu <bytes>           Override MTU (default: auto-detect)\n"
+                      << "  --mtu-ceiling <bytes>   Largest MTU tried by path-MTU probing (default: 16128)\n"
+                      << "  --metrics-file <path>   Write Prometheus text metrics every second (default: off)\n"
+                      << "  --mtu-echo <port>       Confirm jumbo sizes via a UDP echo responder on the target (default: off)\n"
                       << "\n"                     
                       << "Target Selection:\n"
                       << "  First, scan for targets:  " << argv[0] << " --list-targets\n"
@@ -284,6 +535,36 @@ int main(int argc, char* argv[]) {
     std::cout << "  Port:        " << (config.port == 0 ? "auto" : std::to_string(config.port)) << std::endl;
     std::cout << "  Gapless:     " << (config.gaplessEnabled ? "enabled" : "disabled") << std::endl;
     std::cout << "  Buffer:      " << config.bufferSeconds << " seconds" << std::endl;
+    if (config.lingerSeconds > 0.0f)
+        std::cout << "  Linger:      " << config.lingerSeconds << " seconds after Stop" << std::endl;
+    if (!config.seekFlush)
+        std::cout << "  Seek flush:  disabled (buffered audio plays out)" << std::endl;
+    std::cout << "  Prefetch:    "
+              << (config.prefetchMB < 0 ? std::string("whole track")
+                  : config.prefetchMB == 0 ? std::string("disabled")
+                  : std::to_string(config.prefetchMB) + " MB") << std::endl;
+    if (config.prefetchMB != 0 && config.httpConnections > 1)
+        std::cout << "  HTTP:        up to " << config.httpConnections << " range connections per track" << std::endl;
+    if (!config.mmapInput)
+        std::cout << "  Local files: FFmpeg file I/O (mmap off)" << std::endl;
+    std::cout << "  Index cache: " << (config.indexCacheDir.empty() ? "disabled" : config.indexCacheDir) << std::endl;
+    if (!config.mediaCache.empty())
+        std::cout << "  Media cache: RAM (current + next track)"
+                  << (config.mediaCache == "ram" ? std::string()
+                      : ", disk " + config.mediaCache + " (" + std::to_string(config.mediaCacheMB) + " MB)")
+                  << std::endl;
+    if (!config.pcmCacheDir.empty())
+        std::cout << "  PCM cache:   " << config.pcmCacheDir << " (" << config.pcmCacheMB << " MB)" << std::endl;
+    if (config.fixedOutputRate > 0)
+        std::cout << "  Output:      fixed " << config.fixedOutputRate << "Hz/" << config.fixedOutputBits
+                  << "bit (PCM resampled, DSD native)" << std::endl;
+    if (config.decodeThreads > 1)
+        std::cout << "  Decode:      " << config.decodeThreads << " workers (frame-parallel)" << std::endl;
+    if (config.memoryPlayMB > 0)
+        std::cout << "  Memory play: " << config.memoryPlayMB << " MB per track"
+                  << (config.memoryPlayNext ? ", next track too" : "") << std::endl;
+    if (!config.metricsFile.empty())
+        std::cout << "  Metrics:     " << config.metricsFile << std::endl;
     
     // ⭐ v1.3.0: Display transfer mode
     std::cout << "  Transfer:    " 
@@ -302,7 +583,9 @@ int main(int argc, char* argv[]) {
     // ⭐ Display advanced settings only if modified from defaults OR if Fix mode
     if (config.threadMode != 1 || config.cycleTime != 10000 || 
         config.cycleMinTime != 333 || config.infoCycle != 100000 || 
-        config.mtuOverride != 0 || config.transferMode == TransferMode::Fix) {
+        config.mtuOverride != 0 || config.mtuCeiling != 16128 || config.mtuEchoPort != 0 ||
+        config.transferMode == TransferMode::Fix ||
+        config.cycleAutoTune || config.targetLatencyMs != 0) {
         std::cout << "\nAdvanced Diretta Settings:" << std::endl;
         if (config.threadMode != 1)
             std::cout << "  Thread Mode: " << config.threadMode << std::endl;
@@ -317,10 +600,19 @@ int main(int argc, char* argv[]) {
         }
         if (config.cycleMinTime != 333)
             std::cout << "  Cycle Min:   " << config.cycleMinTime << " µs" << std::endl;
+        if (config.cycleAutoTune)
+            std::cout << "  Cycle Tune:  auto (closed-loop), remembered in "
+                      << (config.cycleTuneDir.empty() ? "memory" : config.cycleTuneDir) << std::endl;
+        if (config.targetLatencyMs != 0)
+            std::cout << "  Latency:     " << config.targetLatencyMs << " ms (target)" << std::endl;
         if (config.infoCycle != 100000)
             std::cout << "  Info Cycle:  " << config.infoCycle << " µs" << std::endl;
         if (config.mtuOverride != 0)
             std::cout << "  MTU:         " << config.mtuOverride << " bytes" << std::endl;
+        if (config.mtuCeiling != 16128)
+            std::cout << "  MTU Ceiling: " << config.mtuCeiling << " bytes" << std::endl;
+        if (config.mtuEchoPort != 0)
+            std::cout << "  MTU Echo:    UDP port " << config.mtuEchoPort << std::endl;
     }
     std::cout << std::endl;
     
@@ -342,9 +634,13 @@ int main(int argc, char* argv[]) {
         std::cout << "   (Press Ctrl+C to stop)" << std::endl;
         std::cout << std::endl;
         
-        // Main loop - just wait
+        // Main loop - just wait (target discovery may still be running)
         while (g_renderer->isRunning()) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
+            if (g_renderer->hasFailed()) {
+                g_renderer->stop();
+                return 1;
+            }
         }
         
     } catch (const std::exception& e) {
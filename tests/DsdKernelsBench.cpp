@@ -0,0 +1,137 @@
+/**
+ * @file DsdKernelsBench.cpp
+ * @brief DSD interleave kernels: realtime factor at DSD256/512/1024
+ *
+ * Times the three DsdKernels layouts (DSF planar, planar MSB-first, DFF
+ * byte-interleaved) on synthetic stereo data against the per-byte scalar
+ * loop they replaced, after checking both produce the same bytes. Which
+ * SIMD path is measured depends on the build (make bench-dsd SIMD=1).
+ */
+
+#include "DsdKernels.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstring>
+
+namespace {
+
+const double BENCH_SECONDS = 60.0;         // Audio converted per measurement
+const size_t BLOCK = 4096;                 // Bytes per channel per call (one DSF block)
+
+const char* compiledPath() {
+#if defined(__SSSE3__)
+    return "SSSE3";
+#elif defined(__SSE2__)
+    return "SSE2";
+#elif defined(__ARM_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+enum class Layout { Planar, PlanarMsb, Interleaved };
+
+const char* layoutName(Layout layout) {
+    switch (layout) {
+        case Layout::Planar:      return "DSF planar       ";
+        case Layout::PlanarMsb:   return "planar MSB-first ";
+        case Layout::Interleaved: return "DFF interleaved  ";
+    }
+    return "";
+}
+
+// The loop the kernels replaced: one byte at a time, reversal in the same pass
+void scalar(Layout layout, const uint8_t* src, uint8_t* out, size_t bytesPerChannel) {
+    bool reverse = (layout != Layout::Planar);
+    for (size_t i = 0; i < bytesPerChannel; i += 4) {
+        for (size_t b = 0; b < 4; b++) {
+            uint8_t l = (layout == Layout::Interleaved) ? src[(i + b) * 2] : src[i + b];
+            uint8_t r = (layout == Layout::Interleaved) ? src[(i + b) * 2 + 1] : src[bytesPerChannel + i + b];
+            out[i * 2 + b]     = reverse ? DsdKernels::reverseByte(l) : l;
+            out[i * 2 + 4 + b] = reverse ? DsdKernels::reverseByte(r) : r;
+        }
+    }
+}
+
+void kernel(Layout layout, const uint8_t* src, uint8_t* out, size_t bytesPerChannel) {
+    switch (layout) {
+        case Layout::Planar:
+            DsdKernels::planarStereo<false>(src, src + bytesPerChannel, out, bytesPerChannel);
+            break;
+        case Layout::PlanarMsb:
+            DsdKernels::planarStereo<true>(src, src + bytesPerChannel, out, bytesPerChannel);
+            break;
+        case Layout::Interleaved:
+            DsdKernels::byteInterleavedStereo<true>(src, out, bytesPerChannel);
+            break;
+    }
+}
+
+// Realtime factor for one layout at one rate
+template <typename Convert>
+double measure(Convert convert, const std::vector<uint8_t>& src, std::vector<uint8_t>& out, uint32_t dsdRate) {
+    const size_t bytesPerSecond = dsdRate / 8;     // Per channel
+    const size_t total = static_cast<size_t>(BENCH_SECONDS * bytesPerSecond);
+    const size_t blocks = src.size() / (BLOCK * 2);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t block = 0;
+    for (size_t done = 0; done < total; done += BLOCK) {
+        convert(src.data() + block * BLOCK * 2, out.data() + block * BLOCK * 2, BLOCK);
+        block = (block + 1) % blocks;
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return wall > 0.0 ? BENCH_SECONDS / wall : 0.0;
+}
+
+} // namespace
+
+int main() {
+    // 2 MB of input: bigger than L2 on small boards, like a real read
+    std::vector<uint8_t> src(256 * BLOCK * 2);
+    uint32_t seed = 0x12345678;
+    for (auto& byte : src) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(seed >> 24);
+    }
+    std::vector<uint8_t> out(src.size());
+    std::vector<uint8_t> expected(src.size());
+
+    std::cout << "════════════════════════════════════════════════════════\n"
+              << "  ⏱️  DSD kernel benchmark (" << compiledPath() << " build)\n"
+              << "════════════════════════════════════════════════════════\n" << std::endl;
+
+    const Layout layouts[] = { Layout::Planar, Layout::PlanarMsb, Layout::Interleaved };
+    for (Layout layout : layouts) {
+        scalar(layout, src.data(), expected.data(), src.size() / 2);
+        kernel(layout, src.data(), out.data(), src.size() / 2);
+        if (out != expected) {
+            std::cerr << "❌ " << layoutName(layout) << "differs from the scalar loop" << std::endl;
+            return 1;
+        }
+    }
+
+    const struct { const char* name; uint32_t rate; } rates[] = {
+        { "DSD256 ", 11289600 },
+        { "DSD512 ", 22579200 },
+        { "DSD1024", 45158400 },
+    };
+    for (const auto& r : rates) {
+        std::cout << "📊 " << r.name << " stereo (" << static_cast<int>(BENCH_SECONDS) << "s per run):" << std::endl;
+        for (Layout layout : layouts) {
+            double simd = measure([layout](const uint8_t* s, uint8_t* o, size_t n) { kernel(layout, s, o, n); },
+                                  src, out, r.rate);
+            double base = measure([layout](const uint8_t* s, uint8_t* o, size_t n) { scalar(layout, s, o, n); },
+                                  src, out, r.rate);
+            std::cout << "   " << layoutName(layout) << std::fixed << std::setprecision(0)
+                      << std::setw(6) << simd << "x realtime (scalar loop " << std::setw(5) << base << "x, "
+                      << std::setprecision(1) << (base > 0.0 ? simd / base : 0.0) << "x faster)" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file PathMtuProbeTest.cpp
+ * @brief Path-MTU search against a loopback UDP echo responder
+ *
+ * The responder drops datagrams above a size limit without any ICMP
+ * feedback, the way a switch without jumbo frame support does.
+ */
+
+#include "PathMtuProbe.h"
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+bool g_verbose = false;
+
+namespace {
+
+int s_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << "❌ " << __FILE__ << ":" << __LINE__ << ": " << #cond << std::endl; \
+            s_failures++; \
+        } \
+    } while (0)
+
+const uint32_t UDP_IPV4_HEADER = 28;
+
+// Echoes datagrams up to maxMTU (IP size), silently drops larger ones
+class EchoResponder {
+public:
+    explicit EchoResponder(uint32_t maxMTU) : m_maxMTU(maxMTU) {
+        m_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        ::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+        m_thread = std::thread(&EchoResponder::run, this);
+    }
+
+    ~EchoResponder() {
+        m_stop = true;
+        m_thread.join();
+        ::close(m_fd);
+    }
+
+    uint16_t port() const { return m_port; }
+
+private:
+    void run() {
+        std::vector<uint8_t> buffer(65536);
+        while (!m_stop) {
+            pollfd pfd;
+            pfd.fd = m_fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (::poll(&pfd, 1, 20) <= 0) {
+                continue;
+            }
+            sockaddr_in from;
+            socklen_t len = sizeof(from);
+            ssize_t n = ::recvfrom(m_fd, buffer.data(), buffer.size(), 0,
+                                   reinterpret_cast<sockaddr*>(&from), &len);
+            if (n > 0 && static_cast<uint32_t>(n) + UDP_IPV4_HEADER <= m_maxMTU) {
+                ::sendto(m_fd, buffer.data(), n, 0, reinterpret_cast<sockaddr*>(&from), len);
+            }
+        }
+    }
+
+    uint32_t m_maxMTU;
+    int m_fd = -1;
+    uint16_t m_port = 0;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+};
+
+void testSearch() {
+    // Pure bisection: largest accepted size, within the resolution
+    auto probe = [](uint32_t mtu) { return mtu <= 4000; };
+    PathMtuProbe::Result r = PathMtuProbe::search(probe, 1280, 16128);
+    CHECK(r.ok);
+    CHECK(r.mtu <= 4000);
+    CHECK(r.mtu + PathMtuProbe::RESOLUTION >= 4000);
+
+    // Clean path: the ceiling is tried first and resolves in one probe
+    r = PathMtuProbe::search([](uint32_t) { return true; }, 1280, 9000);
+    CHECK(r.ok && r.mtu == 9000 && r.probes == 1);
+}
+
+void testJumboDropped() {
+    // Switch that only passes standard frames: no ICMP, just silence
+    EchoResponder responder(1500);
+    std::string host = "127.0.0.1";
+    PathMtuProbe::invalidate(host);
+
+    PathMtuProbe::Result r = PathMtuProbe::discover(
+        host, PathMtuProbe::makeEchoProbe(host, responder.port(), 50), 16128);
+    CHECK(r.ok);
+    CHECK(!r.fromCache);
+    CHECK(r.mtu <= 1500);
+    CHECK(r.mtu + PathMtuProbe::RESOLUTION >= 1500);
+
+    // Cached for the next open
+    r = PathMtuProbe::discover(host, PathMtuProbe::makeEchoProbe(host, responder.port(), 50), 16128);
+    CHECK(r.ok && r.fromCache && r.mtu <= 1500);
+    PathMtuProbe::invalidate(host);
+}
+
+void testJumboPath() {
+    EchoResponder responder(9000);
+    std::string host = "127.0.0.1";
+    PathMtuProbe::invalidate(host);
+
+    PathMtuProbe::Result r = PathMtuProbe::discover(
+        host, PathMtuProbe::makeEchoProbe(host, responder.port(), 50), 16128);
+    CHECK(r.ok);
+    CHECK(r.mtu <= 9000);
+    CHECK(r.mtu + PathMtuProbe::RESOLUTION >= 9000);
+    PathMtuProbe::invalidate(host);
+
+    // Ceiling below the path: one probe, ceiling wins
+    r = PathMtuProbe::discover(host, PathMtuProbe::makeEchoProbe(host, responder.port(), 50), 4000);
+    CHECK(r.ok && r.mtu == 4000);
+    PathMtuProbe::invalidate(host);
+}
+
+void testNoResponder() {
+    // Nothing confirms anything: no result, nothing cached
+    uint16_t port;
+    {
+        EchoResponder gone(1500);
+        port = gone.port();
+    }
+    std::string host = "127.0.0.1";
+    PathMtuProbe::invalidate(host);
+
+    PathMtuProbe::Result r = PathMtuProbe::discover(
+        host, PathMtuProbe::makeEchoProbe(host, port, 50), 16128);
+    CHECK(!r.ok);
+    uint32_t cached = 0;
+    CHECK(!PathMtuProbe::getCached(host, cached));
+}
+
+} // namespace
+
+int main() {
+    testSearch();
+    testJumboDropped();
+    testJumboPath();
+    testNoResponder();
+
+    if (s_failures > 0) {
+        std::cerr << "❌ PathMtuProbeTest: " << s_failures << " failure(s)" << std::endl;
+        return 1;
+    }
+    std::cout << "✓ PathMtuProbeTest passed" << std::endl;
+    return 0;
+}
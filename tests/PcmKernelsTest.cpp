@@ -0,0 +1,187 @@
+/**
+ * @file PcmKernelsTest.cpp
+ * @brief Identity-rate frame kernels against swr_convert, byte for byte
+ *
+ * Every sample format, channel count and output container served by
+ * PcmKernels::selectFrameKernel() is converted by the kernel and by a
+ * swresample context set up like AudioDecoder::initResampler() at an
+ * unchanged rate. The frame count is odd so the SIMD loops and the
+ * scalar tails both run; a second pass starts inside the frame
+ * (first > 0), the way the decoder converts the rest of a frame.
+ */
+
+#include "PcmKernels.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <limits>
+#include <cstring>
+
+extern "C" {
+#include <libswresample/swresample.h>
+#include <libavutil/channel_layout.h>
+}
+
+namespace {
+
+int s_failures = 0;
+int s_kernels = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << "❌ " << __FILE__ << ":" << __LINE__ << ": " << #cond << std::endl; \
+            s_failures++; \
+        } \
+    } while (0)
+
+const int SAMPLE_RATE = 48000;
+const size_t FRAMES = 1027;
+const size_t FIRST = 5;
+
+template <typename T>
+void fillIntegers(T* out, size_t count, std::mt19937& rng) {
+    // Extremes and neighbours of zero first, then full-range noise
+    const T edges[] = { std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), 0, 1, -1 };
+    std::uniform_int_distribution<int64_t> noise(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (i < sizeof(edges) / sizeof(edges[0])) ? edges[i] : static_cast<T>(noise(rng));
+    }
+}
+
+void fillFloats(float* out, size_t count, std::mt19937& rng) {
+    // Full scale, clipping, rounding ties at 32 bit, then noise past full scale
+    const float tie = 1.0f / 2147483648.0f;
+    const float edges[] = { 1.0f, -1.0f, 1.5f, -1.5f, 0.0f, 0.5f * tie, 1.5f * tie, -0.5f * tie, 0.99999994f };
+    std::uniform_real_distribution<float> noise(-1.2f, 1.2f);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (i < sizeof(edges) / sizeof(edges[0])) ? edges[i] : noise(rng);
+    }
+}
+
+// One buffer per plane: `channels` planes if planar, one interleaved plane otherwise
+std::vector<std::vector<uint8_t>> makeInput(AVSampleFormat format, int channels, std::mt19937& rng) {
+    bool planar = av_sample_fmt_is_planar(format);
+    size_t perPlane = planar ? FRAMES : FRAMES * channels;
+    size_t bytes = av_get_bytes_per_sample(format);
+
+    std::vector<std::vector<uint8_t>> planes(planar ? channels : 1);
+    for (auto& plane : planes) {
+        plane.resize(perPlane * bytes);
+        switch (av_get_packed_sample_fmt(format)) {
+            case AV_SAMPLE_FMT_S16:
+                fillIntegers(reinterpret_cast<int16_t*>(plane.data()), perPlane, rng);
+                break;
+            case AV_SAMPLE_FMT_S32:
+                fillIntegers(reinterpret_cast<int32_t*>(plane.data()), perPlane, rng);
+                break;
+            default:
+                fillFloats(reinterpret_cast<float*>(plane.data()), perPlane, rng);
+                break;
+        }
+    }
+    return planes;
+}
+
+bool swrReference(AVSampleFormat format, int channels, AVSampleFormat outFormat,
+                  const uint8_t* const* planes, std::vector<uint8_t>& out) {
+    AVChannelLayout layout;
+    av_channel_layout_default(&layout, channels);
+
+    SwrContext* swr = nullptr;
+    if (swr_alloc_set_opts2(&swr, &layout, outFormat, SAMPLE_RATE,
+                            &layout, format, SAMPLE_RATE, 0, nullptr) < 0 || swr_init(swr) < 0) {
+        swr_free(&swr);
+        av_channel_layout_uninit(&layout);
+        return false;
+    }
+
+    out.assign(FRAMES * channels * av_get_bytes_per_sample(outFormat), 0);
+    uint8_t* outPtr = out.data();
+    int converted = swr_convert(swr, &outPtr, static_cast<int>(FRAMES),
+                                const_cast<const uint8_t**>(planes), static_cast<int>(FRAMES));
+    swr_free(&swr);
+    av_channel_layout_uninit(&layout);
+    return converted == static_cast<int>(FRAMES);
+}
+
+bool sameBytes(const char* name, int channels, size_t first, size_t bytesPerFrame,
+               const uint8_t* expected, const uint8_t* actual, size_t bytes) {
+    if (std::memcmp(expected, actual, bytes) == 0) {
+        return true;
+    }
+    size_t diff = 0;
+    while (expected[diff] == actual[diff]) {
+        diff++;
+    }
+    std::cerr << "❌ " << name << ", " << channels << " ch: differs from swr_convert at frame "
+              << (first + diff / bytesPerFrame) << std::endl;
+    return false;
+}
+
+void testKernel(AVSampleFormat format, int channels, size_t outputSampleBytes, std::mt19937& rng) {
+    const char* name = nullptr;
+    PcmKernels::FrameKernel kernel = PcmKernels::selectFrameKernel(format, channels, outputSampleBytes, name);
+
+    // Narrowing to S16 stays on swresample (dither); everything else has a kernel
+    if (outputSampleBytes == 2 && av_get_bytes_per_sample(format) > 2) {
+        CHECK(kernel == nullptr);
+        return;
+    }
+    CHECK(kernel != nullptr);
+    if (!kernel) {
+        return;
+    }
+    s_kernels++;
+
+    auto input = makeInput(format, channels, rng);
+    std::vector<const uint8_t*> planes;
+    for (const auto& plane : input) {
+        planes.push_back(plane.data());
+    }
+
+    AVSampleFormat outFormat = (outputSampleBytes == 2) ? AV_SAMPLE_FMT_S16 : AV_SAMPLE_FMT_S32;
+    std::vector<uint8_t> expected;
+    CHECK(swrReference(format, channels, outFormat, planes.data(), expected));
+    if (expected.empty()) {
+        return;
+    }
+
+    size_t bytesPerFrame = outputSampleBytes * channels;
+    std::vector<uint8_t> actual(FRAMES * bytesPerFrame, 0xAA);
+
+    kernel(planes.data(), 0, FRAMES, channels, actual.data());
+    CHECK(sameBytes(name, channels, 0, bytesPerFrame, expected.data(), actual.data(), actual.size()));
+
+    // Rest of a frame, as kept in the decoder's remainder buffer
+    std::fill(actual.begin(), actual.end(), 0xAA);
+    kernel(planes.data(), FIRST, FRAMES - FIRST, channels, actual.data());
+    CHECK(sameBytes(name, channels, FIRST, bytesPerFrame, expected.data() + FIRST * bytesPerFrame,
+                    actual.data(), (FRAMES - FIRST) * bytesPerFrame));
+}
+
+} // namespace
+
+int main() {
+    const AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S32, AV_SAMPLE_FMT_FLT,
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP,
+    };
+    const int channelCounts[] = { 1, 2, 3, 6, 8 };
+
+    std::mt19937 rng(20240611);
+    for (AVSampleFormat format : formats) {
+        for (int channels : channelCounts) {
+            testKernel(format, channels, 2, rng);
+            testKernel(format, channels, 4, rng);
+        }
+    }
+
+    if (s_failures > 0) {
+        std::cerr << "❌ PcmKernelsTest: " << s_failures << " failure(s)" << std::endl;
+        return 1;
+    }
+    std::cout << "✓ PcmKernelsTest passed (" << s_kernels << " kernel/channel combinations)" << std::endl;
+    return 0;
+}